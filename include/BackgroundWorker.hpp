@@ -0,0 +1,48 @@
+#ifndef BACKGROUND_WORKER_HPP
+#define BACKGROUND_WORKER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/*
+ * Runs jobs one at a time on its own thread so the UI thread never waits for them. Submitting a job
+ * supersedes the one not started yet and asks the running one to stop; jobs poll the flag they are
+ * given and return early once it is set. Only the owning thread submits, cancels and collects results.
+ */
+class BackgroundWorker
+{
+public:
+    using Job = std::function<void(const std::atomic<bool>& cancelled)>;
+
+private:
+    std::mutex mutex_;
+    std::condition_variable state_changed_;
+    Job pending_job_;
+    bool running_;
+    bool completed_;
+    bool stopping_;
+    std::atomic<bool> cancelled_;
+    std::thread thread_;
+
+    void Run();
+
+public:
+    BackgroundWorker();
+
+    ~BackgroundWorker();
+
+    void Submit(Job job);
+
+    /* Drops the pending job and waits until the running one has stopped, so whatever it read may be changed again. */
+    void Cancel();
+
+    bool IsBusy();
+
+    /* True once after the latest submitted job ran to the end without being cancelled; its results may then be used. */
+    bool TakeCompleted();
+};
+
+#endif
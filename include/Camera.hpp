@@ -0,0 +1,48 @@
+#ifndef CAMERA_HPP
+#define CAMERA_HPP
+
+#include <SDL2/SDL.h>
+
+class Camera
+{
+private:
+    /* World position shown at the top-left corner of the view, in world pixels. */
+    double x_;
+    double y_;
+    double zoom_;
+
+    int view_width_;
+    int view_height_;
+
+    bool dragging_;
+    SDL_Point drag_origin_;
+
+public:
+    Camera(int view_width, int view_height);
+
+    bool HandleEvent(SDL_Event* e);
+
+    void Fit(int world_width, int world_height);
+
+    void ZoomAt(double factor, int screen_x, int screen_y);
+
+    void Pan(int screen_dx, int screen_dy);
+
+    double GetZoom() const;
+
+    int GetViewWidth() const;
+
+    int GetViewHeight() const;
+
+    double ScreenToWorldX(int screen_x) const;
+
+    double ScreenToWorldY(int screen_y) const;
+
+    int WorldToScreenX(double world_x) const;
+
+    int WorldToScreenY(double world_y) const;
+
+    SDL_Rect WorldToScreen(const SDL_Rect& world_rect) const;
+};
+
+#endif
@@ -0,0 +1,164 @@
+#ifndef FINGERPRINT_HPP
+#define FINGERPRINT_HPP
+
+#include "RandomEngine.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/*
+ * 64-bit fingerprints of square-grid wall layouts. The walls are streamed as packed bits (open right
+ * passages and open bottom passages of every cell in row-major order) through a word-at-a-time hash,
+ * so two mazes get the same fingerprint exactly when their walls match (up to 64-bit collisions).
+ */
+namespace fingerprint
+{
+	/* Packs bits into 64-bit words and mixes every full word into the state. */
+	class WallHasher
+	{
+	private:
+		std::uint64_t state_ = 0;
+		std::uint64_t word_ = 0;
+		int word_bits_ = 0;
+		std::uint64_t total_bits_ = 0;
+
+	public:
+		void Add(bool bit)
+		{
+			word_ |= static_cast<std::uint64_t>(bit) << word_bits_;
+
+			if (++word_bits_ == 64)
+			{
+				state_ = MixBits(state_ + word_);
+				word_ = 0;
+				word_bits_ = 0;
+			}
+
+			++total_bits_;
+		}
+
+		std::uint64_t Finish() const
+		{
+			return MixBits(MixBits(state_ + word_) ^ total_bits_);
+		}
+	};
+
+	/*
+	 * The eight symmetries of a square: bit 0 transposes, bit 1 mirrors horizontally, bit 2 mirrors vertically. On rectangular
+	 * grids only the four without transposition map the grid onto itself.
+	 */
+	constexpr int symmetry_count = 8;
+	constexpr int transpose = 1;
+	constexpr int mirror_x = 2;
+	constexpr int mirror_y = 4;
+
+	/*
+	 * Fingerprint of the maze as seen through the given symmetry. is_open(x, y, direction) reports passages of the original
+	 * maze, with directions ordered like CellNeighbors: left, right, top, bottom.
+	 */
+	template <typename IsOpen>
+	std::uint64_t HashWalls(int cells_width, int cells_height, int symmetry, IsOpen is_open)
+	{
+		const bool transposed = (symmetry & transpose) != 0;
+		const int width = transposed ? cells_height : cells_width;
+		const int height = transposed ? cells_width : cells_height;
+
+		/* Position in the original maze of cell (x, y) of the transformed one. */
+		const auto original = [&](int x, int y)
+		{
+			const int unmirrored_x = (symmetry & mirror_x) ? width - 1 - x : x;
+			const int unmirrored_y = (symmetry & mirror_y) ? height - 1 - y : y;
+
+			return transposed ? std::make_pair(unmirrored_y, unmirrored_x) : std::make_pair(unmirrored_x, unmirrored_y);
+		};
+
+		/* Direction in the original maze of the transformed right and bottom directions; the same for every cell. */
+		const auto original_direction = [&](int neighbor_x, int neighbor_y)
+		{
+			const auto [from_x, from_y] = original(0, 0);
+			const auto [to_x, to_y] = original(neighbor_x, neighbor_y);
+
+			return (to_x < from_x) ? 0 : (to_x > from_x) ? 1 : (to_y < from_y) ? 2 : 3;
+		};
+
+		const int right_direction = original_direction(1, 0);
+		const int bottom_direction = original_direction(0, 1);
+
+		WallHasher hasher;
+
+		for (int y = 0; y < height; ++y)
+		{
+			for (int x = 0; x + 1 < width; ++x)
+			{
+				const auto [original_x, original_y] = original(x, y);
+				hasher.Add(is_open(original_x, original_y, right_direction));
+			}
+		}
+
+		for (int y = 0; y + 1 < height; ++y)
+		{
+			for (int x = 0; x < width; ++x)
+			{
+				const auto [original_x, original_y] = original(x, y);
+				hasher.Add(is_open(original_x, original_y, bottom_direction));
+			}
+		}
+
+		return hasher.Finish();
+	}
+
+	/* Smallest fingerprint over all symmetries that map the grid onto itself, equal for rotated and mirrored copies of a maze. */
+	template <typename IsOpen>
+	std::uint64_t HashWallsCanonical(int cells_width, int cells_height, IsOpen is_open)
+	{
+		std::uint64_t canonical = HashWalls(cells_width, cells_height, 0, is_open);
+
+		for (int symmetry = 1; symmetry < symmetry_count; ++symmetry)
+		{
+			if ((symmetry & transpose) == 0 || cells_width == cells_height)
+			{
+				canonical = std::min(canonical, HashWalls(cells_width, cells_height, symmetry, is_open));
+			}
+		}
+
+		return canonical;
+	}
+
+	/*
+	 * Set of fingerprints split into independently locked shards, so threads inserting different fingerprints rarely wait
+	 * on each other. Each fingerprint keeps the smallest seed it was inserted with, which makes the contents independent of
+	 * the order of insertion.
+	 */
+	class ShardedFingerprintSet
+	{
+	private:
+		struct Shard
+		{
+			std::mutex mutex_;
+			std::vector<std::pair<std::uint64_t, std::uint32_t>> slots_;
+			std::size_t size_ = 0;
+		};
+
+		static constexpr int shard_bits = 6;
+
+		std::vector<Shard> shards_;
+
+		static void InsertSlot(std::vector<std::pair<std::uint64_t, std::uint32_t>>& slots, std::uint64_t fingerprint, std::uint32_t seed, bool& inserted);
+
+	public:
+		ShardedFingerprintSet();
+
+		/* Returns true if the fingerprint was not in the set yet. */
+		bool Insert(std::uint64_t fingerprint, std::uint32_t seed);
+
+		std::size_t GetSize();
+
+		/* All entries as (seed, fingerprint), sorted by seed; only valid once all inserts are done. */
+		std::vector<std::pair<std::uint32_t, std::uint64_t>> GetEntries();
+	};
+} // namespace fingerprint
+
+#endif
@@ -1,34 +1,16 @@
 #ifndef GAME_HPP
 #define GAME_HPP
 
+#include "BackgroundWorker.hpp"
+#include "Hud.hpp"
 #include "Maze.hpp"
+#include "Timer.hpp"
+#include "WorkerPool.hpp"
 
 #include <SDL2/SDL.h>
 
-#include <chrono>
 #include <memory>
 
-class Timer
-{
-private:
-    using clock = std::chrono::high_resolution_clock;
-    using second = std::chrono::duration<double, std::ratio<1>>;
-
-    std::chrono::time_point<clock> start;
-public:
-    Timer() : start(clock::now()) {}
-
-    void reset()
-	{
-        start = clock::now();
-    }
-
-    double elapsed() const
-	{
-        return std::chrono::duration_cast<second>(clock::now() - start).count();
-    }
-};
-
 class Game
 {
 private:
@@ -36,8 +18,16 @@ private:
 	bool running_;
 	int ticks_;
 
+	/* The one set of threads behind the rasterizer and the dead end passes, declared first so it outlives the maze. */
+	WorkerPool worker_pool_;
+
 	std::unique_ptr<Maze> maze_;
 
+	/* Runs the 't' and 'y' test batches, which take seconds, without blocking the window. */
+	BackgroundWorker test_worker_;
+
+	Hud hud_;
+
 public:
 	SDL_Window* window_;
 	SDL_Renderer* renderer_;
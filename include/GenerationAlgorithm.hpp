@@ -0,0 +1,19 @@
+#ifndef GENERATION_ALGORITHM_HPP
+#define GENERATION_ALGORITHM_HPP
+
+enum class GenerationAlgorithm
+{
+	None,
+	RecursiveBacktracker,
+	HuntAndKill,
+	Wilsons,
+	RandomizedKruskal,
+	PrimSimplified,
+	GrowingTreeNewest,
+	GrowingTreeOldest,
+	GrowingTreeRandom,
+	GrowingTreeMixed,
+	PrimWeighted
+};
+
+#endif
@@ -0,0 +1,614 @@
+#ifndef GRID_MAZE_HPP
+#define GRID_MAZE_HPP
+
+#include "GenerationAlgorithm.hpp"
+#include "GrowingTree.hpp"
+#include "IndexedHeap.hpp"
+#include "RandomBits.hpp"
+#include "Topology.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+/*
+ * Compact maze over any topology policy from Topology.hpp. Walls are stored as one bitmask of open
+ * directions per cell, and every generator and solver is instantiated per topology, so neighbor
+ * lookups compile down to constant table reads with no runtime dispatch on the hot path. The random
+ * engine can be swapped for one that is cheaper to seed when many tiny mazes each need their own seed.
+ * This is a second engine next to Maze, not shared with it: its generators follow the same algorithms but
+ * draw random numbers differently, so one algorithm and seed give different mazes in the two, and a fix to
+ * a generator has to be made in both.
+ */
+template <typename Topology, typename Engine = std::mt19937>
+class GridMaze
+{
+public:
+	using Mask = std::uint8_t;
+
+	static constexpr int direction_count = Topology::direction_count;
+	static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+	static_assert(direction_count <= 8, "Passages of a cell must fit into one byte.");
+
+	/* From this many cells on the recursive backtracker walks back through came-from directions instead of keeping a stack. */
+	static constexpr std::size_t stackless_backtracker_cells = std::size_t(1) << 22;
+
+private:
+	static constexpr std::uint32_t unvisited = std::numeric_limits<std::uint32_t>::max();
+
+	GridDimensions dimensions_;
+	std::size_t layer_size_;
+
+	/* Index distance to the neighbor in every direction, only meaningful for topologies with uniform offsets. */
+	std::array<std::ptrdiff_t, direction_count> strides_;
+
+	std::vector<Mask> passages_;
+	std::vector<std::uint8_t> visited_;
+
+	/* Scratch buffers reused across runs: stack, active set or queue, and per-cell links. */
+	std::vector<std::uint32_t> cells_;
+	std::vector<std::uint32_t> links_;
+	GrowingTreeCells growing_tree_cells_;
+	IndexedHeap<> frontier_;
+
+	RandomBits<Engine> random_bits_;
+
+	std::size_t RandomIndex(std::size_t bound)
+	{
+		return random_bits_.Below(static_cast<std::uint32_t>(bound));
+	}
+
+	int RandomDirection(std::size_t cell, bool unvisited_only)
+	{
+		std::uint32_t directions = 0;
+
+		for (int direction = 0; direction < direction_count; ++direction)
+		{
+			const std::size_t neighbor = GetNeighbor(cell, direction);
+
+			if (neighbor != npos && (!unvisited_only || !visited_[neighbor]))
+			{
+				directions |= 1u << direction;
+			}
+		}
+
+		return random_bits_.SelectBit(directions);
+	}
+
+	std::size_t FindSet(std::size_t cell)
+	{
+		while (links_[cell] != cell)
+		{
+			links_[cell] = links_[links_[cell]];
+			cell = links_[cell];
+		}
+
+		return cell;
+	}
+
+public:
+	explicit GridMaze(GridDimensions dimensions) : 
+		dimensions_(dimensions), 
+		layer_size_(static_cast<std::size_t>(dimensions.width_) * dimensions.height_), 
+		random_bits_(std::random_device{}())
+	{
+		assert(dimensions_.width_ > 0 && dimensions_.height_ > 0 && dimensions_.depth_ > 0);
+		assert(layer_size_ * dimensions_.depth_ < unvisited);
+
+		passages_.resize(layer_size_ * dimensions_.depth_);
+		visited_.resize(passages_.size());
+
+		for (int direction = 0; direction < direction_count; ++direction)
+		{
+			int offset_x = 0;
+			int offset_y = 0;
+			int offset_z = 0;
+			Topology::Offset(0, 0, direction, offset_x, offset_y, offset_z);
+			strides_[direction] = offset_x + static_cast<std::ptrdiff_t>(offset_y) * dimensions_.width_ + static_cast<std::ptrdiff_t>(offset_z) * layer_size_;
+		}
+	}
+
+	const GridDimensions& GetDimensions() const
+	{
+		return dimensions_;
+	}
+
+	std::size_t GetCellCount() const
+	{
+		return passages_.size();
+	}
+
+	std::size_t GetCellIndex(int x, int y, int z) const
+	{
+		return static_cast<std::size_t>(z) * layer_size_ + static_cast<std::size_t>(y) * dimensions_.width_ + x;
+	}
+
+	std::size_t GetNeighbor(std::size_t cell, int direction) const
+	{
+		const int z = static_cast<int>(cell / layer_size_);
+		const std::size_t layer_index = cell % layer_size_;
+		const int y = static_cast<int>(layer_index / dimensions_.width_);
+		const int x = static_cast<int>(layer_index % dimensions_.width_);
+
+		int offset_x = 0;
+		int offset_y = 0;
+		int offset_z = 0;
+		Topology::Offset(x, y, direction, offset_x, offset_y, offset_z);
+
+		const int neighbor_x = x + offset_x;
+		const int neighbor_y = y + offset_y;
+		const int neighbor_z = z + offset_z;
+
+		if (neighbor_x < 0 || neighbor_x >= dimensions_.width_ || neighbor_y < 0 || neighbor_y >= dimensions_.height_ || neighbor_z < 0 || neighbor_z >= dimensions_.depth_)
+		{
+			return npos;
+		}
+
+		return GetCellIndex(neighbor_x, neighbor_y, neighbor_z);
+	}
+
+	/* Neighbor through a passage that is known to be open, so it is always inside the grid. */
+	std::size_t GetOpenNeighbor(std::size_t cell, int direction) const
+	{
+		if constexpr (Topology::uniform_offsets)
+		{
+			return cell + strides_[direction];
+		}
+		else
+		{
+			return GetNeighbor(cell, direction);
+		}
+	}
+
+	Mask GetPassages(std::size_t cell) const
+	{
+		return passages_[cell];
+	}
+
+	bool IsOpen(std::size_t cell, int direction) const
+	{
+		return (passages_[cell] >> direction) & 1;
+	}
+
+	void Carve(std::size_t cell, int direction, std::size_t neighbor)
+	{
+		passages_[cell] |= static_cast<Mask>(1 << direction);
+		passages_[neighbor] |= static_cast<Mask>(1 << Topology::opposite[direction]);
+	}
+
+	void Reset()
+	{
+		std::fill(passages_.begin(), passages_.end(), 0);
+		std::fill(visited_.begin(), visited_.end(), 0);
+		cells_.clear();
+	}
+
+	void Generate(GenerationAlgorithm algorithm, std::uint32_t seed)
+	{
+		Seed(seed);
+		Generate(algorithm);
+	}
+
+	void Seed(std::uint32_t seed)
+	{
+		random_bits_.Seed(seed);
+	}
+
+	/* Continues the current random stream, which is much cheaper than reseeding for batches of tiny mazes. */
+	void Generate(GenerationAlgorithm algorithm)
+	{
+		Reset();
+
+		switch (algorithm)
+		{
+		case GenerationAlgorithm::RecursiveBacktracker:
+			if (GetCellCount() >= stackless_backtracker_cells)
+			{
+				GenerateStacklessBacktracker();
+			}
+			else
+			{
+				GenerateRecursiveBacktracker();
+			}
+			break;
+
+		case GenerationAlgorithm::HuntAndKill:
+			GenerateHuntAndKill();
+			break;
+
+		case GenerationAlgorithm::Wilsons:
+			GenerateWilsons();
+			break;
+
+		case GenerationAlgorithm::RandomizedKruskal:
+			GenerateRandomizedKruskal();
+			break;
+
+		case GenerationAlgorithm::PrimSimplified:
+			GeneratePrimSimplified();
+			break;
+
+		case GenerationAlgorithm::GrowingTreeNewest:
+			GenerateGrowingTree<NewestSelection>();
+			break;
+
+		case GenerationAlgorithm::GrowingTreeOldest:
+			GenerateGrowingTree<OldestSelection>();
+			break;
+
+		case GenerationAlgorithm::GrowingTreeRandom:
+			GenerateGrowingTree<RandomSelection>();
+			break;
+
+		case GenerationAlgorithm::GrowingTreeMixed:
+			GenerateGrowingTree<MixedSelection>();
+			break;
+
+		case GenerationAlgorithm::PrimWeighted:
+			GeneratePrimWeighted();
+			break;
+
+		case GenerationAlgorithm::None:
+			break;
+		}
+	}
+
+	void GenerateRecursiveBacktracker()
+	{
+		cells_.reserve(GetCellCount());
+		cells_.push_back(static_cast<std::uint32_t>(RandomIndex(GetCellCount())));
+		visited_[cells_.back()] = true;
+
+		while (!cells_.empty())
+		{
+			const std::size_t cell = cells_.back();
+			const int direction = RandomDirection(cell, true);
+
+			if (direction == -1)
+			{
+				cells_.pop_back();
+				continue;
+			}
+
+			const std::size_t neighbor = GetNeighbor(cell, direction);
+			Carve(cell, direction, neighbor);
+			visited_[neighbor] = true;
+			cells_.push_back(static_cast<std::uint32_t>(neighbor));
+		}
+	}
+
+	/*
+	 * Same walk and random draws as GenerateRecursiveBacktracker, so the same seed gives the same maze. Instead of a
+	 * stack of 4-byte indices, which grows to the size of the grid on long corridors, visited_ holds one plus the
+	 * direction back to the cell each cell was carved from, and backtracking follows it.
+	 */
+	void GenerateStacklessBacktracker()
+	{
+		constexpr std::uint8_t first_cell = direction_count + 1;
+
+		std::size_t cell = RandomIndex(GetCellCount());
+		visited_[cell] = first_cell;
+
+		while (true)
+		{
+			const int direction = RandomDirection(cell, true);
+
+			if (direction == -1)
+			{
+				if (visited_[cell] == first_cell)
+				{
+					return;
+				}
+
+				cell = GetOpenNeighbor(cell, visited_[cell] - 1);
+				continue;
+			}
+
+			const std::size_t neighbor = GetNeighbor(cell, direction);
+			Carve(cell, direction, neighbor);
+			visited_[neighbor] = static_cast<std::uint8_t>(Topology::opposite[direction] + 1);
+			cell = neighbor;
+		}
+	}
+
+	void GenerateHuntAndKill()
+	{
+		std::size_t cell = RandomIndex(GetCellCount());
+		visited_[cell] = true;
+
+		/* Every cell before first_unvisited is visited, so the hunt never has to rescan them. */
+		std::size_t first_unvisited = 0;
+
+		while (true)
+		{
+			const int direction = RandomDirection(cell, true);
+
+			if (direction != -1)
+			{
+				const std::size_t neighbor = GetNeighbor(cell, direction);
+				Carve(cell, direction, neighbor);
+				visited_[neighbor] = true;
+				cell = neighbor;
+				continue;
+			}
+
+			while (first_unvisited < GetCellCount() && visited_[first_unvisited])
+			{
+				++first_unvisited;
+			}
+
+			cell = npos;
+
+			for (std::size_t candidate = first_unvisited; candidate < GetCellCount() && cell == npos; ++candidate)
+			{
+				if (visited_[candidate])
+				{
+					continue;
+				}
+
+				for (int hunt_direction = 0; hunt_direction < direction_count; ++hunt_direction)
+				{
+					const std::size_t neighbor = GetNeighbor(candidate, hunt_direction);
+
+					if (neighbor != npos && visited_[neighbor])
+					{
+						Carve(candidate, hunt_direction, neighbor);
+						visited_[candidate] = true;
+						cell = candidate;
+						break;
+					}
+				}
+			}
+
+			if (cell == npos)
+			{
+				return;
+			}
+		}
+	}
+
+	void GenerateWilsons()
+	{
+		/* Loop-erased random walks: links_ holds the last exit direction taken from every cell on the walk. */
+		links_.resize(GetCellCount());
+		visited_[RandomIndex(GetCellCount())] = true;
+
+		for (std::size_t start = 0; start < GetCellCount(); ++start)
+		{
+			if (visited_[start])
+			{
+				continue;
+			}
+
+			std::size_t cell = start;
+
+			while (!visited_[cell])
+			{
+				const int direction = RandomDirection(cell, false);
+				links_[cell] = static_cast<std::uint32_t>(direction);
+				cell = GetNeighbor(cell, direction);
+			}
+
+			for (cell = start; !visited_[cell]; )
+			{
+				const int direction = static_cast<int>(links_[cell]);
+				const std::size_t neighbor = GetNeighbor(cell, direction);
+				Carve(cell, direction, neighbor);
+				visited_[cell] = true;
+				cell = neighbor;
+			}
+		}
+	}
+
+	void GenerateRandomizedKruskal()
+	{
+		/* Every edge is listed once, from the cell with the lower index, packed as cell * direction_count + direction. */
+		cells_.clear();
+
+		for (std::size_t cell = 0; cell < GetCellCount(); ++cell)
+		{
+			for (int direction = 0; direction < direction_count; ++direction)
+			{
+				const std::size_t neighbor = GetNeighbor(cell, direction);
+
+				if (neighbor != npos && neighbor > cell)
+				{
+					cells_.push_back(static_cast<std::uint32_t>(cell * direction_count + direction));
+				}
+			}
+		}
+
+		random_bits_.Shuffle(cells_.begin(), cells_.end());
+
+		links_.resize(GetCellCount());
+
+		for (std::size_t cell = 0; cell < GetCellCount(); ++cell)
+		{
+			links_[cell] = static_cast<std::uint32_t>(cell);
+		}
+
+		for (const std::uint32_t edge : cells_)
+		{
+			const std::size_t cell = edge / direction_count;
+			const int direction = static_cast<int>(edge % direction_count);
+			const std::size_t neighbor = GetNeighbor(cell, direction);
+			const std::size_t cell_set = FindSet(cell);
+			const std::size_t neighbor_set = FindSet(neighbor);
+
+			if (cell_set != neighbor_set)
+			{
+				links_[neighbor_set] = static_cast<std::uint32_t>(cell_set);
+				Carve(cell, direction, neighbor);
+			}
+		}
+
+		cells_.clear();
+	}
+
+	void GeneratePrimSimplified()
+	{
+		/* Active cells are visited cells that may still have unvisited neighbors; exhausted ones are swap-removed. */
+		cells_.reserve(GetCellCount());
+		cells_.push_back(static_cast<std::uint32_t>(RandomIndex(GetCellCount())));
+		visited_[cells_.back()] = true;
+
+		while (!cells_.empty())
+		{
+			const std::size_t active_index = RandomIndex(cells_.size());
+			const std::size_t cell = cells_[active_index];
+			const int direction = RandomDirection(cell, true);
+
+			if (direction == -1)
+			{
+				cells_[active_index] = cells_.back();
+				cells_.pop_back();
+				continue;
+			}
+
+			const std::size_t neighbor = GetNeighbor(cell, direction);
+			Carve(cell, direction, neighbor);
+			visited_[neighbor] = true;
+			cells_.push_back(static_cast<std::uint32_t>(neighbor));
+		}
+	}
+
+	void GeneratePrimWeighted()
+	{
+		/*
+		 * Frontier cells are keyed by their lightest edge into the tree and links_ holds that edge's direction. An edge is
+		 * only weighed when one of its cells joins the tree and the other is still outside, which happens once per edge, so
+		 * weights are drawn on the fly instead of being stored.
+		 */
+		links_.resize(GetCellCount());
+		frontier_.Reset(GetCellCount());
+
+		std::size_t cell = RandomIndex(GetCellCount());
+
+		while (true)
+		{
+			visited_[cell] = true;
+
+			for (int direction = 0; direction < direction_count; ++direction)
+			{
+				const std::size_t neighbor = GetNeighbor(cell, direction);
+
+				if (neighbor != npos && !visited_[neighbor] && frontier_.PushOrDecrease(static_cast<std::uint32_t>(neighbor), random_bits_.Next32()))
+				{
+					links_[neighbor] = static_cast<std::uint32_t>(Topology::opposite[direction]);
+				}
+			}
+
+			if (frontier_.IsEmpty())
+			{
+				return;
+			}
+
+			cell = frontier_.PopMin();
+			Carve(cell, static_cast<int>(links_[cell]), GetOpenNeighbor(cell, static_cast<int>(links_[cell])));
+		}
+	}
+
+	template <typename Selection>
+	void GenerateGrowingTree()
+	{
+		GrowingTreeCells& active_cells = growing_tree_cells_;
+		const auto random_index = [this](std::size_t bound) { return RandomIndex(bound); };
+
+		const std::uint32_t first_cell = static_cast<std::uint32_t>(RandomIndex(GetCellCount()));
+		active_cells.Reset<Selection>(GetCellCount());
+		active_cells.Add<Selection>(first_cell);
+		visited_[first_cell] = true;
+
+		while (!active_cells.IsEmpty<Selection>())
+		{
+			const std::size_t cell = active_cells.Select<Selection>(random_index);
+			const int direction = RandomDirection(cell, true);
+
+			if (direction == -1)
+			{
+				active_cells.RemoveSelected<Selection>();
+				continue;
+			}
+
+			const std::size_t neighbor = GetNeighbor(cell, direction);
+			Carve(cell, direction, neighbor);
+			visited_[neighbor] = true;
+			active_cells.Add<Selection>(static_cast<std::uint32_t>(neighbor));
+		}
+	}
+
+	/* Fills distances (unvisited where unreachable) and returns the reachable cell farthest from start. */
+	std::size_t BreadthFirstSearch(std::size_t start, std::vector<std::uint32_t>& distances)
+	{
+		distances.assign(GetCellCount(), unvisited);
+		distances[start] = 0;
+
+		cells_.clear();
+		cells_.reserve(GetCellCount());
+		cells_.push_back(static_cast<std::uint32_t>(start));
+
+		for (std::size_t queue_front = 0; queue_front < cells_.size(); ++queue_front)
+		{
+			const std::size_t cell = cells_[queue_front];
+
+			for (int direction = 0; direction < direction_count; ++direction)
+			{
+				if (!IsOpen(cell, direction))
+				{
+					continue;
+				}
+
+				const std::size_t neighbor = GetOpenNeighbor(cell, direction);
+
+				if (distances[neighbor] == unvisited)
+				{
+					distances[neighbor] = distances[cell] + 1;
+					cells_.push_back(static_cast<std::uint32_t>(neighbor));
+				}
+			}
+		}
+
+		const std::size_t farthest = cells_.back();
+		cells_.clear();
+
+		return farthest;
+	}
+
+	/* A perfect maze is a spanning tree: connected, with exactly one passage fewer than cells. */
+	bool IsPerfect(std::vector<std::uint32_t>& distances)
+	{
+		std::size_t passage_ends = 0;
+
+		for (const Mask passages : passages_)
+		{
+			for (int direction = 0; direction < direction_count; ++direction)
+			{
+				passage_ends += (passages >> direction) & 1;
+			}
+		}
+
+		if (passage_ends != 2 * (GetCellCount() - 1))
+		{
+			return false;
+		}
+
+		BreadthFirstSearch(0, distances);
+
+		return std::find(distances.begin(), distances.end(), unvisited) == distances.end();
+	}
+
+	/* Longest shortest path, exact for perfect mazes: the farthest cell from any cell is one end of it. */
+	std::uint32_t GetDiameter(std::vector<std::uint32_t>& distances)
+	{
+		const std::size_t end = BreadthFirstSearch(BreadthFirstSearch(0, distances), distances);
+		return distances[end];
+	}
+};
+
+#endif
@@ -0,0 +1,192 @@
+#ifndef GROWING_TREE_HPP
+#define GROWING_TREE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/*
+ * Growing Tree generators keep a set of active cells: they repeatedly select one, carve into a random
+ * unvisited neighbor (which becomes active) or remove the cell once it has none left. Which cell is
+ * selected decides the texture - always the newest gives the recursive backtracker, always a random one
+ * gives Prim's simplified, always the oldest gives long straight corridors fanning out from the start.
+ * A selection policy weighs the three choices at compile time, so every generator instantiation only
+ * keeps the containers and branches its policy needs.
+ */
+template <unsigned newest, unsigned oldest, unsigned random>
+struct GrowingTreeSelection
+{
+	static constexpr unsigned newest_weight = newest;
+	static constexpr unsigned oldest_weight = oldest;
+	static constexpr unsigned total_weight = newest + oldest + random;
+
+	static constexpr bool pure_newest = total_weight == newest;
+	static constexpr bool pure_oldest = total_weight == oldest;
+	static constexpr bool pure_random = total_weight == random;
+	static constexpr bool mixed = !pure_newest && !pure_oldest && !pure_random;
+
+	static_assert(total_weight > 0, "A selection policy needs at least one nonzero weight.");
+};
+
+using NewestSelection = GrowingTreeSelection<1, 0, 0>;
+using OldestSelection = GrowingTreeSelection<0, 1, 0>;
+using RandomSelection = GrowingTreeSelection<0, 0, 1>;
+
+/* Three newest picks for every random one: corridors as long as the backtracker's, but branching more often. */
+using MixedSelection = GrowingTreeSelection<3, 0, 1>;
+
+/*
+ * Active cell set with O(1) selection and removal for every policy. Cells are kept in insertion order
+ * (a stack for newest, a queue for oldest) and, for random picks, in a dense array with swap-removal.
+ * Mixed policies use both: a removed cell is dropped from the dense array at once and from the order
+ * only when it reaches one of its ends, so every cell is pushed and popped once (amortized O(1)).
+ */
+class GrowingTreeCells
+{
+private:
+	static constexpr std::uint32_t inactive = std::numeric_limits<std::uint32_t>::max();
+
+	std::vector<std::uint32_t> order_;
+	std::size_t order_head_ = 0;
+	std::vector<std::uint32_t> dense_;
+
+	/* Position of every active cell in dense_, only kept by mixed policies. */
+	std::vector<std::uint32_t> positions_;
+
+	std::uint32_t selected_ = 0;
+	std::size_t selected_position_ = 0;
+
+public:
+	template <typename Selection>
+	void Reset(std::size_t cell_count)
+	{
+		order_.clear();
+		order_head_ = 0;
+		dense_.clear();
+
+		if constexpr (!Selection::pure_random)
+		{
+			order_.reserve(cell_count);
+		}
+
+		if constexpr (!Selection::pure_newest && !Selection::pure_oldest)
+		{
+			dense_.reserve(cell_count);
+		}
+
+		if constexpr (Selection::mixed)
+		{
+			positions_.assign(cell_count, inactive);
+		}
+	}
+
+	template <typename Selection>
+	bool IsEmpty() const
+	{
+		if constexpr (Selection::pure_newest || Selection::pure_oldest)
+		{
+			return order_head_ == order_.size();
+		}
+		else
+		{
+			return dense_.empty();
+		}
+	}
+
+	template <typename Selection>
+	void Add(std::uint32_t cell)
+	{
+		if constexpr (!Selection::pure_random)
+		{
+			order_.push_back(cell);
+		}
+
+		if constexpr (Selection::mixed)
+		{
+			positions_[cell] = static_cast<std::uint32_t>(dense_.size());
+		}
+
+		if constexpr (!Selection::pure_newest && !Selection::pure_oldest)
+		{
+			dense_.push_back(cell);
+		}
+	}
+
+	/* random_index(bound) returns a uniform index below bound; pure newest and oldest policies never call it. */
+	template <typename Selection, typename RandomIndex>
+	std::uint32_t Select(RandomIndex random_index)
+	{
+		if constexpr (Selection::pure_newest)
+		{
+			selected_ = order_.back();
+		}
+		else if constexpr (Selection::pure_oldest)
+		{
+			selected_ = order_[order_head_];
+		}
+		else if constexpr (Selection::pure_random)
+		{
+			selected_position_ = random_index(dense_.size());
+			selected_ = dense_[selected_position_];
+		}
+		else
+		{
+			const std::size_t pick = random_index(Selection::total_weight);
+
+			if (pick < Selection::newest_weight)
+			{
+				while (positions_[order_.back()] == inactive)
+				{
+					order_.pop_back();
+				}
+
+				selected_ = order_.back();
+			}
+			else if (pick < Selection::newest_weight + Selection::oldest_weight)
+			{
+				while (positions_[order_[order_head_]] == inactive)
+				{
+					++order_head_;
+				}
+
+				selected_ = order_[order_head_];
+			}
+			else
+			{
+				selected_ = dense_[random_index(dense_.size())];
+			}
+		}
+
+		return selected_;
+	}
+
+	/* Removes the cell returned by the last Select. */
+	template <typename Selection>
+	void RemoveSelected()
+	{
+		if constexpr (Selection::pure_newest)
+		{
+			order_.pop_back();
+		}
+		else if constexpr (Selection::pure_oldest)
+		{
+			++order_head_;
+		}
+		else if constexpr (Selection::pure_random)
+		{
+			dense_[selected_position_] = dense_.back();
+			dense_.pop_back();
+		}
+		else
+		{
+			const std::uint32_t position = positions_[selected_];
+			dense_[position] = dense_.back();
+			positions_[dense_.back()] = position;
+			dense_.pop_back();
+			positions_[selected_] = inactive;
+		}
+	}
+};
+
+#endif
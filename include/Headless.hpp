@@ -0,0 +1,38 @@
+#ifndef HEADLESS_HPP
+#define HEADLESS_HPP
+
+#include "Maze.hpp"
+
+#include <string>
+
+/* Modes of the program that run without opening a window, selected by the first command line argument. */
+namespace headless
+{
+	bool FindOption(int argc, char* argv[], const std::string& name, std::string& value);
+
+	bool HasFlag(int argc, char* argv[], const std::string& name);
+
+	GenerationAlgorithm ParseAlgorithm(const std::string& value);
+
+	int RunExport(int argc, char* argv[]);
+
+	int RunTopology(int argc, char* argv[]);
+
+	int RunAnalyze(int argc, char* argv[]);
+
+	int RunUniformity(int argc, char* argv[]);
+
+	int RunBatch(int argc, char* argv[]);
+
+	int RunArchiveRead(int argc, char* argv[]);
+
+	int RunPaths(int argc, char* argv[]);
+
+	int RunServe(int argc, char* argv[]);
+
+	int RunServeBenchmark(int argc, char* argv[]);
+
+	int RunSharded(int argc, char* argv[]);
+} // namespace headless
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef HUD_HPP
+#define HUD_HPP
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+class Maze;
+
+/*
+ * Overlay with frame rate, a graph of recent frame times and the figures of the latest generation and search.
+ * Every printable ASCII glyph is rendered once into a single texture atlas when the HUD is created, so drawing
+ * text is one texture copy per character; the text itself is only reformatted a few times per second.
+ */
+class Hud
+{
+private:
+	static constexpr int first_glyph = 32;
+	static constexpr int last_glyph = 126;
+	static constexpr std::size_t frame_history = 240;
+	static constexpr std::size_t line_count = 7;
+	static constexpr std::size_t line_length = 96;
+
+	struct Glyph
+	{
+		SDL_Rect source_;
+		int advance_;
+	};
+
+	SDL_Texture* atlas_;
+	std::array<Glyph, last_glyph - first_glyph + 1> glyphs_;
+	int line_height_;
+	bool visible_;
+
+	/* Frame times in seconds, oldest first once the ring has wrapped at frame_index_. */
+	std::array<double, frame_history> frame_seconds_;
+	std::size_t frame_index_;
+	std::size_t frame_count_;
+
+	double refresh_seconds_;
+	std::array<std::array<char, line_length>, line_count> lines_;
+	std::vector<SDL_Rect> graph_rects_;
+
+	static TTF_Font* OpenFont(int point_size);
+
+	bool BuildAtlas(SDL_Renderer* renderer, TTF_Font* font);
+
+	void FormatLines(const Maze& maze);
+
+	void RenderText(SDL_Renderer* renderer, const char* text, int x, int y) const;
+
+public:
+	Hud();
+
+	~Hud();
+
+	Hud(const Hud&) = delete;
+
+	Hud& operator=(const Hud&) = delete;
+
+	/* Needs TTF_Init to have been called. Returns false when no font could be loaded; the HUD then stays hidden. */
+	bool Initialize(SDL_Renderer* renderer);
+
+	void Finalize();
+
+	void Toggle();
+
+	void RecordFrame(double seconds);
+
+	void Render(SDL_Renderer* renderer, const Maze& maze);
+};
+
+#endif
@@ -0,0 +1,148 @@
+#ifndef INDEXED_HEAP_HPP
+#define INDEXED_HEAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/*
+ * Min-heap of the items 0..capacity-1 keyed by 32-bit integers, with every item's heap position
+ * tracked so a queued key can be decreased in place. All storage is two flat arrays sized once per
+ * Reset; a d-ary layout keeps the tree shallow and a node's children on one or two cache lines.
+ */
+template <unsigned arity = 4>
+class IndexedHeap
+{
+private:
+	static constexpr std::uint32_t absent = std::numeric_limits<std::uint32_t>::max();
+
+	/* Keys live next to their items so sifting never leaves the heap array. */
+	struct Entry
+	{
+		std::uint32_t key_;
+		std::uint32_t item_;
+	};
+
+	std::vector<Entry> heap_;
+	std::vector<std::uint32_t> positions_;
+
+	/* Moves the entry up from position until its parent's key is not greater; the hole is shifted instead of swapping. */
+	void SiftUp(std::size_t position, Entry entry)
+	{
+		while (position > 0)
+		{
+			const std::size_t parent_position = (position - 1) / arity;
+
+			if (heap_[parent_position].key_ <= entry.key_)
+			{
+				break;
+			}
+
+			heap_[position] = heap_[parent_position];
+			positions_[heap_[position].item_] = static_cast<std::uint32_t>(position);
+			position = parent_position;
+		}
+
+		heap_[position] = entry;
+		positions_[entry.item_] = static_cast<std::uint32_t>(position);
+	}
+
+	void SiftDown(std::size_t position, Entry entry)
+	{
+		const std::size_t size = heap_.size();
+
+		while (true)
+		{
+			const std::size_t first_child = position * arity + 1;
+
+			if (first_child >= size)
+			{
+				break;
+			}
+
+			const std::size_t last_child = (first_child + arity < size) ? first_child + arity : size;
+			std::size_t smallest = first_child;
+
+			for (std::size_t child = first_child + 1; child < last_child; ++child)
+			{
+				if (heap_[child].key_ < heap_[smallest].key_)
+				{
+					smallest = child;
+				}
+			}
+
+			if (heap_[smallest].key_ >= entry.key_)
+			{
+				break;
+			}
+
+			heap_[position] = heap_[smallest];
+			positions_[heap_[position].item_] = static_cast<std::uint32_t>(position);
+			position = smallest;
+		}
+
+		heap_[position] = entry;
+		positions_[entry.item_] = static_cast<std::uint32_t>(position);
+	}
+
+public:
+	static_assert(arity >= 2, "A heap node needs at least two children.");
+
+	void Reset(std::size_t capacity)
+	{
+		heap_.clear();
+		heap_.reserve(capacity);
+		positions_.assign(capacity, absent);
+	}
+
+	bool IsEmpty() const
+	{
+		return heap_.empty();
+	}
+
+	std::size_t GetSize() const
+	{
+		return heap_.size();
+	}
+
+	/* Queues the item, or lowers its key if it is queued with a greater one. Returns false when nothing changed. */
+	bool PushOrDecrease(std::uint32_t item, std::uint32_t key)
+	{
+		const std::uint32_t position = positions_[item];
+
+		if (position == absent)
+		{
+			heap_.push_back({ key, item });
+			SiftUp(heap_.size() - 1, { key, item });
+			return true;
+		}
+
+		if (key >= heap_[position].key_)
+		{
+			return false;
+		}
+
+		SiftUp(position, { key, item });
+
+		return true;
+	}
+
+	std::uint32_t PopMin()
+	{
+		const std::uint32_t top = heap_.front().item_;
+		const Entry last = heap_.back();
+
+		heap_.pop_back();
+		positions_[top] = absent;
+
+		if (!heap_.empty())
+		{
+			SiftDown(0, last);
+		}
+
+		return top;
+	}
+};
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef INSTRUMENTATION_HPP
+#define INSTRUMENTATION_HPP
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+/*
+ * Hot-path counters for generators and solvers. Everything is compiled out unless
+ * MAZE_INSTRUMENTATION is defined (make INSTRUMENTATION=1). Each finished run is appended
+ * as one JSON object per line to the file named by MAZE_STATS_FILE (default maze_stats.jsonl).
+ * Every run counts into its own RunStats; the owner keeps a pointer to the innermost run in
+ * progress, which a nested run redirects to itself and restores when it ends.
+ */
+namespace instrumentation
+{
+	struct Phase
+	{
+		const char* name_;
+		double seconds_;
+	};
+
+	struct RunStats
+	{
+		using clock = std::chrono::steady_clock;
+
+		static constexpr std::size_t max_phases = 8;
+
+		const char* run_name_;
+		bool active_;
+
+		std::uint64_t rng_draws_;
+		std::uint64_t neighbor_lookups_;
+		std::uint64_t rejected_samples_;
+		std::size_t stack_high_water_;
+		std::size_t queue_high_water_;
+		std::uint64_t heap_allocations_;
+
+		std::array<Phase, max_phases> phases_;
+		std::size_t phase_count_;
+		const char* current_phase_;
+		clock::time_point phase_start_;
+
+		RunStats();
+
+		void BeginRun(const char* run_name);
+
+		void StartPhase(const char* name);
+
+		void EndPhase();
+
+		/* Adds time measured by the caller, for phases that are interrupted, such as generation advanced a few steps per tick. */
+		void AddPhaseTime(const char* name, double seconds);
+
+		void EndRun(int cells_width, int cells_height, std::uint32_t seed);
+	};
+
+	/* A run lasting one scope, with its own stats that current points to until the scope ends. */
+	class ScopedRun
+	{
+	private:
+		RunStats stats_;
+		RunStats*& current_;
+		RunStats* previous_;
+		int cells_width_;
+		int cells_height_;
+		std::uint32_t seed_;
+
+	public:
+		ScopedRun(RunStats*& current, const char* run_name, int cells_width, int cells_height, std::uint32_t seed);
+
+		ScopedRun(const ScopedRun&) = delete;
+
+		ScopedRun& operator=(const ScopedRun&) = delete;
+
+		~ScopedRun();
+	};
+
+	/* Number of operator new calls made by the calling thread so far. */
+	std::uint64_t HeapAllocations();
+} // namespace instrumentation
+
+#ifdef MAZE_INSTRUMENTATION
+#define MAZE_STATS_CONCAT_INNER(a, b) a##b
+#define MAZE_STATS_CONCAT(a, b) MAZE_STATS_CONCAT_INNER(a, b)
+#define MAZE_STATS_COUNT(stats, counter) (++(stats)->counter)
+#define MAZE_STATS_HIGH_WATER(stats, counter, value) ((stats)->counter = std::max<std::size_t>((stats)->counter, (value)))
+#define MAZE_STATS_BEGIN_RUN(stats, name) (stats)->BeginRun(name)
+#define MAZE_STATS_PHASE(stats, name) (stats)->StartPhase(name)
+#define MAZE_STATS_END_PHASE(stats) (stats)->EndPhase()
+#define MAZE_STATS_PHASE_TIME(stats, name, seconds) (stats)->AddPhaseTime((name), (seconds))
+#define MAZE_STATS_END_RUN(stats, width, height, seed) (stats)->EndRun((width), (height), (seed))
+#define MAZE_STATS_SCOPED_RUN(stats, name, width, height, seed) const instrumentation::ScopedRun MAZE_STATS_CONCAT(maze_stats_run_, __LINE__)((stats), (name), (width), (height), (seed))
+#define MAZE_STATS_HEAP_ALLOCATIONS() instrumentation::HeapAllocations()
+#else
+#define MAZE_STATS_COUNT(stats, counter) ((void)0)
+#define MAZE_STATS_HIGH_WATER(stats, counter, value) ((void)0)
+#define MAZE_STATS_BEGIN_RUN(stats, name) ((void)0)
+#define MAZE_STATS_PHASE(stats, name) ((void)0)
+#define MAZE_STATS_END_PHASE(stats) ((void)0)
+#define MAZE_STATS_PHASE_TIME(stats, name, seconds) ((void)0)
+#define MAZE_STATS_END_RUN(stats, width, height, seed) ((void)0)
+#define MAZE_STATS_SCOPED_RUN(stats, name, width, height, seed) ((void)0)
+#define MAZE_STATS_HEAP_ALLOCATIONS() std::uint64_t(0)
+#endif
+
+#endif
@@ -1,13 +1,32 @@
 #ifndef MAZE_HPP
 #define MAZE_HPP
 
+#include "BackgroundWorker.hpp"
+#include "Camera.hpp"
+#include "GenerationAlgorithm.hpp"
+#include "GridMaze.hpp"
+#include "GrowingTree.hpp"
+#include "IndexedHeap.hpp"
+#include "Instrumentation.hpp"
+#include "RandomBits.hpp"
+
 #include <SDL2/SDL.h>
 
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
 #include <vector>
 #include <mutex>
 
 struct Cell;
 class Game;
+class SoftwareRasterizer;
+class WorkerPool;
 
 struct CellEdge
 {
@@ -29,19 +48,54 @@ struct Cell
 	int weight_;
 };
 
+/* Figures of the latest generation and search, for the performance HUD. */
+struct PerformanceStats
+{
+	GenerationAlgorithm algorithm_;
+	std::size_t generated_cells_;
+
+	/* Time spent carving only, without the ticks an animated generation waits between its steps. */
+	double generation_seconds_;
+
+	std::size_t search_nodes_expanded_;
+	double search_seconds_;
+
+	/* Cells on the shortest path including both ends, 0 when there is none. */
+	std::size_t path_length_;
+};
+
+/* Blocks of block x block cells intersecting the view, first and last inclusive. */
+struct BlockRange
+{
+	int first_x_;
+	int first_y_;
+	int last_x_;
+	int last_y_;
+};
+
+/* Left, right, top and bottom neighbor, nullptr where there is none. Returned by value so lookups never allocate. */
+using CellNeighbors = std::array<Cell*, 4>;
+
 class Maze
 {
 private:
+    static constexpr std::uint32_t masked_out_cell = std::numeric_limits<std::uint32_t>::max();
+    static constexpr int unreached_distance = std::numeric_limits<int>::max();
+
     Game* game_;
     std::size_t test_loops_;
     bool shift_pressed_;
     bool left_mouse_button_pressed_;
+    bool right_mouse_button_pressed_;
 
     int cell_size_;
     int cells_width_;
     int cells_height_;
     
+    /* Only cells inside the mask are stored; cell_lookup_ maps grid positions (y * cells_width_ + x) to board_ indices. */
     std::vector<Cell> board_;
+    std::vector<std::uint32_t> cell_lookup_;
+    std::string mask_path_;
 
     std::vector<Cell*> bfs_cells_predecessors_;
     std::vector<int> bfs_cells_distances_;
@@ -51,6 +105,110 @@ private:
     bool shortest_path_found_;
 	SDL_Point mouse_position_;
 
+    /*
+     * Set while bfs_cells_predecessors_ and bfs_cells_distances_ hold the whole breadth-first tree of the start cell
+     * (unreached cells at unreached_distance) instead of a search that stopped at the end cell. Carving then repairs
+     * the tree around the changed passage, so the solution stays live without searching the board again.
+     */
+    bool path_tree_complete_;
+    std::vector<Cell*> repair_cells_;
+    std::vector<Cell*> repair_seeds_;
+
+    /* Two-sided search of AreCellsConnected; a cell is marked with the stamp of the current search plus its side. */
+    std::vector<std::uint32_t> connection_marks_;
+    std::uint32_t connection_stamp_;
+    std::vector<Cell*> connection_queues_[2];
+
+    /*
+     * World-space centres of the shortest path cells from the start to the end cell, built once per solve so
+     * rendering is a single SDL_RenderDrawLines call. The first path_revealed_points_ of them are drawn; Tick()
+     * grows that count when the reveal is animated.
+     */
+    std::vector<SDL_Point> path_points_;
+    std::vector<SDL_Point> render_path_points_;
+    std::size_t path_revealed_points_;
+    bool animate_path_;
+
+    RandomBits<std::mt19937> random_bits_;
+    std::uint32_t seed_;
+
+    /* State of the generator currently being advanced by Tick(). */
+    GenerationAlgorithm generation_algorithm_;
+    bool animate_generation_;
+    std::size_t generation_steps_per_tick_;
+    double generation_time_budget_us_;
+    std::vector<Cell*> generation_cells_;
+    Cell* generation_current_cell_;
+    std::size_t generation_hunt_index_;
+    std::size_t generation_remaining_;
+    std::vector<std::size_t> kruskal_parents_;
+    std::vector<std::size_t> kruskal_set_sizes_;
+
+    /* Backtracker on large boards: two bits per cell with the direction back to the cell it was carved from, instead of a stack. */
+    bool stackless_backtracker_;
+    std::vector<std::uint8_t> backtracker_came_from_;
+    std::size_t backtracker_first_index_;
+    GrowingTreeCells growing_tree_cells_;
+
+    /* Weighted Prim's frontier keyed by the lightest edge into the tree, and that edge's direction per cell. */
+    IndexedHeap<> prim_frontier_;
+    std::vector<std::uint8_t> prim_parent_directions_;
+
+    /* Fraction of dead ends the braid (b) and sparsify (s) passes remove. */
+    double braid_fraction_;
+    double sparsify_fraction_;
+
+    /* Scratch buffers reused by every search so steady-state solving does not allocate. */
+    std::vector<Cell*> search_cells_;
+    std::vector<Cell*> dfs_cells_parents_;
+    std::vector<bool> dfs_cells_discovering_;
+
+    Camera camera_;
+
+    /* A generation advanced by Tick() spans many calls, so its run lives here; stats_ points to the innermost run in progress. */
+    instrumentation::RunStats generation_stats_;
+    instrumentation::RunStats* stats_;
+    PerformanceStats performance_;
+
+    /*
+     * Wall density pyramid used when cells are too small on screen to draw individually. Level n aggregates 2^n x 2^n cells.
+     * lod_dirty_ discards the whole pyramid; cells changed one at a time only queue their level 1 block in lod_dirty_blocks_,
+     * and just those blocks and the blocks above them are recomputed.
+     */
+    std::vector<std::vector<std::uint8_t>> lod_levels_;
+    bool lod_dirty_;
+    std::vector<std::size_t> lod_dirty_blocks_;
+    std::vector<SDL_Rect> render_floor_rects_;
+    std::vector<SDL_Rect> render_wall_rects_;
+    std::vector<std::vector<SDL_Rect>> render_lod_rects_;
+
+    /*
+     * Backend for cells of a few pixels, created on first use. Rows of cells whose walls changed since its
+     * bit planes were last updated are kept as a first/last range, empty while first > last.
+     */
+    std::unique_ptr<SoftwareRasterizer> software_rasterizer_;
+    bool software_rendering_;
+    int raster_first_changed_row_;
+    int raster_last_changed_row_;
+
+    /*
+     * Generation without animation, solving and longest paths run on a worker thread against back_maze_, whose board
+     * is swapped with this one once the job completes. While a job runs this board is only read, so anything that
+     * changes it cancels the job first. background_algorithm_ is the algorithm of a generation job in flight.
+     */
+    std::unique_ptr<Maze> back_maze_;
+    std::unique_ptr<BackgroundWorker> background_worker_;
+    GenerationAlgorithm background_algorithm_;
+
+    /* Bytes held by back_maze_ as of its last completed job; the worker thread resizes its buffers while a job runs. */
+    std::size_t back_maze_footprint_;
+
+    /* Set while this maze runs a background job; long loops poll it and give up early. */
+    const std::atomic<bool>* cancel_flag_;
+
+    /* Threads of the process, shared with everything else that runs in parallel; without one, parallel passes run inline. */
+    WorkerPool* worker_pool_;
+
 public:
     Maze(Game* game = nullptr);
 
@@ -62,12 +220,55 @@ public:
 
     void Render();
 
-    int GetRandomNeighborIndex(const std::vector<Cell*>& neighbors, bool unvisited);
+    int GetRandomNeighborIndex(const CellNeighbors& neighbors, bool unvisited);
 
-    void SetConnections(Cell* current_cell, const std::vector<Cell*>& neighbors, std::size_t neighbor_index, bool unset = false);
+    void SetConnections(Cell* current_cell, const CellNeighbors& neighbors, std::size_t neighbor_index, bool unset = false);
 
     std::size_t GetCellIndex(const Cell& cell);
 
+    std::uint32_t NextSeed();
+
+    std::size_t RandomIndex(std::size_t bound);
+
+    void BeginGeneration(GenerationAlgorithm algorithm, std::uint32_t seed);
+
+    bool StepGeneration();
+
+    /* Returns false when the generation was cancelled before it finished. */
+    bool FinishGeneration();
+
+    void GenerateMaze(GenerationAlgorithm algorithm, std::uint32_t seed);
+
+    bool IsGenerating() const;
+
+    const char* GetAlgorithmName(GenerationAlgorithm algorithm) const;
+
+    const char* GetAlgorithmId(GenerationAlgorithm algorithm) const;
+
+    bool StepRecursiveBacktracker();
+
+    bool StepStacklessBacktracker();
+
+    bool StepHuntAndKill();
+
+    bool StepWilsons();
+
+    bool StepRandomizedKruskal();
+
+    bool StepPrimSimplified();
+
+    void QueuePrimWeightedNeighbors(std::size_t cell_index);
+
+    bool StepPrimWeighted();
+
+    template <typename Selection>
+    void BeginGrowingTree();
+
+    template <typename Selection>
+    bool StepGrowingTree();
+
+    std::size_t FindKruskalSet(std::size_t cell_index);
+
     void GenerateMazeRecursiveBacktracker();
     
     void GenerateMazeHuntAndKill();
@@ -78,11 +279,29 @@ public:
     
     void GenerateMazePrimSimplified();
 
+    void BraidMaze(double dead_end_fraction, std::uint32_t seed);
+
+    void SparsifyMaze(double dead_end_fraction, std::uint32_t seed);
+
+    void RunDeadEndPass(double dead_end_fraction, std::uint32_t seed, bool braid);
+
+    void ProcessDeadEndRows(int first_row, int last_row, double dead_end_fraction, std::uint64_t seed_key, bool braid);
+
     void BreadthFirstSearch(Cell* start_cell);
 
     bool DetectCycleDepthFirstSearch(Cell* start_cell);
 
+    /* Whether a path of open passages joins the two cells, found without searching more than their own surroundings. */
+    bool AreCellsConnected(Cell& first_cell, Cell& second_cell);
+
     bool FindShortestPathBetweenStartEnd();
+
+    std::size_t BuildPathTree();
+
+    std::size_t RepairPathTree(Cell& first_cell, Cell& second_cell, bool opened);
+
+    /* Keeps the solution up to date after the passage between two neighboring cells was opened or closed by hand. */
+    void UpdatePathAfterCarving(Cell& first_cell, Cell& second_cell, bool opened);
     
     bool FindLongestPathInMaze();
 
@@ -92,17 +311,72 @@ public:
 
     void SetCellSize(std::size_t size);
 
+    bool SetBoardSize(int cells_width, int cells_height);
+
+    std::size_t GetCellCount() const;
+
+    const PerformanceStats& GetPerformanceStats() const;
+
+    /* Bytes held by the board, search and render buffers, including those of the background maze after its last job. */
+    std::size_t GetMemoryFootprint() const;
+
+    /* Identifies the wall layout; the canonical fingerprint is the same for rotated and mirrored copies. */
+    std::uint64_t GetFingerprint(bool canonical);
+
+    /* Two bits per grid cell in row-major order: bit 0 is set when the cell is open to the right, bit 1 when it is open to the bottom. */
+    void PackWalls(std::vector<std::uint8_t>& walls);
+
+    /* Copy of the passages indexed like PackWalls, masked-out cells closed, for PathQueries and other readers that must not see later edits. */
+    GridMaze<SquareTopology> GetGridSnapshot();
+
+    /* Grid indices (y * width + x) of the cells on the shortest path from the start to the end cell; false when there is none. */
+    bool GetSolutionPath(std::vector<std::uint32_t>& path);
+
+    bool SetStartEndCells(std::size_t start_index, std::size_t end_index);
+
+    bool ExportPng(const std::string& path, int cell_pixels, int wall_pixels, bool draw_solution);
+
+    Cell* GetCellAtScreen(int screen_x, int screen_y);
+
+    Cell* GetCellAt(int x, int y);
+
+    void BuildBoard();
+
+    bool SampleMask(std::vector<bool>& active_cells);
+
+    bool LoadMask(const std::string& path);
+
+    void ClearMask();
+
+    BlockRange GetVisibleBlockRange(int block) const;
+
+    void MarkLevelOfDetailChanged(int x, int y);
+
+    std::uint8_t GetBlockDensity(std::size_t level, int x, int y);
+
+    void BuildLevelOfDetail(std::size_t level);
+
+    void RenderLevelOfDetail(std::size_t level);
+
     void RenderGrid();
 		
     void RenderCells();
 
+    void MarkRowsChanged(int first_row, int last_row);
+
+    bool RenderRasterized();
+
+    void BuildPathPoints();
+
+    void RenderPath();
+
     int GetNeighborIndex(const Cell& current_cell, const Cell& neighbor_cell);
 
     void PrintDistancesAndPredecessors();
 
-    std::vector<Cell*> GetConnectedNeighborCells(const Cell& current_cell);
+    CellNeighbors GetConnectedNeighborCells(const Cell& current_cell);
 
-    std::vector<Cell*> GetNeighborCells(std::size_t cell_index);
+    CellNeighbors GetNeighborCells(std::size_t cell_index);
 
     Cell* GetLeftNeighbor(std::size_t cell_index);
     
@@ -121,6 +395,31 @@ public:
     void TestRandomizedKruskals();
 
     void TestPrimSimplified();
+
+    void TestGenerator(GenerationAlgorithm algorithm);
+
+    void SetCancelFlag(const std::atomic<bool>* cancel_flag);
+
+    void SetWorkerPool(WorkerPool* worker_pool);
+
+    bool IsCancelled() const;
+
+    void StartBackgroundJob(GenerationAlgorithm algorithm, std::function<void(Maze& back_maze)> work);
+
+    void StartBackgroundSolve();
+
+    void CancelBackgroundJob();
+
+    void SetWindowTitle(GenerationAlgorithm algorithm, std::uint32_t seed);
+
+    /* Rebuilds this board with the size, cell size and mask of the other maze, unless they already match. */
+    void CopyLayout(const Maze& other);
+
+    /* Copies the passages of a maze with the same layout, and the figures of their generation. */
+    void CopyWalls(const Maze& other);
+
+    /* Exchanges boards and search results with a maze of the same layout, and the seeds too when the other board was generated. */
+    void SwapBoards(Maze& other, bool generated);
 };
 
 #endif
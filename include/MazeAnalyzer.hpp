@@ -0,0 +1,218 @@
+#ifndef MAZE_ANALYZER_HPP
+#define MAZE_ANALYZER_HPP
+
+#include "GridMaze.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/*
+ * Texture metrics summed over any number of mazes. Every field is a plain sum (or maximum), so each
+ * thread keeps its own instance and the results are merged once the threads are done, without locks.
+ */
+struct MazeStatistics
+{
+	/* Corridors of this many or more cells share the last histogram bucket. */
+	static constexpr std::size_t corridor_histogram_size = 32;
+
+	std::uint64_t maze_count_ = 0;
+	std::uint64_t cell_count_ = 0;
+	std::uint64_t dead_ends_ = 0;
+	std::uint64_t junctions_ = 0;
+
+	/* Passages leading on (passages - 1) summed over every cell that is not a dead end. */
+	std::uint64_t branches_ = 0;
+	std::uint64_t branching_cells_ = 0;
+
+	/* Cells with exactly two passages, and how many of them turn instead of going straight. */
+	std::uint64_t corridor_cells_ = 0;
+	std::uint64_t turns_ = 0;
+
+	/* Branches that end in a dead end, with the cells walked from the last junction to the dead end. */
+	std::uint64_t dead_end_branches_ = 0;
+	std::uint64_t dead_end_branch_cells_ = 0;
+
+	std::uint64_t diameter_sum_ = 0;
+	std::uint64_t diameter_max_ = 0;
+	std::uint64_t solution_length_sum_ = 0;
+	std::uint64_t unsolved_ = 0;
+
+	std::array<std::uint64_t, corridor_histogram_size> corridor_lengths_ = {};
+
+	void Merge(const MazeStatistics& other);
+
+	void Print() const;
+};
+
+/*
+ * Computes MazeStatistics of a GridMaze with one linear sweep over the passage masks (dead ends,
+ * junctions, branching, turns) and a double breadth-first sweep: the first one, from cell 0, gives
+ * the solution length to the last cell and a dead end farthest from it; the second one starts at that
+ * dead end, which yields the diameter and visits every corridor of a perfect maze exactly once from
+ * one of its ends. Scratch buffers are kept between mazes.
+ */
+template <typename Topology>
+class MazeAnalyzer
+{
+private:
+	using Grid = GridMaze<Topology>;
+
+	static constexpr std::uint32_t unvisited = std::numeric_limits<std::uint32_t>::max();
+
+	std::vector<std::uint32_t> distances_;
+	std::vector<std::uint32_t> corridor_runs_;
+	std::vector<std::uint32_t> queue_;
+
+	/* Per passage mask: number of passages, and whether the mask is a corridor cell that turns. */
+	struct MaskTraits
+	{
+		std::array<std::uint8_t, 256> passage_counts_;
+		std::array<std::uint8_t, 256> turns_;
+	};
+
+	static constexpr MaskTraits mask_traits = []()
+	{
+		MaskTraits traits = {};
+
+		for (int passages = 1; passages < 256; ++passages)
+		{
+			traits.passage_counts_[passages] = static_cast<std::uint8_t>(traits.passage_counts_[passages >> 1] + (passages & 1));
+		}
+
+		for (int direction = 0; direction < Grid::direction_count; ++direction)
+		{
+			for (int other = direction + 1; other < Grid::direction_count; ++other)
+			{
+				traits.turns_[(1 << direction) | (1 << other)] = (Topology::opposite[direction] != other);
+			}
+		}
+
+		return traits;
+	}();
+
+	static int CountPassages(typename Grid::Mask passages)
+	{
+		return mask_traits.passage_counts_[passages];
+	}
+
+	/* Returns the last cell dequeued, which is farthest from start. Corridors are recorded when statistics is not null. */
+	std::size_t BreadthFirstSearch(const Grid& maze, std::size_t start, MazeStatistics* statistics)
+	{
+		distances_.assign(maze.GetCellCount(), unvisited);
+		distances_[start] = 0;
+		corridor_runs_.resize(maze.GetCellCount());
+		corridor_runs_[start] = 0;
+
+		queue_.clear();
+		queue_.reserve(maze.GetCellCount());
+		queue_.push_back(static_cast<std::uint32_t>(start));
+
+		for (std::size_t queue_front = 0; queue_front < queue_.size(); ++queue_front)
+		{
+			const std::size_t cell = queue_[queue_front];
+			const bool cell_in_corridor = CountPassages(maze.GetPassages(cell)) == 2;
+
+			for (int direction = 0; direction < Grid::direction_count; ++direction)
+			{
+				if (!maze.IsOpen(cell, direction))
+				{
+					continue;
+				}
+
+				const std::size_t neighbor = maze.GetOpenNeighbor(cell, direction);
+
+				if (distances_[neighbor] != unvisited)
+				{
+					continue;
+				}
+
+				distances_[neighbor] = distances_[cell] + 1;
+				queue_.push_back(static_cast<std::uint32_t>(neighbor));
+
+				if (statistics == nullptr)
+				{
+					continue;
+				}
+
+				/* Number of corridor cells walked since the last dead end or junction. */
+				corridor_runs_[neighbor] = cell_in_corridor ? corridor_runs_[cell] + 1 : 0;
+
+				const int neighbor_passages = CountPassages(maze.GetPassages(neighbor));
+
+				if (neighbor_passages == 2)
+				{
+					continue;
+				}
+
+				if (corridor_runs_[neighbor] > 0)
+				{
+					++statistics->corridor_lengths_[std::min<std::size_t>(corridor_runs_[neighbor], MazeStatistics::corridor_histogram_size) - 1];
+				}
+
+				if (neighbor_passages == 1)
+				{
+					++statistics->dead_end_branches_;
+					statistics->dead_end_branch_cells_ += corridor_runs_[neighbor] + 1;
+				}
+			}
+		}
+
+		return queue_.back();
+	}
+
+public:
+	void Analyze(const Grid& maze, MazeStatistics& statistics)
+	{
+		++statistics.maze_count_;
+		statistics.cell_count_ += maze.GetCellCount();
+
+		/* Branch-free sweep: cell classes are looked up per passage mask and summed into locals. */
+		std::uint64_t dead_ends = 0;
+		std::uint64_t junctions = 0;
+		std::uint64_t branches = 0;
+		std::uint64_t branching_cells = 0;
+		std::uint64_t corridor_cells = 0;
+		std::uint64_t turns = 0;
+
+		for (std::size_t cell = 0; cell < maze.GetCellCount(); ++cell)
+		{
+			const typename Grid::Mask passages = maze.GetPassages(cell);
+			const int passage_count = CountPassages(passages);
+
+			dead_ends += (passage_count == 1);
+			junctions += (passage_count > 2);
+			branches += (passage_count > 1) ? passage_count - 1 : 0;
+			branching_cells += (passage_count > 1);
+			corridor_cells += (passage_count == 2);
+			turns += mask_traits.turns_[passages];
+		}
+
+		statistics.dead_ends_ += dead_ends;
+		statistics.junctions_ += junctions;
+		statistics.branches_ += branches;
+		statistics.branching_cells_ += branching_cells;
+		statistics.corridor_cells_ += corridor_cells;
+		statistics.turns_ += turns;
+
+		const std::size_t last_cell = maze.GetCellCount() - 1;
+		const std::size_t farthest = BreadthFirstSearch(maze, 0, nullptr);
+
+		if (distances_[last_cell] == unvisited)
+		{
+			++statistics.unsolved_;
+		}
+		else
+		{
+			statistics.solution_length_sum_ += distances_[last_cell];
+		}
+
+		const std::uint32_t diameter = distances_[BreadthFirstSearch(maze, farthest, &statistics)];
+		statistics.diameter_sum_ += diameter;
+		statistics.diameter_max_ = std::max<std::uint64_t>(statistics.diameter_max_, diameter);
+	}
+};
+
+#endif
@@ -0,0 +1,135 @@
+#ifndef MAZE_ARCHIVE_HPP
+#define MAZE_ARCHIVE_HPP
+
+#include "WorkerPool.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+/*
+ * Container for many mazes of one size, every one stored under a 64-bit id (the seed for generated batches).
+ * Walls are given and returned in the Maze::PackWalls layout and coded with a binary range coder whose
+ * probabilities are conditioned on the passages already known around the cell, so a perfect maze takes
+ * well under the 2 raw bits per cell. Mazes are grouped into blocks that share their adaptive model; the
+ * blocks are coded independently of each other, in parallel, and an index of block offsets and first ids
+ * at the end of the file finds the block holding any id, so a single maze is read without the others.
+ *
+ * File layout, little-endian: a 40 byte header ("MZAR", version, width, height, mazes per block, algorithm,
+ * maze count, index offset), the blocks, and the index (offset and first id of every block). A block
+ * starts with the differences between its consecutive ids as varints, followed by the coded walls.
+ */
+class MazeArchiveWriter
+{
+public:
+	/* Fills walls with maze index of the batch being appended and returns its id. Called from several threads at once. */
+	using MazeSource = std::function<std::uint64_t(std::size_t index, std::vector<std::uint8_t>& walls, int thread_index)>;
+
+private:
+	struct BlockEncoder;
+
+	WorkerPool& pool_;
+	std::FILE* file_;
+	std::string path_;
+	int width_;
+	int height_;
+	std::uint32_t algorithm_;
+	std::uint32_t block_size_;
+	std::uint64_t maze_count_;
+	std::uint64_t offset_;
+	bool failed_;
+
+	/* Offset and first id of every block written so far; the last id guards the increasing order across blocks. */
+	std::vector<std::uint64_t> block_offsets_;
+	std::vector<std::uint64_t> block_first_ids_;
+	std::uint64_t last_id_;
+
+	/* Blocks of the window being coded; a final, partly filled one stays open for the next Append. */
+	std::vector<BlockEncoder> encoders_;
+	std::vector<std::vector<std::uint8_t>> thread_walls_;
+	std::size_t open_block_mazes_;
+
+	bool WriteBlock(BlockEncoder& encoder);
+
+public:
+	explicit MazeArchiveWriter(WorkerPool& pool);
+
+	~MazeArchiveWriter();
+
+	MazeArchiveWriter(const MazeArchiveWriter&) = delete;
+
+	MazeArchiveWriter& operator=(const MazeArchiveWriter&) = delete;
+
+	/* algorithm is only recorded, so readers can regenerate mazes from their ids; 0 when unknown. */
+	bool Open(const std::string& path, int width, int height, std::uint32_t algorithm, std::uint32_t block_size = 64);
+
+	/* Ids must increase over the whole archive. Mazes are produced and coded a window of blocks at a time, so memory stays bounded. */
+	bool Append(std::size_t maze_count, const MazeSource& source);
+
+	/* Writes the open block and the index. */
+	bool Close();
+
+	std::uint64_t GetMazeCount() const;
+
+	/* Bytes written so far. */
+	std::uint64_t GetSize() const;
+};
+
+class MazeArchiveReader
+{
+public:
+	/* Called from several threads at once and in no particular order. */
+	using MazeVisitor = std::function<void(std::uint64_t id, const std::vector<std::uint8_t>& walls, int thread_index)>;
+
+private:
+	WorkerPool& pool_;
+	std::FILE* file_;
+	int width_;
+	int height_;
+	std::uint32_t algorithm_;
+	std::uint32_t block_size_;
+	std::uint64_t maze_count_;
+	std::uint64_t index_offset_;
+	std::vector<std::uint64_t> block_offsets_;
+	std::vector<std::uint64_t> block_first_ids_;
+
+	std::vector<std::uint8_t> read_buffer_;
+	std::vector<std::vector<std::uint8_t>> thread_walls_;
+	std::vector<std::vector<std::uint64_t>> thread_ids_;
+
+	std::size_t GetBlockMazeCount(std::size_t block) const;
+
+	bool ReadBlocks(std::size_t first_block, std::size_t block_count);
+
+public:
+	explicit MazeArchiveReader(WorkerPool& pool);
+
+	~MazeArchiveReader();
+
+	MazeArchiveReader(const MazeArchiveReader&) = delete;
+
+	MazeArchiveReader& operator=(const MazeArchiveReader&) = delete;
+
+	bool Open(const std::string& path);
+
+	int GetWidth() const;
+
+	int GetHeight() const;
+
+	std::uint32_t GetAlgorithm() const;
+
+	std::uint64_t GetMazeCount() const;
+
+	std::size_t GetBlockCount() const;
+
+	/* Decodes the block holding the maze up to it; false when there is no maze with this id. */
+	bool ReadMaze(std::uint64_t id, std::vector<std::uint8_t>& walls);
+
+	/* Decodes every maze, a window of blocks at a time with the blocks of a window in parallel. */
+	bool ReadAll(const MazeVisitor& visit);
+};
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef PACKED_WALLS_HPP
+#define PACKED_WALLS_HPP
+
+#include "GridMaze.hpp"
+#include "Topology.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * The packed wall layout of Maze::PackWalls, which archives, server responses, sharded generation and the
+ * headless commands all exchange: two bits per cell in row-major order, four cells per byte from the low bits
+ * up. Bit 0 is set when the passage to the right neighbor is open, bit 1 when the one to the bottom neighbor
+ * is; left and top passages are those of the neighbors, and passages out of the grid are never set.
+ */
+namespace packed_walls
+{
+	constexpr int right_open = 1;
+	constexpr int bottom_open = 2;
+
+	inline std::size_t GetSize(std::size_t cell_count)
+	{
+		return (cell_count * 2 + 7) / 8;
+	}
+
+	inline int GetPassages(const std::uint8_t* walls, std::size_t cell)
+	{
+		return (walls[cell / 4] >> (2 * (cell % 4))) & 3;
+	}
+
+	/* Opens the given passages of a cell; passages that are already open stay open. */
+	inline void AddPassages(std::uint8_t* walls, std::size_t cell, int passages)
+	{
+		walls[cell / 4] |= static_cast<std::uint8_t>(passages << (2 * (cell % 4)));
+	}
+
+	/* Packs a square GridMaze into GetSize(cell count) zeroed bytes. */
+	template <typename Engine>
+	void Pack(const GridMaze<SquareTopology, Engine>& maze, std::uint8_t* walls)
+	{
+		const GridDimensions& dimensions = maze.GetDimensions();
+
+		for (int y = 0; y < dimensions.height_; ++y)
+		{
+			for (int x = 0; x < dimensions.width_; ++x)
+			{
+				const std::size_t cell = maze.GetCellIndex(x, y, 0);
+				const int passages = (maze.IsOpen(cell, 1) ? right_open : 0) | (maze.IsOpen(cell, 3) ? bottom_open : 0);
+
+				AddPassages(walls, static_cast<std::size_t>(y) * dimensions.width_ + x, passages);
+			}
+		}
+	}
+
+	template <typename Engine>
+	void Pack(const GridMaze<SquareTopology, Engine>& maze, std::vector<std::uint8_t>& walls)
+	{
+		walls.assign(GetSize(maze.GetCellCount()), 0);
+		Pack(maze, walls.data());
+	}
+
+	/* Opens the passages of packed walls in a square GridMaze of the same size, after closing all of its walls. */
+	template <typename Engine>
+	void Unpack(const std::uint8_t* walls, GridMaze<SquareTopology, Engine>& maze)
+	{
+		const std::size_t width = static_cast<std::size_t>(maze.GetDimensions().width_);
+		maze.Reset();
+
+		for (std::size_t cell = 0; cell < maze.GetCellCount(); ++cell)
+		{
+			const int passages = GetPassages(walls, cell);
+
+			if (passages & right_open)
+			{
+				maze.Carve(cell, 1, cell + 1);
+			}
+
+			if (passages & bottom_open)
+			{
+				maze.Carve(cell, 3, cell + width);
+			}
+		}
+	}
+
+	/* The fingerprint::HashWalls fingerprint of packed walls, the same as that of the maze they were packed from. */
+	std::uint64_t Hash(int cells_width, int cells_height, const std::uint8_t* walls);
+} // namespace packed_walls
+
+#endif
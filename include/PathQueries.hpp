@@ -0,0 +1,271 @@
+#ifndef PATH_QUERIES_HPP
+#define PATH_QUERIES_HPP
+
+#include "GridMaze.hpp"
+#include "WorkerPool.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+struct PathQuery
+{
+	std::uint32_t source_;
+	std::uint32_t target_;
+};
+
+/* Answers in query order. With paths, query i's cells from source to target are path_cells_[path_offsets_[i], path_offsets_[i + 1]). */
+struct PathQueryResults
+{
+	static constexpr std::uint32_t unreachable = std::numeric_limits<std::uint32_t>::max();
+
+	std::vector<std::uint32_t> distances_;
+	std::vector<std::size_t> path_offsets_;
+	std::vector<std::uint32_t> path_cells_;
+};
+
+/*
+ * Shortest paths for many (source, target) pairs on one maze that does not change while they run.
+ * Queries are grouped by source and every group is one breadth-first search, stopped as soon as all
+ * of its targets are reached, so many agents heading out of the same cell cost a single traversal.
+ * Groups are spread over a WorkerPool and every thread keeps its own scratch buffers between runs;
+ * visits are marked with a per-search stamp, so nothing proportional to the maze is cleared per search.
+ */
+template <typename Topology>
+class PathQueries
+{
+private:
+	using Grid = GridMaze<Topology>;
+
+	struct Scratch
+	{
+		std::uint32_t stamp_ = 0;
+		std::vector<std::uint32_t> visit_stamps_;
+		std::vector<std::uint32_t> target_stamps_;
+		std::vector<std::uint32_t> distances_;
+		std::vector<std::uint8_t> parent_directions_;
+		std::vector<std::uint32_t> queue_;
+
+		/* Paths found by this thread, copied into the results once every offset is known. */
+		std::vector<std::uint32_t> path_cells_;
+	};
+
+	/* Where a query's path was written: the thread's scratch and the offset in it. */
+	struct PathLocation
+	{
+		std::uint32_t thread_index_;
+		std::size_t offset_;
+	};
+
+	WorkerPool& pool_;
+	std::vector<Scratch> scratch_;
+
+	/* Query indices sorted by source, and where each source's group starts in it. */
+	std::vector<std::uint64_t> order_;
+	std::vector<std::size_t> group_starts_;
+	std::vector<PathLocation> path_locations_;
+
+	void PrepareScratch(Scratch& scratch, std::size_t cell_count)
+	{
+		if (scratch.visit_stamps_.size() != cell_count)
+		{
+			scratch.stamp_ = 0;
+			scratch.visit_stamps_.assign(cell_count, 0);
+			scratch.target_stamps_.assign(cell_count, 0);
+			scratch.distances_.resize(cell_count);
+			scratch.parent_directions_.resize(cell_count);
+		}
+
+		if (++scratch.stamp_ == 0)
+		{
+			std::fill(scratch.visit_stamps_.begin(), scratch.visit_stamps_.end(), 0);
+			std::fill(scratch.target_stamps_.begin(), scratch.target_stamps_.end(), 0);
+			scratch.stamp_ = 1;
+		}
+	}
+
+	void SolveGroup(const Grid& maze, std::size_t group, int thread_index, const std::vector<PathQuery>& queries, bool with_paths, PathQueryResults& results)
+	{
+		Scratch& scratch = scratch_[thread_index];
+		PrepareScratch(scratch, maze.GetCellCount());
+
+		const std::uint32_t stamp = scratch.stamp_;
+		const std::size_t group_begin = group_starts_[group];
+		const std::size_t group_end = group_starts_[group + 1];
+		const std::uint32_t source = queries[order_[group_begin] & 0xffffffff].source_;
+		std::size_t remaining_targets = 0;
+
+		for (std::size_t i = group_begin; i < group_end; ++i)
+		{
+			const std::uint32_t target = queries[order_[i] & 0xffffffff].target_;
+			assert(target < maze.GetCellCount());
+
+			if (scratch.target_stamps_[target] != stamp)
+			{
+				scratch.target_stamps_[target] = stamp;
+				++remaining_targets;
+			}
+		}
+
+		scratch.queue_.clear();
+		scratch.queue_.push_back(source);
+		scratch.visit_stamps_[source] = stamp;
+		scratch.distances_[source] = 0;
+		remaining_targets -= (scratch.target_stamps_[source] == stamp);
+
+		/* A cell's distance is final when it is first reached, so the search ends with the last target found. */
+		for (std::size_t queue_front = 0; remaining_targets != 0 && queue_front < scratch.queue_.size(); ++queue_front)
+		{
+			const std::size_t cell = scratch.queue_[queue_front];
+
+			for (int direction = 0; direction < Grid::direction_count; ++direction)
+			{
+				if (!maze.IsOpen(cell, direction))
+				{
+					continue;
+				}
+
+				const std::size_t neighbor = maze.GetOpenNeighbor(cell, direction);
+
+				if (scratch.visit_stamps_[neighbor] != stamp)
+				{
+					scratch.visit_stamps_[neighbor] = stamp;
+					scratch.distances_[neighbor] = scratch.distances_[cell] + 1;
+					scratch.parent_directions_[neighbor] = static_cast<std::uint8_t>(Topology::opposite[direction]);
+					scratch.queue_.push_back(static_cast<std::uint32_t>(neighbor));
+					remaining_targets -= (scratch.target_stamps_[neighbor] == stamp);
+				}
+			}
+		}
+
+		for (std::size_t i = group_begin; i < group_end; ++i)
+		{
+			const std::size_t query = order_[i] & 0xffffffff;
+			const std::uint32_t target = queries[query].target_;
+
+			if (scratch.visit_stamps_[target] != stamp)
+			{
+				results.distances_[query] = PathQueryResults::unreachable;
+				continue;
+			}
+
+			const std::uint32_t distance = scratch.distances_[target];
+			results.distances_[query] = distance;
+
+			if (!with_paths)
+			{
+				continue;
+			}
+
+			/* Walk back from the target and fill the path from its end. */
+			const std::size_t offset = scratch.path_cells_.size();
+			scratch.path_cells_.resize(offset + distance + 1);
+			path_locations_[query] = { static_cast<std::uint32_t>(thread_index), offset };
+
+			std::size_t cell = target;
+
+			for (std::size_t position = offset + distance; position > offset; --position)
+			{
+				scratch.path_cells_[position] = static_cast<std::uint32_t>(cell);
+				cell = maze.GetOpenNeighbor(cell, scratch.parent_directions_[cell]);
+			}
+
+			scratch.path_cells_[offset] = static_cast<std::uint32_t>(cell);
+		}
+	}
+
+public:
+	explicit PathQueries(WorkerPool& pool) :
+		pool_(pool),
+		scratch_(pool_.GetThreadCount())
+	{
+
+	}
+
+	int GetThreadCount() const
+	{
+		return pool_.GetThreadCount();
+	}
+
+	void Run(const Grid& maze, const std::vector<PathQuery>& queries, bool with_paths, PathQueryResults& results)
+	{
+		assert(queries.size() <= std::numeric_limits<std::uint32_t>::max());
+
+		order_.resize(queries.size());
+
+		for (std::size_t query = 0; query < queries.size(); ++query)
+		{
+			assert(queries[query].source_ < maze.GetCellCount());
+			order_[query] = (static_cast<std::uint64_t>(queries[query].source_) << 32) | query;
+		}
+
+		std::sort(order_.begin(), order_.end());
+
+		group_starts_.clear();
+
+		for (std::size_t i = 0; i < order_.size(); ++i)
+		{
+			if (i == 0 || (order_[i] >> 32) != (order_[i - 1] >> 32))
+			{
+				group_starts_.push_back(i);
+			}
+		}
+
+		const std::size_t group_count = group_starts_.size();
+		group_starts_.push_back(order_.size());
+
+		results.distances_.resize(queries.size());
+		path_locations_.resize(with_paths ? queries.size() : 0);
+
+		for (Scratch& scratch : scratch_)
+		{
+			scratch.path_cells_.clear();
+		}
+
+		pool_.ParallelFor(group_count, [&](std::size_t group, int thread_index)
+			{
+				SolveGroup(maze, group, thread_index, queries, with_paths, results);
+			});
+
+		results.path_offsets_.clear();
+		results.path_cells_.clear();
+
+		if (!with_paths)
+		{
+			return;
+		}
+
+		results.path_offsets_.resize(queries.size() + 1);
+		results.path_offsets_[0] = 0;
+
+		for (std::size_t query = 0; query < queries.size(); ++query)
+		{
+			const std::uint32_t distance = results.distances_[query];
+			results.path_offsets_[query + 1] = results.path_offsets_[query] + ((distance == PathQueryResults::unreachable) ? 0 : distance + 1);
+		}
+
+		results.path_cells_.resize(results.path_offsets_.back());
+
+		/* Copy the paths into place in chunks of queries, in parallel as well. */
+		constexpr std::size_t chunk_size = 256;
+
+		pool_.ParallelFor((queries.size() + chunk_size - 1) / chunk_size, [&](std::size_t chunk, int)
+			{
+				for (std::size_t query = chunk * chunk_size; query < std::min((chunk + 1) * chunk_size, queries.size()); ++query)
+				{
+					const std::size_t length = results.path_offsets_[query + 1] - results.path_offsets_[query];
+
+					if (length != 0)
+					{
+						const std::uint32_t* path = scratch_[path_locations_[query].thread_index_].path_cells_.data() + path_locations_[query].offset_;
+						std::copy(path, path + length, results.path_cells_.begin() + results.path_offsets_[query]);
+					}
+				}
+			});
+	}
+};
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef PNG_WRITER_HPP
+#define PNG_WRITER_HPP
+
+#include <zlib.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/* Streaming RGB PNG encoder: rows are filtered and deflated as they arrive, so memory use depends only on the image width. */
+class PngWriter
+{
+private:
+    std::FILE* file_;
+    z_stream stream_;
+    bool stream_initialized_;
+
+    int width_;
+    int height_;
+    int rows_written_;
+
+    std::vector<std::uint8_t> previous_row_;
+    std::vector<std::uint8_t> filtered_row_;
+    std::vector<std::uint8_t> output_buffer_;
+
+    bool WriteChunk(const char* type, const std::uint8_t* data, std::size_t size);
+
+    bool Deflate(int flush);
+
+public:
+    PngWriter();
+
+    ~PngWriter();
+
+    bool Open(const std::string& path, int width, int height);
+
+    bool WriteRow(const std::uint8_t* rgb_row);
+
+    bool Close();
+};
+
+#endif
@@ -0,0 +1,184 @@
+#ifndef RANDOM_BITS_HPP
+#define RANDOM_BITS_HPP
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+/*
+ * Random source for the generators. Small draws (a direction out of at most eight) take only the bits
+ * they need from a buffered 64-bit word, so most steps never call the engine. Bounded integers use
+ * Lemire's multiply-shift, which is unbiased and divides only in the rare rejection case, unlike
+ * engine() % bound. Engines must produce full 32- or 64-bit words.
+ */
+template <typename Engine>
+class RandomBits
+{
+private:
+	static_assert(Engine::min() == 0, "Engine words must start at zero.");
+	static_assert(Engine::max() == std::numeric_limits<std::uint32_t>::max() || Engine::max() == std::numeric_limits<std::uint64_t>::max(),
+		"Engine words must be 32 or 64 bits wide.");
+
+	/* Per 8-bit mask: number of set bits, and the position of its k-th set bit. */
+	struct MaskTable
+	{
+		std::array<std::uint8_t, 256> counts_;
+		std::array<std::array<std::uint8_t, 8>, 256> positions_;
+	};
+
+	static constexpr MaskTable mask_table = []()
+	{
+		MaskTable table = {};
+
+		for (int mask = 0; mask < 256; ++mask)
+		{
+			for (int bit = 0; bit < 8; ++bit)
+			{
+				if ((mask >> bit) & 1)
+				{
+					table.positions_[mask][table.counts_[mask]++] = static_cast<std::uint8_t>(bit);
+				}
+			}
+		}
+
+		return table;
+	}();
+
+	/* Bits needed for a value below bound, for bounds up to 8. */
+	static constexpr std::array<int, 9> small_bound_bits = { 0, 0, 1, 2, 2, 3, 3, 3, 3 };
+
+	Engine engine_;
+	std::uint64_t pool_;
+	int pool_bits_;
+
+	std::uint64_t NextWord()
+	{
+		if constexpr (Engine::max() == std::numeric_limits<std::uint64_t>::max())
+		{
+			return engine_();
+		}
+		else
+		{
+			const std::uint64_t high = engine_();
+			return (high << 32) | engine_();
+		}
+	}
+
+	/* Uniform below a bound of at most 8 by rejection on as few pool bits as possible; powers of two never reject. */
+	std::uint32_t SmallBelow(std::uint32_t bound)
+	{
+		const int bits = small_bound_bits[bound];
+		std::uint32_t value = Bits(bits);
+
+		while (value >= bound)
+		{
+			value = Bits(bits);
+		}
+
+		return value;
+	}
+
+public:
+	explicit RandomBits(std::uint32_t seed) :
+		engine_(seed),
+		pool_(0),
+		pool_bits_(0)
+	{
+
+	}
+
+	/* Also drops the buffered bits, so a seed always gives the same stream. */
+	void Seed(std::uint32_t seed)
+	{
+		engine_.seed(seed);
+		pool_ = 0;
+		pool_bits_ = 0;
+	}
+
+	/* Takes count (at most 32) bits from the pool, refilling it with a fresh word when too few are left. */
+	std::uint32_t Bits(int count)
+	{
+		assert(count >= 0 && count <= 32);
+
+		if (pool_bits_ < count)
+		{
+			pool_ = NextWord();
+			pool_bits_ = 64;
+		}
+
+		const std::uint32_t value = static_cast<std::uint32_t>(pool_ & ((std::uint64_t(1) << count) - 1));
+		pool_ >>= count;
+		pool_bits_ -= count;
+
+		return value;
+	}
+
+	/* Whole words come straight from the engine and leave the pool for small draws. */
+	std::uint32_t Next32()
+	{
+		if constexpr (Engine::max() == std::numeric_limits<std::uint64_t>::max())
+		{
+			return static_cast<std::uint32_t>(engine_() >> 32);
+		}
+		else
+		{
+			return static_cast<std::uint32_t>(engine_());
+		}
+	}
+
+	/* Lemire's nearly divisionless bounded integer: the high half of word * bound, rejecting the few biased low halves. */
+	std::uint32_t Below(std::uint32_t bound)
+	{
+		assert(bound > 0);
+
+		if (bound <= 8)
+		{
+			return SmallBelow(bound);
+		}
+
+		std::uint64_t product = std::uint64_t(Next32()) * bound;
+		std::uint32_t low = static_cast<std::uint32_t>(product);
+
+		if (low < bound)
+		{
+			const std::uint32_t threshold = static_cast<std::uint32_t>(0u - bound) % bound;
+
+			while (low < threshold)
+			{
+				product = std::uint64_t(Next32()) * bound;
+				low = static_cast<std::uint32_t>(product);
+			}
+		}
+
+		return static_cast<std::uint32_t>(product >> 32);
+	}
+
+	/* Position of a uniformly chosen set bit of an 8-bit mask, or -1 when the mask is empty. */
+	int SelectBit(std::uint32_t mask)
+	{
+		assert(mask < 256);
+
+		const std::uint32_t count = mask_table.counts_[mask];
+
+		if (count == 0)
+		{
+			return -1;
+		}
+
+		return mask_table.positions_[mask][SmallBelow(count)];
+	}
+
+	/* Fisher-Yates shuffle with unbiased indices. */
+	template <typename Iterator>
+	void Shuffle(Iterator first, Iterator last)
+	{
+		for (auto size = last - first; size > 1; --size)
+		{
+			std::swap(first[size - 1], first[Below(static_cast<std::uint32_t>(size))]);
+		}
+	}
+};
+
+#endif
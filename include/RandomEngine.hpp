@@ -0,0 +1,54 @@
+#ifndef RANDOM_ENGINE_HPP
+#define RANDOM_ENGINE_HPP
+
+#include <cstdint>
+#include <limits>
+
+/* splitmix64 finalizer: a cheap, well-mixing 64-bit hash. */
+inline std::uint64_t MixBits(std::uint64_t value)
+{
+	value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+	return value ^ (value >> 31);
+}
+
+/*
+ * splitmix64 as a standard random bit generator. Its whole state is one word, so seeding costs nothing,
+ * while seeding std::mt19937 costs more than generating a small maze.
+ */
+class SplitMix64Engine
+{
+private:
+	std::uint64_t state_;
+
+public:
+	using result_type = std::uint64_t;
+
+	explicit SplitMix64Engine(result_type seed = 0) : state_(seed)
+	{
+
+	}
+
+	static constexpr result_type min()
+	{
+		return std::numeric_limits<result_type>::min();
+	}
+
+	static constexpr result_type max()
+	{
+		return std::numeric_limits<result_type>::max();
+	}
+
+	void seed(result_type seed)
+	{
+		state_ = seed;
+	}
+
+	result_type operator()()
+	{
+		state_ += 0x9e3779b97f4a7c15ULL;
+		return MixBits(state_);
+	}
+};
+
+#endif
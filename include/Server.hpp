@@ -0,0 +1,102 @@
+#ifndef SERVER_HPP
+#define SERVER_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/*
+ * Maze generation server on a Unix domain socket. Clients send fixed-size requests and may pipeline any
+ * number of them; requests are generated concurrently by a pool of warm Maze workers and every response
+ * carries the id of its request, so responses can arrive out of order. All integers are in the native
+ * byte order, since both ends run on the same machine.
+ */
+namespace server
+{
+	constexpr std::uint8_t flag_solve = 1 << 0;
+	constexpr std::uint8_t flag_statistics = 1 << 1;
+
+	/* Largest maze a request may ask for, in cells; every worker keeps a board of the last requested size. */
+	constexpr std::uint64_t max_request_cells = std::uint64_t(1) << 20;
+
+	struct Request
+	{
+		std::uint32_t request_id_;
+		std::uint32_t width_;
+		std::uint32_t height_;
+		std::uint32_t seed_;
+		std::uint8_t algorithm_;
+		std::uint8_t flags_;
+		std::uint16_t reserved_;
+	};
+
+	static_assert(sizeof(Request) == 20, "Requests are sent as raw bytes.");
+
+	enum class Status : std::uint32_t
+	{
+		Ok,
+		InvalidRequest
+	};
+
+	/*
+	 * Followed by walls_size_ bytes of walls packed like Maze::PackWalls, path_size_ bytes of solution (uint32 grid indices
+	 * from the top-left to the bottom-right cell) and statistics_size_ bytes of ResponseStatistics.
+	 */
+	struct ResponseHeader
+	{
+		std::uint32_t request_id_;
+		Status status_;
+		std::uint32_t walls_size_;
+		std::uint32_t path_size_;
+		std::uint32_t statistics_size_;
+	};
+
+	struct ResponseStatistics
+	{
+		std::uint32_t dead_ends_;
+		std::uint32_t junctions_;
+		std::uint32_t corridor_cells_;
+		std::uint32_t turns_;
+		std::uint32_t dead_end_branches_;
+		std::uint32_t dead_end_branch_cells_;
+		std::uint32_t diameter_;
+		std::uint32_t solution_length_;
+	};
+
+	/* Lock-free latency histogram: buckets cover powers of two microseconds, each split into eight linear sub-buckets. */
+	class LatencyHistogram
+	{
+	private:
+		static constexpr int sub_bucket_bits = 3;
+		static constexpr int bucket_count = 64 << sub_bucket_bits;
+
+		std::array<std::atomic<std::uint64_t>, bucket_count> buckets_;
+		std::atomic<std::uint64_t> count_;
+		std::atomic<std::uint64_t> max_;
+
+		static int GetBucket(std::uint64_t microseconds);
+
+		static std::uint64_t GetBucketLimit(int bucket);
+
+	public:
+		LatencyHistogram();
+
+		void Record(std::uint64_t microseconds);
+
+		std::uint64_t GetCount() const;
+
+		std::uint64_t GetMax() const;
+
+		/* Upper bound of the bucket holding the given percentile, in microseconds. */
+		std::uint64_t GetPercentile(double percentile) const;
+	};
+
+	/* Serves until SIGINT or SIGTERM, then finishes queued requests and prints the latency summary. */
+	int Serve(const std::string& socket_path, int worker_count);
+
+	/* Sends request_count identical requests (with consecutive seeds) keeping up to pipeline_depth in flight, and reports latencies. */
+	int Benchmark(const std::string& socket_path, const Request& request, std::size_t request_count, std::size_t pipeline_depth);
+} // namespace server
+
+#endif
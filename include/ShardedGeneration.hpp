@@ -0,0 +1,53 @@
+#ifndef SHARDED_GENERATION_HPP
+#define SHARDED_GENERATION_HPP
+
+#include "GenerationAlgorithm.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * One perfect maze too large to generate quickly in a single process. The grid is cut into tiles, every
+ * tile is generated as a perfect maze of its own by one of several forked worker processes, which write
+ * their tiles into memory shared with the coordinating process. The coordinator then joins the tiles:
+ * Kruskal's algorithm over the graph of neighboring tiles, with random edge weights, picks a spanning
+ * tree, and exactly one wall on the seam of every spanning edge is opened. A spanning tree of perfect
+ * tiles joined by single passages is a perfect maze again. POSIX only (fork and shared mappings).
+ */
+namespace sharding
+{
+	struct Options
+	{
+		int width_;
+		int height_;
+		int tile_width_;
+		int tile_height_;
+		GenerationAlgorithm algorithm_;
+		std::uint32_t seed_;
+		int process_count_;
+	};
+
+	struct Report
+	{
+		std::size_t tile_count_;
+		std::size_t seam_count_;
+
+		/* Never more worker processes than tiles are started. */
+		int process_count_;
+		double generation_seconds_;
+		double assembly_seconds_;
+		double stitching_seconds_;
+	};
+
+	/* Walls of the whole maze in the Maze::PackWalls layout. Fails when a worker process could not be started or did not finish. */
+	bool Generate(const Options& options, std::vector<std::uint8_t>& walls, Report& report);
+
+	/*
+	 * Whether walls in the Maze::PackWalls layout form a perfect maze (connected, no loops, no passages out of the grid).
+	 * Checked one row at a time with union-find over the cells of two rows, so memory depends only on the width.
+	 */
+	bool IsPerfect(int width, int height, const std::vector<std::uint8_t>& walls);
+} // namespace sharding
+
+#endif
@@ -0,0 +1,111 @@
+#ifndef SOFTWARE_RASTERIZER_HPP
+#define SOFTWARE_RASTERIZER_HPP
+
+#include "WorkerPool.hpp"
+
+#include <SDL2/SDL.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/*
+ * Draws mazes whose cells are only a few pixels on screen straight into a streaming texture, without a
+ * renderer call per cell. Walls are kept as bit planes, one bit per cell in rows of 64-bit words, and every
+ * cell is drawn as a one pixel wall line along its left and top edge followed by a run of floor pixels.
+ * The view is split into bands of rows that are rasterized in parallel into the locked texture; a band is
+ * redrawn and uploaded only when the view moved or a row of cells it shows has changed.
+ */
+class SoftwareRasterizer
+{
+public:
+	/* Bits of the cells of one row: left wall closed, top wall closed and outside of the maze (masked out). */
+	struct RowWalls
+	{
+		std::uint64_t* left_;
+		std::uint64_t* top_;
+		std::uint64_t* outside_;
+	};
+
+	/* Fills the bits of one row of cells, whose words come zeroed. Called from several threads at once. */
+	using RowSource = std::function<void(int row, const RowWalls& walls)>;
+
+	/* Top left corner of the view in world pixels, world pixels per cell and screen pixels per world pixel. */
+	struct View
+	{
+		double x_;
+		double y_;
+		double zoom_;
+		int cell_size_;
+	};
+
+private:
+	static constexpr int band_height = 16;
+
+	WorkerPool& pool_;
+	SDL_Texture* texture_;
+	int view_width_;
+	int view_height_;
+
+	int cells_width_;
+	int cells_height_;
+	std::size_t words_per_row_;
+
+	/* Left and top planes also have the outside bit set, so a masked out cell is drawn as solid wall. */
+	std::vector<std::uint64_t> left_bits_;
+	std::vector<std::uint64_t> top_bits_;
+	std::vector<std::uint64_t> outside_bits_;
+
+	View view_;
+	bool view_valid_;
+	std::vector<std::uint8_t> dirty_bands_;
+
+	/* Pixels of one visible cell in a screen row; edge_ is false when its wall column is left of the view. */
+	struct ColumnRun
+	{
+		int start_;
+		int end_;
+		bool edge_;
+	};
+
+	/* Screen mapping of the current view. A pixel belongs to the cell its centre falls in. */
+	int first_column_cell_;
+	std::vector<ColumnRun> column_runs_;
+	std::vector<int> row_cells_;
+	std::vector<std::uint8_t> row_edges_;
+
+	/* Colours of the wall pixel and of the rest of the run of every visible cell, per thread. */
+	std::vector<std::vector<std::uint32_t>> thread_edge_colours_;
+	std::vector<std::vector<std::uint32_t>> thread_run_colours_;
+
+	void BuildViewMapping();
+
+	void RasterizeRow(int screen_row, std::uint32_t* pixels, int thread_index);
+
+	void RasterizeBands(int first_band, int last_band);
+
+public:
+	explicit SoftwareRasterizer(WorkerPool& pool);
+
+	~SoftwareRasterizer();
+
+	SoftwareRasterizer(const SoftwareRasterizer&) = delete;
+
+	SoftwareRasterizer& operator=(const SoftwareRasterizer&) = delete;
+
+	bool Initialize(SDL_Renderer* renderer, int view_width, int view_height);
+
+	void Finalize();
+
+	/* Clears the planes for a board of this size when it differs from the current one; true when every row has to be updated. */
+	bool Resize(int cells_width, int cells_height);
+
+	/* Reloads the walls of rows first_row to last_row of cells and marks the bands showing them dirty. */
+	void UpdateRows(int first_row, int last_row, const RowSource& source);
+
+	/* Redraws the dirty bands into the texture and copies it to the whole view. */
+	void Render(SDL_Renderer* renderer, const View& view);
+};
+
+#endif
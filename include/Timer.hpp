@@ -0,0 +1,27 @@
+#ifndef TIMER_HPP
+#define TIMER_HPP
+
+#include <chrono>
+
+class Timer
+{
+private:
+    using clock = std::chrono::high_resolution_clock;
+    using second = std::chrono::duration<double, std::ratio<1>>;
+
+    std::chrono::time_point<clock> start;
+public:
+    Timer() : start(clock::now()) {}
+
+    void reset()
+	{
+        start = clock::now();
+    }
+
+    double elapsed() const
+	{
+        return std::chrono::duration_cast<second>(clock::now() - start).count();
+    }
+};
+
+#endif
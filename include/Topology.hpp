@@ -0,0 +1,103 @@
+#ifndef TOPOLOGY_HPP
+#define TOPOLOGY_HPP
+
+#include <array>
+
+struct GridDimensions
+{
+	int width_;
+	int height_;
+	int depth_;
+};
+
+/*
+ * Topology policies for GridMaze. Each one describes, entirely at compile time, how many
+ * directions a cell has, which direction leads back, and the coordinate offset of every direction.
+ * Offsets may depend on the parity of the cell's coordinates, but never on runtime state; uniform_offsets
+ * tells whether they are the same for every cell.
+ */
+
+/* Four directions in the same order as Maze: left, right, top, bottom. */
+struct SquareTopology
+{
+	static constexpr const char* name = "square";
+	static constexpr int direction_count = 4;
+	static constexpr bool uniform_offsets = true;
+	static constexpr std::array<int, direction_count> opposite = { 1, 0, 3, 2 };
+	static constexpr std::array<int, direction_count> dx = { -1, 1, 0, 0 };
+	static constexpr std::array<int, direction_count> dy = { 0, 0, -1, 1 };
+
+	static constexpr void Offset(int x, int y, int direction, int& offset_x, int& offset_y, int& offset_z)
+	{
+		(void) x;
+		(void) y;
+		offset_x = dx[direction];
+		offset_y = dy[direction];
+		offset_z = 0;
+	}
+};
+
+/* Pointy-top hexagons in "odd-r" offset coordinates: west, east, north-west, north-east, south-west, south-east. */
+struct HexTopology
+{
+	static constexpr const char* name = "hex";
+	static constexpr int direction_count = 6;
+	static constexpr bool uniform_offsets = false;
+	static constexpr std::array<int, direction_count> opposite = { 1, 0, 5, 4, 3, 2 };
+	static constexpr std::array<std::array<int, direction_count>, 2> dx = { { { -1, 1, -1, 0, -1, 0 }, { -1, 1, 0, 1, 0, 1 } } };
+	static constexpr std::array<int, direction_count> dy = { 0, 0, -1, -1, 1, 1 };
+
+	static constexpr void Offset(int x, int y, int direction, int& offset_x, int& offset_y, int& offset_z)
+	{
+		(void) x;
+		offset_x = dx[y & 1][direction];
+		offset_y = dy[direction];
+		offset_z = 0;
+	}
+};
+
+/*
+ * Alternating up- and down-pointing triangles: left, right, and the neighbor across the horizontal edge.
+ * The grid is connected only from a width of 2 on; a single column falls apart into vertical pairs.
+ */
+struct TriangularTopology
+{
+	static constexpr const char* name = "triangle";
+	static constexpr int direction_count = 3;
+	static constexpr bool uniform_offsets = false;
+	static constexpr std::array<int, direction_count> opposite = { 1, 0, 2 };
+	static constexpr std::array<int, direction_count> dx = { -1, 1, 0 };
+
+	/* Triangles with even x + y point up, so their horizontal edge is shared with the row below. */
+	static constexpr std::array<int, 2> vertical_dy = { 1, -1 };
+
+	static constexpr void Offset(int x, int y, int direction, int& offset_x, int& offset_y, int& offset_z)
+	{
+		offset_x = dx[direction];
+		offset_y = (direction == 2) ? vertical_dy[(x + y) & 1] : 0;
+		offset_z = 0;
+	}
+};
+
+/* Stacked square levels: left, right, top, bottom, level below, level above. */
+struct LayeredTopology
+{
+	static constexpr const char* name = "layered";
+	static constexpr int direction_count = 6;
+	static constexpr bool uniform_offsets = true;
+	static constexpr std::array<int, direction_count> opposite = { 1, 0, 3, 2, 5, 4 };
+	static constexpr std::array<int, direction_count> dx = { -1, 1, 0, 0, 0, 0 };
+	static constexpr std::array<int, direction_count> dy = { 0, 0, -1, 1, 0, 0 };
+	static constexpr std::array<int, direction_count> dz = { 0, 0, 0, 0, -1, 1 };
+
+	static constexpr void Offset(int x, int y, int direction, int& offset_x, int& offset_y, int& offset_z)
+	{
+		(void) x;
+		(void) y;
+		offset_x = dx[direction];
+		offset_y = dy[direction];
+		offset_z = dz[direction];
+	}
+};
+
+#endif
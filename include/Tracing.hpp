@@ -0,0 +1,54 @@
+#ifndef TRACING_HPP
+#define TRACING_HPP
+
+#include <cstdint>
+
+/*
+ * Timeline of scoped zones and counters in the Chrome trace-event JSON format, to be opened in Perfetto
+ * or chrome://tracing. Everything is compiled out unless MAZE_TRACING is defined (make TRACING=1).
+ * Every thread records into its own fixed ring buffer without locks; buffers are drained into the file
+ * named by MAZE_TRACE_FILE (default maze_trace.json) by Flush, when their thread exits and at program exit.
+ * Events that do not fit into a full buffer before the next drain are dropped and counted.
+ */
+namespace tracing
+{
+	/* Zone names must outlive the trace, string literals are best. */
+	class Zone
+	{
+	private:
+		const char* name_;
+		std::uint64_t start_;
+
+	public:
+		explicit Zone(const char* name);
+
+		~Zone();
+
+		Zone(const Zone&) = delete;
+
+		Zone& operator=(const Zone&) = delete;
+	};
+
+	void SetThreadName(const char* name);
+
+	void Counter(const char* name, double value);
+
+	/* Drains the buffers of every thread into the trace file. */
+	void Flush();
+} // namespace tracing
+
+#ifdef MAZE_TRACING
+#define MAZE_TRACE_CONCAT_INNER(a, b) a##b
+#define MAZE_TRACE_CONCAT(a, b) MAZE_TRACE_CONCAT_INNER(a, b)
+#define MAZE_TRACE_ZONE(name) const tracing::Zone MAZE_TRACE_CONCAT(maze_trace_zone_, __LINE__)(name)
+#define MAZE_TRACE_THREAD_NAME(name) tracing::SetThreadName(name)
+#define MAZE_TRACE_COUNTER(name, value) tracing::Counter((name), (value))
+#define MAZE_TRACE_FLUSH() tracing::Flush()
+#else
+#define MAZE_TRACE_ZONE(name) ((void)0)
+#define MAZE_TRACE_THREAD_NAME(name) ((void)0)
+#define MAZE_TRACE_COUNTER(name, value) ((void)0)
+#define MAZE_TRACE_FLUSH() ((void)0)
+#endif
+
+#endif
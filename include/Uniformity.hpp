@@ -0,0 +1,70 @@
+#ifndef UNIFORMITY_HPP
+#define UNIFORMITY_HPP
+
+#include "GridMaze.hpp"
+#include "Topology.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Statistical check of how uniformly a generator samples the spanning trees of a small square grid,
+ * for the generators of GridMaze and for those of Maze, which are separate implementations.
+ * Every maze is encoded canonically as packed wall bits and counted in a lock-free hash table; the
+ * counts are then compared with the exact number of spanning trees of the grid.
+ */
+namespace uniformity
+{
+	/* Interior edges of the largest grid whose mazes still fit into one 64-bit key. */
+	constexpr int max_edge_bits = 64;
+
+	/* Fixed-capacity open-addressing table mapping nonzero keys to hit counts; increments from any number of threads, without locks. */
+	class ConcurrentCountTable
+	{
+	private:
+		std::vector<std::atomic<std::uint64_t>> keys_;
+		std::vector<std::atomic<std::uint32_t>> counts_;
+		std::size_t mask_;
+
+	public:
+		explicit ConcurrentCountTable(std::size_t min_capacity);
+
+		/* Returns false only when the table is full. */
+		bool Increment(std::uint64_t key);
+
+		std::size_t GetCapacity() const;
+
+		/* Calls visit(key, count) for every key in the table; only valid once all increments are done. */
+		template <typename Visitor>
+		void ForEach(Visitor visit) const
+		{
+			for (std::size_t slot = 0; slot < keys_.size(); ++slot)
+			{
+				const std::uint64_t key = keys_[slot].load(std::memory_order_relaxed);
+
+				if (key != 0)
+				{
+					visit(key, counts_[slot].load(std::memory_order_relaxed));
+				}
+			}
+		}
+	};
+
+	/* Computed in 64 bits, so sizes far beyond max_edge_bits are rejected instead of wrapping around. Both sizes must be positive. */
+	std::uint64_t GetEdgeBits(int cells_width, int cells_height);
+
+	/* Open right passages in row-major order, followed by open bottom passages, one bit per interior edge. */
+	std::uint64_t EncodeWalls(const GridMaze<SquareTopology>& maze);
+
+	/* The same key from walls in the Maze::PackWalls layout, for the generators of the interactive maze. */
+	std::uint64_t EncodePackedWalls(int cells_width, int cells_height, const std::vector<std::uint8_t>& walls);
+
+	/* Exact for the grids this harness handles, by Kirchhoff's matrix-tree theorem. */
+	double CountSpanningTrees(int cells_width, int cells_height);
+
+	/* Upper tail probability of a chi-squared variable, via the Wilson-Hilferty normal approximation (fine for large degrees of freedom). */
+	double ChiSquaredPValue(double chi_squared, double degrees_of_freedom);
+} // namespace uniformity
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef WORKER_POOL_HPP
+#define WORKER_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * Fixed set of threads that stay parked between calls, for work that is issued in bursts (every
+ * simulation tick, say) where starting threads each time would cost more than the work itself. The
+ * calling thread takes part as thread 0; tasks are handed out one at a time from a shared counter.
+ * One pool is meant to be shared by every component of a process, so the threads never outnumber the
+ * cores; calls from several threads at once are run one after the other.
+ */
+class WorkerPool
+{
+public:
+	using Task = std::function<void(std::size_t task, int thread_index)>;
+
+private:
+	std::mutex call_mutex_;
+	std::mutex mutex_;
+	std::condition_variable work_ready_;
+	std::condition_variable work_done_;
+	const Task* task_;
+	std::size_t task_count_;
+	std::atomic<std::size_t> next_task_;
+	std::uint64_t generation_;
+	int busy_threads_;
+	bool stopping_;
+	std::vector<std::thread> threads_;
+
+	void Run(int thread_index);
+
+	void RunTasks(int thread_index);
+
+public:
+	/* thread_count includes the calling thread, so 1 runs everything inline. */
+	explicit WorkerPool(int thread_count);
+
+	~WorkerPool();
+
+	WorkerPool(const WorkerPool&) = delete;
+
+	WorkerPool& operator=(const WorkerPool&) = delete;
+
+	int GetThreadCount() const;
+
+	/* Calls task(i, thread_index) for every i below task_count and returns once all of them are done. */
+	void ParallelFor(std::size_t task_count, const Task& task);
+};
+
+#endif
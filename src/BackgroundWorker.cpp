@@ -0,0 +1,101 @@
+#include "BackgroundWorker.hpp"
+#include "Tracing.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+BackgroundWorker::BackgroundWorker() :
+	running_(false),
+	completed_(false),
+	stopping_(false),
+	cancelled_(false)
+{
+	thread_ = std::thread(&BackgroundWorker::Run, this);
+}
+
+BackgroundWorker::~BackgroundWorker()
+{
+	{
+		const std::lock_guard<std::mutex> lock(mutex_);
+		pending_job_ = nullptr;
+		stopping_ = true;
+		cancelled_ = true;
+	}
+
+	state_changed_.notify_all();
+	thread_.join();
+}
+
+void BackgroundWorker::Run()
+{
+	MAZE_TRACE_THREAD_NAME("background worker");
+	std::unique_lock<std::mutex> lock(mutex_);
+
+	while (true)
+	{
+		state_changed_.wait(lock, [this]() { return stopping_ || pending_job_ != nullptr; });
+
+		if (stopping_)
+		{
+			return;
+		}
+
+		Job job = std::move(pending_job_);
+		pending_job_ = nullptr;
+		running_ = true;
+		cancelled_ = false;
+		lock.unlock();
+
+		{
+			MAZE_TRACE_ZONE("background job");
+			job(cancelled_);
+		}
+
+		/* Destroy the job's captures before the owner may reuse what they refer to. */
+		job = nullptr;
+		lock.lock();
+
+		running_ = false;
+		completed_ = !cancelled_ && pending_job_ == nullptr;
+		state_changed_.notify_all();
+	}
+}
+
+void BackgroundWorker::Submit(Job job)
+{
+	{
+		const std::lock_guard<std::mutex> lock(mutex_);
+		pending_job_ = std::move(job);
+		completed_ = false;
+		cancelled_ = true;
+	}
+
+	state_changed_.notify_all();
+}
+
+void BackgroundWorker::Cancel()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	pending_job_ = nullptr;
+	completed_ = false;
+	cancelled_ = true;
+
+	state_changed_.wait(lock, [this]() { return !running_; });
+}
+
+bool BackgroundWorker::IsBusy()
+{
+	const std::lock_guard<std::mutex> lock(mutex_);
+	return running_ || pending_job_ != nullptr;
+}
+
+bool BackgroundWorker::TakeCompleted()
+{
+	const std::lock_guard<std::mutex> lock(mutex_);
+	const bool completed = completed_;
+	completed_ = false;
+
+	return completed;
+}
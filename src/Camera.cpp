@@ -0,0 +1,126 @@
+#include "Camera.hpp"
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <cmath>
+
+Camera::Camera(int view_width, int view_height) : 
+	x_(0.0), 
+	y_(0.0), 
+	zoom_(1.0), 
+	view_width_(view_width), 
+	view_height_(view_height), 
+	dragging_(false), 
+	drag_origin_({ 0, 0 })
+{
+}
+
+bool Camera::HandleEvent(SDL_Event* e)
+{
+	if (e->type == SDL_MOUSEWHEEL)
+	{
+		int mouse_x = 0;
+		int mouse_y = 0;
+		SDL_GetMouseState(&mouse_x, &mouse_y);
+
+		constexpr double zoom_step = 1.25;
+		ZoomAt(e->wheel.y > 0 ? zoom_step : 1.0 / zoom_step, mouse_x, mouse_y);
+		return true;
+	}
+
+	if (e->type == SDL_MOUSEBUTTONDOWN && e->button.button == SDL_BUTTON_MIDDLE)
+	{
+		dragging_ = true;
+		drag_origin_ = { e->button.x, e->button.y };
+		return true;
+	}
+
+	if (e->type == SDL_MOUSEBUTTONUP && e->button.button == SDL_BUTTON_MIDDLE)
+	{
+		dragging_ = false;
+		return true;
+	}
+
+	if (e->type == SDL_MOUSEMOTION && dragging_)
+	{
+		Pan(e->motion.x - drag_origin_.x, e->motion.y - drag_origin_.y);
+		drag_origin_ = { e->motion.x, e->motion.y };
+		return true;
+	}
+
+	return false;
+}
+
+void Camera::Fit(int world_width, int world_height)
+{
+	zoom_ = std::min(static_cast<double>(view_width_) / world_width, static_cast<double>(view_height_) / world_height);
+	x_ = (world_width - view_width_ / zoom_) / 2.0;
+	y_ = (world_height - view_height_ / zoom_) / 2.0;
+}
+
+void Camera::ZoomAt(double factor, int screen_x, int screen_y)
+{
+	constexpr double min_zoom = 1.0 / 4096.0;
+	constexpr double max_zoom = 64.0;
+
+	/* Keep the world point under the cursor fixed while zooming. */
+	const double world_x = ScreenToWorldX(screen_x);
+	const double world_y = ScreenToWorldY(screen_y);
+
+	zoom_ = std::clamp(zoom_ * factor, min_zoom, max_zoom);
+	x_ = world_x - screen_x / zoom_;
+	y_ = world_y - screen_y / zoom_;
+}
+
+void Camera::Pan(int screen_dx, int screen_dy)
+{
+	x_ -= screen_dx / zoom_;
+	y_ -= screen_dy / zoom_;
+}
+
+double Camera::GetZoom() const
+{
+	return zoom_;
+}
+
+int Camera::GetViewWidth() const
+{
+	return view_width_;
+}
+
+int Camera::GetViewHeight() const
+{
+	return view_height_;
+}
+
+double Camera::ScreenToWorldX(int screen_x) const
+{
+	return x_ + screen_x / zoom_;
+}
+
+double Camera::ScreenToWorldY(int screen_y) const
+{
+	return y_ + screen_y / zoom_;
+}
+
+int Camera::WorldToScreenX(double world_x) const
+{
+	return static_cast<int>(std::floor((world_x - x_) * zoom_));
+}
+
+int Camera::WorldToScreenY(double world_y) const
+{
+	return static_cast<int>(std::floor((world_y - y_) * zoom_));
+}
+
+SDL_Rect Camera::WorldToScreen(const SDL_Rect& world_rect) const
+{
+	/* Converting both edges, rather than position and size, keeps adjacent rects free of gaps. */
+	const int left = WorldToScreenX(world_rect.x);
+	const int top = WorldToScreenY(world_rect.y);
+	const int right = WorldToScreenX(world_rect.x + world_rect.w);
+	const int bottom = WorldToScreenY(world_rect.y + world_rect.h);
+
+	return { left, top, right - left, bottom - top };
+}
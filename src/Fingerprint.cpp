@@ -0,0 +1,106 @@
+#include "Fingerprint.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace fingerprint
+{
+	ShardedFingerprintSet::ShardedFingerprintSet() : 
+		shards_(std::size_t(1) << shard_bits)
+	{
+
+	}
+
+	void ShardedFingerprintSet::InsertSlot(std::vector<std::pair<std::uint64_t, std::uint32_t>>& slots, std::uint64_t fingerprint, std::uint32_t seed, bool& inserted)
+	{
+		const std::size_t mask = slots.size() - 1;
+
+		/* The shard is picked by the top bits, so probing starts from the low ones. */
+		for (std::size_t slot = fingerprint & mask; ; slot = (slot + 1) & mask)
+		{
+			if (slots[slot].first == 0)
+			{
+				slots[slot] = { fingerprint, seed };
+				inserted = true;
+				return;
+			}
+
+			if (slots[slot].first == fingerprint)
+			{
+				slots[slot].second = std::min(slots[slot].second, seed);
+				inserted = false;
+				return;
+			}
+		}
+	}
+
+	bool ShardedFingerprintSet::Insert(std::uint64_t fingerprint, std::uint32_t seed)
+	{
+		/* 0 marks empty slots. */
+		fingerprint = std::max<std::uint64_t>(fingerprint, 1);
+
+		Shard& shard = shards_[fingerprint >> (64 - shard_bits)];
+		const std::lock_guard<std::mutex> lock(shard.mutex_);
+
+		/* Keep the load factor at or below one half. */
+		if (2 * (shard.size_ + 1) > shard.slots_.size())
+		{
+			std::vector<std::pair<std::uint64_t, std::uint32_t>> slots(std::max<std::size_t>(64, 2 * shard.slots_.size()), { 0, 0 });
+			bool moved = false;
+
+			for (const auto& [slot_fingerprint, slot_seed] : shard.slots_)
+			{
+				if (slot_fingerprint != 0)
+				{
+					InsertSlot(slots, slot_fingerprint, slot_seed, moved);
+				}
+			}
+
+			shard.slots_.swap(slots);
+		}
+
+		bool inserted = false;
+		InsertSlot(shard.slots_, fingerprint, seed, inserted);
+		shard.size_ += inserted;
+
+		return inserted;
+	}
+
+	std::size_t ShardedFingerprintSet::GetSize()
+	{
+		std::size_t size = 0;
+
+		for (Shard& shard : shards_)
+		{
+			const std::lock_guard<std::mutex> lock(shard.mutex_);
+			size += shard.size_;
+		}
+
+		return size;
+	}
+
+	std::vector<std::pair<std::uint32_t, std::uint64_t>> ShardedFingerprintSet::GetEntries()
+	{
+		std::vector<std::pair<std::uint32_t, std::uint64_t>> entries;
+
+		for (Shard& shard : shards_)
+		{
+			const std::lock_guard<std::mutex> lock(shard.mutex_);
+
+			for (const auto& [fingerprint, seed] : shard.slots_)
+			{
+				if (fingerprint != 0)
+				{
+					entries.emplace_back(seed, fingerprint);
+				}
+			}
+		}
+
+		std::sort(entries.begin(), entries.end());
+
+		return entries;
+	}
+} // namespace fingerprint
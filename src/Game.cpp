@@ -1,17 +1,23 @@
 #include "Game.hpp"
 #include "Maze.hpp"
 #include "Constants.hpp"
+#include "Tracing.hpp"
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
+#include <SDL2/SDL_ttf.h>
 
+#include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <memory>
 #include <thread>
 
 Game::Game() : 
 	initialized_(false), 
 	running_(false), 
 	ticks_(0), 
+	worker_pool_(std::max(static_cast<int>(std::thread::hardware_concurrency()), 1)), 
 	maze_(nullptr), 
 	window_(nullptr), 
 	renderer_(nullptr)
@@ -19,6 +25,7 @@ Game::Game() :
 	initialized_ = Initialize();
 
 	maze_ = std::make_unique<Maze>(this);
+	maze_->SetWorkerPool(&worker_pool_);
 }
 
 Game::~Game()
@@ -65,17 +72,31 @@ bool Game::Initialize()
 		return false;
 	}
 
+	if (TTF_Init() < 0)
+	{
+		printf("SDL_ttf could not be initialized! SDL_ttf Error: %s\n", TTF_GetError());
+		return false;
+	}
+
+	/* The window works without the HUD, so a missing font is not fatal. */
+	hud_.Initialize(renderer_);
+
 	return true;
 }
 
 void Game::Finalize()
 {
+	/* The maze holds textures of the renderer and a worker thread, so it goes first. */
+	maze_.reset();
+	hud_.Finalize();
+
 	SDL_DestroyWindow(window_);
 	window_ = nullptr;
 	
 	SDL_DestroyRenderer(renderer_);
 	renderer_ = nullptr;
 
+	TTF_Quit();
 	SDL_Quit();
 	IMG_Quit();
 }
@@ -88,6 +109,7 @@ void Game::Run()
 	}
 
 	running_ = true;
+	MAZE_TRACE_THREAD_NAME("main");
 
 	constexpr double ms = 1.0 / 60.0;
 	std::uint64_t last_time = SDL_GetPerformanceCounter();
@@ -100,29 +122,43 @@ void Game::Run()
 
 	while (running_)
 	{
+		MAZE_TRACE_ZONE("frame");
+
 		const std::uint64_t now = SDL_GetPerformanceCounter();
 		const long double elapsed = static_cast<long double>(now - last_time) / static_cast<long double>(SDL_GetPerformanceFrequency());
 
 		last_time = now;
 		delta += elapsed;
+		hud_.RecordFrame(static_cast<double>(elapsed));
 
-		HandleEvents();
+		{
+			MAZE_TRACE_ZONE("handle events");
+			HandleEvents();
+		}
 
 		while (delta >= ms)
 		{
+			MAZE_TRACE_ZONE("tick");
 			Tick();
 			delta -= ms;
 			++ticks;
 		}
 
 		//printf("%Lf\n", delta / ms);
-		Render();
+		{
+			MAZE_TRACE_ZONE("render");
+			Render();
+		}
+
 		++frames;
 
 		if (SDL_GetTicks() - timer > 1000.0)
 		{
 			timer += 1000.0;
 			//printf("Frames: %d, Ticks: %d\n", frames, ticks);
+			MAZE_TRACE_COUNTER("frames per second", frames);
+			MAZE_TRACE_COUNTER("ticks per second", ticks);
+			MAZE_TRACE_FLUSH();
 			frames = 0;
 			ticks = 0;
 		}
@@ -146,40 +182,64 @@ void Game::HandleEvents()
 			if (e.key.keysym.sym == SDLK_t)
 			{
 				maze_->ResetBoard();
-				Timer timer;
-				std::cout << "Parallel testing has started!" << '\n';
-
-				std::thread t1(&Maze::TestRecursiveBacktracker, Maze());
-				std::thread t2(&Maze::TestHuntAndKill, Maze());
-				std::thread t3(&Maze::TestWilsons, Maze());
-				std::thread t4(&Maze::TestRandomizedKruskals, Maze());
-				std::thread t5(&Maze::TestPrimSimplified, Maze());
-
-				t1.join();
-				t2.join();
-				t3.join();
-				t4.join();
-				t5.join();
-
-				std::cout << "Parallel testing has ended!" << '\n';
-				std::cout << "It took " << timer.elapsed() << " seconds\n";
+
+				test_worker_.Submit([](const std::atomic<bool>& cancelled)
+					{
+						Timer timer;
+						std::cout << "Parallel testing has started!" << '\n';
+
+						Maze mazes[5];
+
+						for (Maze& maze : mazes)
+						{
+							maze.SetCancelFlag(&cancelled);
+						}
+
+						std::thread t1(&Maze::TestRecursiveBacktracker, &mazes[0]);
+						std::thread t2(&Maze::TestHuntAndKill, &mazes[1]);
+						std::thread t3(&Maze::TestWilsons, &mazes[2]);
+						std::thread t4(&Maze::TestRandomizedKruskals, &mazes[3]);
+						std::thread t5(&Maze::TestPrimSimplified, &mazes[4]);
+
+						t1.join();
+						t2.join();
+						t3.join();
+						t4.join();
+						t5.join();
+
+						std::cout << (cancelled ? "Parallel testing was cancelled!" : "Parallel testing has ended!") << '\n';
+						std::cout << "It took " << timer.elapsed() << " seconds\n";
+					});
 			}
 			if (e.key.keysym.sym == SDLK_y)
 			{
 				maze_->ResetBoard();
-				Timer timer;
-				std::cout << "Sequential testing has started!" << '\n';
 
-				std::unique_ptr<Maze> maze_ptr = std::make_unique<Maze>(this);
+				test_worker_.Submit([](const std::atomic<bool>& cancelled)
+					{
+						Timer timer;
+						std::cout << "Sequential testing has started!" << '\n';
 
-				maze_ptr->TestRecursiveBacktracker();
-				maze_ptr->TestHuntAndKill();
-				maze_ptr->TestWilsons();
-				maze_ptr->TestRandomizedKruskals();
-				maze_ptr->TestPrimSimplified();
+						std::unique_ptr<Maze> maze_ptr = std::make_unique<Maze>();
+						maze_ptr->SetCancelFlag(&cancelled);
 
-				std::cout << "Sequential testing has ended!" << '\n';
-				std::cout << "It took " << timer.elapsed() << " seconds\n";
+						maze_ptr->TestRecursiveBacktracker();
+						maze_ptr->TestHuntAndKill();
+						maze_ptr->TestWilsons();
+						maze_ptr->TestRandomizedKruskals();
+						maze_ptr->TestPrimSimplified();
+
+						std::cout << (cancelled ? "Sequential testing was cancelled!" : "Sequential testing has ended!") << '\n';
+						std::cout << "It took " << timer.elapsed() << " seconds\n";
+					});
+			}
+			if (e.key.keysym.sym == SDLK_ESCAPE)
+			{
+				test_worker_.Cancel();
+			}
+			if (e.key.keysym.sym == SDLK_h)
+			{
+				hud_.Toggle();
 			}
 		}
 
@@ -202,5 +262,8 @@ void Game::Render()
 
 	maze_->Render();
 
+	SDL_RenderSetViewport(renderer_, NULL);
+	hud_.Render(renderer_, *maze_);
+
 	SDL_RenderPresent(renderer_);
 }
\ No newline at end of file
@@ -0,0 +1,1095 @@
+#include "Headless.hpp"
+#include "Fingerprint.hpp"
+#include "RandomEngine.hpp"
+#include "Maze.hpp"
+#include "GridMaze.hpp"
+#include "MazeAnalyzer.hpp"
+#include "Timer.hpp"
+#include "MazeArchive.hpp"
+#include "PackedWalls.hpp"
+#include "PathQueries.hpp"
+#include "Topology.hpp"
+#include "Server.hpp"
+#include "ShardedGeneration.hpp"
+#include "Uniformity.hpp"
+#include "WorkerPool.hpp"
+
+#include <cstdio>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	template <typename Topology>
+	int RunGridMaze(GridDimensions dimensions, GenerationAlgorithm algorithm, std::uint32_t seed)
+	{
+		GridMaze<Topology> maze(dimensions);
+
+		Timer timer;
+		maze.Generate(algorithm, seed);
+		const double seconds = timer.elapsed();
+
+		std::vector<std::uint32_t> distances;
+		const bool perfect = maze.IsPerfect(distances);
+		const std::uint32_t diameter = perfect ? maze.GetDiameter(distances) : 0;
+
+		printf("%s %dx%dx%d maze, algorithm %d, seed %u: generated in %f seconds (%.0f cells/s), perfect: %s, diameter: %u\n", 
+			Topology::name, dimensions.width_, dimensions.height_, dimensions.depth_, static_cast<int>(algorithm), seed, 
+			seconds, maze.GetCellCount() / seconds, perfect ? "yes" : "no", diameter);
+
+		return perfect ? 0 : 1;
+	}
+
+	/* Analyzes maze_count mazes with seeds seed, seed + 1, ...; every thread fills its own statistics, which are merged at the end. */
+	MazeStatistics AnalyzeMazes(GridDimensions dimensions, GenerationAlgorithm algorithm, std::uint32_t seed, std::size_t maze_count, WorkerPool& pool)
+	{
+		std::vector<std::unique_ptr<GridMaze<SquareTopology>>> mazes(pool.GetThreadCount());
+		std::vector<MazeAnalyzer<SquareTopology>> analyzers(pool.GetThreadCount());
+		std::vector<MazeStatistics> thread_statistics(pool.GetThreadCount());
+
+		pool.ParallelFor(maze_count, [&](std::size_t i, int thread_index)
+			{
+				std::unique_ptr<GridMaze<SquareTopology>>& maze = mazes[thread_index];
+
+				if (maze == nullptr)
+				{
+					maze = std::make_unique<GridMaze<SquareTopology>>(dimensions);
+				}
+
+				maze->Generate(algorithm, static_cast<std::uint32_t>(seed + i));
+				analyzers[thread_index].Analyze(*maze, thread_statistics[thread_index]);
+			});
+
+		MazeStatistics total;
+
+		for (const MazeStatistics& statistics : thread_statistics)
+		{
+			total.Merge(statistics);
+		}
+
+		return total;
+	}
+
+	/*
+	 * Samples maze_count mazes and counts each distinct one, with GridMaze or, when app_engine is set, with the generators of
+	 * the interactive Maze. Work is handed out in chunks; a GridMaze chunk continues one random stream seeded with seed + chunk,
+	 * so tiny mazes do not pay for reseeding, while every Maze is seeded from its own index. Either way the counts do not
+	 * depend on the thread count.
+	 */
+	bool CountMazes(uniformity::ConcurrentCountTable& table, GridDimensions dimensions, GenerationAlgorithm algorithm, std::uint32_t seed, std::size_t maze_count, WorkerPool& pool, bool app_engine)
+	{
+		constexpr std::size_t chunk_size = 1 << 16;
+		const std::size_t chunk_count = (maze_count + chunk_size - 1) / chunk_size;
+		std::atomic<bool> table_full(false);
+
+		std::vector<std::unique_ptr<GridMaze<SquareTopology>>> mazes(pool.GetThreadCount());
+		std::vector<std::unique_ptr<Maze>> app_mazes(pool.GetThreadCount());
+		std::vector<std::vector<std::uint8_t>> walls(pool.GetThreadCount());
+
+		pool.ParallelFor(chunk_count, [&](std::size_t chunk, int thread_index)
+			{
+				if (table_full.load(std::memory_order_relaxed))
+				{
+					return;
+				}
+
+				std::unique_ptr<GridMaze<SquareTopology>>& maze = mazes[thread_index];
+				std::unique_ptr<Maze>& app_maze = app_mazes[thread_index];
+
+				if (maze == nullptr)
+				{
+					maze = std::make_unique<GridMaze<SquareTopology>>(dimensions);
+				}
+
+				if (app_engine && app_maze == nullptr)
+				{
+					app_maze = std::make_unique<Maze>();
+					app_maze->SetBoardSize(dimensions.width_, dimensions.height_);
+				}
+
+				maze->Seed(static_cast<std::uint32_t>(seed + chunk));
+
+				for (std::size_t i = chunk * chunk_size; i < std::min((chunk + 1) * chunk_size, maze_count); ++i)
+				{
+					std::uint64_t key = 0;
+
+					if (app_engine)
+					{
+						app_maze->GenerateMaze(algorithm, static_cast<std::uint32_t>(MixBits(seed + i)));
+						app_maze->PackWalls(walls[thread_index]);
+						key = uniformity::EncodePackedWalls(dimensions.width_, dimensions.height_, walls[thread_index]);
+					}
+					else
+					{
+						maze->Generate(algorithm);
+						key = uniformity::EncodeWalls(*maze);
+					}
+
+					if (!table.Increment(key))
+					{
+						table_full.store(true, std::memory_order_relaxed);
+						return;
+					}
+				}
+			});
+
+		return !table_full.load();
+	}
+
+	/* Generates maze_count mazes with seeds seed, seed + 1, ... and keeps one seed (the smallest) per distinct fingerprint. */
+	void DeduplicateMazes(fingerprint::ShardedFingerprintSet& unique_mazes, GridDimensions dimensions, GenerationAlgorithm algorithm, std::uint32_t seed, 
+		std::size_t maze_count, bool canonical, WorkerPool& pool)
+	{
+		constexpr std::size_t chunk_size = 256;
+
+		/* Every maze is reseeded so its seed alone regenerates it, which std::mt19937 would make the bottleneck. */
+		std::vector<std::unique_ptr<GridMaze<SquareTopology, SplitMix64Engine>>> mazes(pool.GetThreadCount());
+
+		pool.ParallelFor((maze_count + chunk_size - 1) / chunk_size, [&](std::size_t chunk, int thread_index)
+			{
+				std::unique_ptr<GridMaze<SquareTopology, SplitMix64Engine>>& maze = mazes[thread_index];
+
+				if (maze == nullptr)
+				{
+					maze = std::make_unique<GridMaze<SquareTopology, SplitMix64Engine>>(dimensions);
+				}
+
+				/* SquareTopology directions are ordered like the ones fingerprint expects. */
+				const auto is_open = [&maze](int x, int y, int direction)
+				{
+					return maze->IsOpen(maze->GetCellIndex(x, y, 0), direction);
+				};
+
+				for (std::size_t i = chunk * chunk_size; i < std::min((chunk + 1) * chunk_size, maze_count); ++i)
+				{
+					const std::uint32_t maze_seed = static_cast<std::uint32_t>(seed + i);
+					maze->Generate(algorithm, maze_seed);
+
+					const std::uint64_t maze_fingerprint = canonical ? fingerprint::HashWallsCanonical(dimensions.width_, dimensions.height_, is_open) : 
+						fingerprint::HashWalls(dimensions.width_, dimensions.height_, 0, is_open);
+					unique_mazes.Insert(maze_fingerprint, maze_seed);
+				}
+			});
+	}
+
+	/*
+	 * DeduplicateMazes that also appends every unique maze to an archive, in the same pass. A window of mazes is generated, packed
+	 * and fingerprinted in parallel, then deduplicated in seed order, and its unique walls go to the writer as they are, so no
+	 * maze is generated twice and memory is bounded by the window. The result is the same as DeduplicateMazes'.
+	 */
+	bool DeduplicateAndArchiveMazes(fingerprint::ShardedFingerprintSet& unique_mazes, MazeArchiveWriter& writer, GridDimensions dimensions,
+		GenerationAlgorithm algorithm, std::uint32_t seed, std::size_t maze_count, bool canonical, WorkerPool& pool)
+	{
+		constexpr std::size_t window_bytes = std::size_t(64) << 20;
+		const std::size_t walls_size = packed_walls::GetSize(static_cast<std::size_t>(dimensions.width_) * dimensions.height_);
+		const std::size_t window_size = std::clamp<std::size_t>(window_bytes / walls_size, pool.GetThreadCount(), std::size_t(1) << 16);
+
+		/* Archive ids must increase, so when the seeds wrap past 2^32 - 1 the walk starts at the first wrapped one. */
+		const std::uint64_t last_seed = static_cast<std::uint64_t>(seed) + maze_count - 1;
+		const std::size_t first_index = last_seed > std::numeric_limits<std::uint32_t>::max() ? static_cast<std::size_t>((std::uint64_t(1) << 32) - seed) : 0;
+
+		std::vector<std::unique_ptr<GridMaze<SquareTopology, SplitMix64Engine>>> mazes(pool.GetThreadCount());
+		std::vector<std::vector<std::uint8_t>> window_walls(window_size);
+		std::vector<std::uint64_t> window_fingerprints(window_size);
+		std::vector<std::size_t> kept;
+
+		for (std::size_t window_start = 0; window_start < maze_count; window_start += window_size)
+		{
+			const std::size_t window_count = std::min(window_size, maze_count - window_start);
+
+			const auto get_seed = [&](std::size_t i)
+			{
+				return static_cast<std::uint32_t>(seed + (first_index + window_start + i) % maze_count);
+			};
+
+			pool.ParallelFor(window_count, [&](std::size_t i, int thread_index)
+				{
+					std::unique_ptr<GridMaze<SquareTopology, SplitMix64Engine>>& maze = mazes[thread_index];
+
+					if (maze == nullptr)
+					{
+						maze = std::make_unique<GridMaze<SquareTopology, SplitMix64Engine>>(dimensions);
+					}
+
+					const auto is_open = [&maze](int x, int y, int direction)
+					{
+						return maze->IsOpen(maze->GetCellIndex(x, y, 0), direction);
+					};
+
+					maze->Generate(algorithm, get_seed(i));
+					packed_walls::Pack(*maze, window_walls[i]);
+					window_fingerprints[i] = canonical ? fingerprint::HashWallsCanonical(dimensions.width_, dimensions.height_, is_open) :
+						fingerprint::HashWalls(dimensions.width_, dimensions.height_, 0, is_open);
+				});
+
+			/* Inserting in seed order keeps the first maze of every fingerprint, which is the one with the smallest seed. */
+			kept.clear();
+
+			for (std::size_t i = 0; i < window_count; ++i)
+			{
+				if (unique_mazes.Insert(window_fingerprints[i], get_seed(i)))
+				{
+					kept.push_back(i);
+				}
+			}
+
+			const auto source = [&](std::size_t index, std::vector<std::uint8_t>& walls, int)
+			{
+				walls.swap(window_walls[kept[index]]);
+				return static_cast<std::uint64_t>(get_seed(kept[index]));
+			};
+
+			if (!writer.Append(kept.size(), source))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+} // namespace
+
+namespace headless
+{
+	bool FindOption(int argc, char* argv[], const std::string& name, std::string& value)
+	{
+		for (int i = 1; i + 1 < argc; ++i)
+		{
+			if (name == argv[i])
+			{
+				value = argv[i + 1];
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	bool HasFlag(int argc, char* argv[], const std::string& name)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			if (name == argv[i])
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	GenerationAlgorithm ParseAlgorithm(const std::string& value)
+	{
+		/* Same numbering as the keyboard shortcuts, with 10 for the 0 key. */
+		switch (std::atoi(value.c_str()))
+		{
+		case 1:
+			return GenerationAlgorithm::RecursiveBacktracker;
+		case 2:
+			return GenerationAlgorithm::HuntAndKill;
+		case 3:
+			return GenerationAlgorithm::Wilsons;
+		case 4:
+			return GenerationAlgorithm::RandomizedKruskal;
+		case 5:
+			return GenerationAlgorithm::PrimSimplified;
+		case 6:
+			return GenerationAlgorithm::GrowingTreeNewest;
+		case 7:
+			return GenerationAlgorithm::GrowingTreeOldest;
+		case 8:
+			return GenerationAlgorithm::GrowingTreeRandom;
+		case 9:
+			return GenerationAlgorithm::GrowingTreeMixed;
+		case 10:
+			return GenerationAlgorithm::PrimWeighted;
+		default:
+			return GenerationAlgorithm::None;
+		}
+	}
+
+	int RunExport(int argc, char* argv[])
+	{
+		std::string path;
+		std::string value;
+
+		if (!FindOption(argc, argv, "--export", path))
+		{
+			printf("%s\n", "Usage: output --export <file.png> [--size <W>x<H>] [--algorithm <1-10>] [--seed <n>] [--cell-pixels <n>] [--wall-pixels <n>] [--mask <mask.png>] [--sparsify <fraction>] [--braid <fraction>] [--solve]");
+			return 1;
+		}
+
+		int cells_width = 64;
+		int cells_height = 64;
+
+		if (FindOption(argc, argv, "--size", value) && std::sscanf(value.c_str(), "%dx%d", &cells_width, &cells_height) != 2)
+		{
+			printf("Invalid size %s!\n", value.c_str());
+			return 1;
+		}
+
+		const GenerationAlgorithm algorithm = FindOption(argc, argv, "--algorithm", value) ? ParseAlgorithm(value) : GenerationAlgorithm::RecursiveBacktracker;
+
+		if (algorithm == GenerationAlgorithm::None)
+		{
+			printf("Unknown algorithm %s!\n", value.c_str());
+			return 1;
+		}
+
+		const int cell_pixels = FindOption(argc, argv, "--cell-pixels", value) ? std::atoi(value.c_str()) : 4;
+		const int wall_pixels = FindOption(argc, argv, "--wall-pixels", value) ? std::atoi(value.c_str()) : 1;
+		const bool solve = HasFlag(argc, argv, "--solve");
+
+		WorkerPool pool(std::max(static_cast<int>(std::thread::hardware_concurrency()), 1));
+		const std::unique_ptr<Maze> maze = std::make_unique<Maze>();
+		maze->SetWorkerPool(&pool);
+
+		if (!maze->SetBoardSize(cells_width, cells_height))
+		{
+			printf("Invalid maze size %dx%d!\n", cells_width, cells_height);
+			return 1;
+		}
+
+		if (FindOption(argc, argv, "--mask", value) && !maze->LoadMask(value))
+		{
+			return 1;
+		}
+
+		const std::uint32_t seed = FindOption(argc, argv, "--seed", value) ? static_cast<std::uint32_t>(std::strtoul(value.c_str(), nullptr, 10)) : maze->NextSeed();
+
+		Timer timer;
+		maze->GenerateMaze(algorithm, seed);
+		printf("Generated %dx%d maze (%s Seed: %u) in %f seconds, fingerprint %016llx\n", cells_width, cells_height, maze->GetAlgorithmName(algorithm), seed, 
+			timer.elapsed(), static_cast<unsigned long long>(maze->GetFingerprint(false)));
+
+		/* Set before post-processing so sparsifying never walls off the endpoints; the path is updated after each pass. */
+		if (solve)
+		{
+			maze->SetStartEndCells(0, maze->GetCellCount() - 1);
+		}
+
+		/* Sparsifying first keeps braiding from reconnecting cells that are about to be walled off. */
+		if (FindOption(argc, argv, "--sparsify", value))
+		{
+			timer.reset();
+			maze->SparsifyMaze(std::atof(value.c_str()), seed);
+			printf("Sparsified %s of the dead ends in %f seconds\n", value.c_str(), timer.elapsed());
+		}
+
+		if (FindOption(argc, argv, "--braid", value))
+		{
+			timer.reset();
+			maze->BraidMaze(std::atof(value.c_str()), seed);
+			printf("Braided %s of the dead ends in %f seconds\n", value.c_str(), timer.elapsed());
+		}
+
+		timer.reset();
+
+		if (!maze->ExportPng(path, cell_pixels, wall_pixels, solve))
+		{
+			printf("Export to %s failed!\n", path.c_str());
+			return 1;
+		}
+
+		printf("Exported %s in %f seconds\n", path.c_str(), timer.elapsed());
+
+		return 0;
+	}
+
+	int RunTopology(int argc, char* argv[])
+	{
+		std::string topology;
+		std::string value;
+
+		if (!FindOption(argc, argv, "--topology", topology))
+		{
+			printf("%s\n", "Usage: output --topology <square|hex|triangle|layered> [--size <W>x<H>[x<D>]] [--algorithm <1-10>] [--seed <n>]");
+			return 1;
+		}
+
+		GridDimensions dimensions = { 64, 64, 1 };
+
+		if (FindOption(argc, argv, "--size", value) && std::sscanf(value.c_str(), "%dx%dx%d", &dimensions.width_, &dimensions.height_, &dimensions.depth_) < 2)
+		{
+			printf("Invalid size %s!\n", value.c_str());
+			return 1;
+		}
+
+		if (dimensions.width_ < 1 || dimensions.height_ < 1 || dimensions.depth_ < 1 || static_cast<double>(dimensions.width_) * dimensions.height_ * dimensions.depth_ < 2.0)
+		{
+			printf("Invalid size %s!\n", value.c_str());
+			return 1;
+		}
+
+		/* A single column of triangles only pairs up vertically, so its cells fall apart into disconnected pairs. */
+		if (topology == TriangularTopology::name && dimensions.width_ < 2)
+		{
+			printf("Triangle grids need a width of at least 2, not %d!\n", dimensions.width_);
+			return 1;
+		}
+
+		const GenerationAlgorithm algorithm = FindOption(argc, argv, "--algorithm", value) ? ParseAlgorithm(value) : GenerationAlgorithm::RecursiveBacktracker;
+
+		if (algorithm == GenerationAlgorithm::None)
+		{
+			printf("Unknown algorithm %s!\n", value.c_str());
+			return 1;
+		}
+
+		const std::uint32_t seed = FindOption(argc, argv, "--seed", value) ? static_cast<std::uint32_t>(std::strtoul(value.c_str(), nullptr, 10)) : std::random_device{}();
+
+		/* Dispatch once on the topology; everything below runs on code specialized for it. */
+		if (topology == SquareTopology::name)
+		{
+			return RunGridMaze<SquareTopology>({ dimensions.width_, dimensions.height_, 1 }, algorithm, seed);
+		}
+		else if (topology == HexTopology::name)
+		{
+			return RunGridMaze<HexTopology>({ dimensions.width_, dimensions.height_, 1 }, algorithm, seed);
+		}
+		else if (topology == TriangularTopology::name)
+		{
+			return RunGridMaze<TriangularTopology>({ dimensions.width_, dimensions.height_, 1 }, algorithm, seed);
+		}
+		else if (topology == LayeredTopology::name)
+		{
+			return RunGridMaze<LayeredTopology>(dimensions, algorithm, seed);
+		}
+
+		printf("Unknown topology %s!\n", topology.c_str());
+		return 1;
+	}
+
+	int RunAnalyze(int argc, char* argv[])
+	{
+		std::string value;
+		int cells_width = 64;
+		int cells_height = 64;
+
+		if (FindOption(argc, argv, "--size", value) && std::sscanf(value.c_str(), "%dx%d", &cells_width, &cells_height) != 2)
+		{
+			printf("Invalid size %s!\n", value.c_str());
+			return 1;
+		}
+
+		if (cells_width < 1 || cells_height < 1 || static_cast<double>(cells_width) * cells_height < 2.0)
+		{
+			printf("Invalid size %s!\n", value.c_str());
+			return 1;
+		}
+
+		/* Without --algorithm every generator is compared. */
+		std::vector<GenerationAlgorithm> algorithms = { GenerationAlgorithm::RecursiveBacktracker, GenerationAlgorithm::HuntAndKill, 
+			GenerationAlgorithm::Wilsons, GenerationAlgorithm::RandomizedKruskal, GenerationAlgorithm::PrimSimplified, GenerationAlgorithm::GrowingTreeNewest, 
+			GenerationAlgorithm::GrowingTreeOldest, GenerationAlgorithm::GrowingTreeRandom, GenerationAlgorithm::GrowingTreeMixed, GenerationAlgorithm::PrimWeighted };
+
+		if (FindOption(argc, argv, "--algorithm", value))
+		{
+			algorithms = { ParseAlgorithm(value) };
+
+			if (algorithms.front() == GenerationAlgorithm::None)
+			{
+				printf("Unknown algorithm %s!\n", value.c_str());
+				return 1;
+			}
+		}
+
+		const std::size_t maze_count = FindOption(argc, argv, "--analyze", value) ? std::strtoull(value.c_str(), nullptr, 10) : 0;
+
+		if (maze_count == 0)
+		{
+			printf("%s\n", "Usage: output --analyze <maze count> [--size <W>x<H>] [--algorithm <1-10>] [--seed <n>] [--threads <n>]");
+			return 1;
+		}
+
+		const std::uint32_t seed = FindOption(argc, argv, "--seed", value) ? static_cast<std::uint32_t>(std::strtoul(value.c_str(), nullptr, 10)) : std::random_device{}();
+		const int thread_count = FindOption(argc, argv, "--threads", value) ? std::max(std::atoi(value.c_str()), 1) : std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+		WorkerPool pool(thread_count);
+
+		for (const GenerationAlgorithm algorithm : algorithms)
+		{
+			Timer timer;
+			const MazeStatistics statistics = AnalyzeMazes({ cells_width, cells_height, 1 }, algorithm, seed, maze_count, pool);
+			const double seconds = timer.elapsed();
+
+			printf("Algorithm %d, %zu mazes %dx%d, seeds %u..%u: generated and analyzed in %f seconds (%.0f mazes/s)\n", 
+				static_cast<int>(algorithm), maze_count, cells_width, cells_height, seed, static_cast<std::uint32_t>(seed + maze_count - 1), seconds, maze_count / seconds);
+			statistics.Print();
+		}
+
+		return 0;
+	}
+
+	int RunUniformity(int argc, char* argv[])
+	{
+		std::string value;
+		int cells_width = 4;
+		int cells_height = 4;
+
+		if (FindOption(argc, argv, "--size", value) && std::sscanf(value.c_str(), "%dx%d", &cells_width, &cells_height) != 2)
+		{
+			printf("Invalid size %s!\n", value.c_str());
+			return 1;
+		}
+
+		if (cells_width < 1 || cells_height < 1 || static_cast<std::uint64_t>(cells_width) * static_cast<std::uint64_t>(cells_height) < 2 || 
+			uniformity::GetEdgeBits(cells_width, cells_height) > static_cast<std::uint64_t>(uniformity::max_edge_bits))
+		{
+			printf("Invalid size %s, mazes must have between 2 cells and %d interior walls!\n", value.c_str(), uniformity::max_edge_bits);
+			return 1;
+		}
+
+		std::vector<GenerationAlgorithm> algorithms = { GenerationAlgorithm::RecursiveBacktracker, GenerationAlgorithm::HuntAndKill, 
+			GenerationAlgorithm::Wilsons, GenerationAlgorithm::RandomizedKruskal, GenerationAlgorithm::PrimSimplified, GenerationAlgorithm::GrowingTreeNewest, 
+			GenerationAlgorithm::GrowingTreeOldest, GenerationAlgorithm::GrowingTreeRandom, GenerationAlgorithm::GrowingTreeMixed, GenerationAlgorithm::PrimWeighted };
+
+		if (FindOption(argc, argv, "--algorithm", value))
+		{
+			algorithms = { ParseAlgorithm(value) };
+
+			if (algorithms.front() == GenerationAlgorithm::None)
+			{
+				printf("Unknown algorithm %s!\n", value.c_str());
+				return 1;
+			}
+		}
+
+		const std::size_t maze_count = FindOption(argc, argv, "--uniformity", value) ? std::strtoull(value.c_str(), nullptr, 10) : 0;
+
+		if (maze_count < 2)
+		{
+			printf("%s\n", "Usage: output --uniformity <maze count> [--size <W>x<H>] [--algorithm <1-10>] [--seed <n>] [--threads <n>] [--engine <grid|maze>]");
+			return 1;
+		}
+
+		/* GridMaze and Maze implement the generators separately, so both are checked unless one is picked. */
+		std::vector<bool> engines = { false, true };
+
+		if (FindOption(argc, argv, "--engine", value))
+		{
+			if (value != "grid" && value != "maze")
+			{
+				printf("Unknown engine %s!\n", value.c_str());
+				return 1;
+			}
+
+			engines = { value == "maze" };
+		}
+
+		/* The board of the interactive maze has at least 4x4 cells. */
+		constexpr int min_app_cells = 4;
+
+		if (cells_width < min_app_cells || cells_height < min_app_cells)
+		{
+			if (engines.size() == 1 && engines.front())
+			{
+				printf("The maze engine needs at least %dx%d cells!\n", min_app_cells, min_app_cells);
+				return 1;
+			}
+
+			engines = { false };
+		}
+
+		const std::uint32_t seed = FindOption(argc, argv, "--seed", value) ? static_cast<std::uint32_t>(std::strtoul(value.c_str(), nullptr, 10)) : std::random_device{}();
+		const int thread_count = FindOption(argc, argv, "--threads", value) ? std::max(std::atoi(value.c_str()), 1) : std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+		WorkerPool pool(thread_count);
+
+		const double tree_count = uniformity::CountSpanningTrees(cells_width, cells_height);
+		const double expected = maze_count / tree_count;
+
+		/* Keep the load factor of the table at or below one half. */
+		const std::size_t max_distinct = static_cast<std::size_t>(std::min<double>(tree_count, maze_count));
+
+		for (const bool app_engine : engines)
+		{
+			for (const GenerationAlgorithm algorithm : algorithms)
+			{
+				uniformity::ConcurrentCountTable table(2 * max_distinct);
+
+				Timer timer;
+
+				if (!CountMazes(table, { cells_width, cells_height, 1 }, algorithm, seed, maze_count, pool, app_engine))
+				{
+					printf("Algorithm %d produced more distinct mazes than %dx%d has spanning trees!\n", static_cast<int>(algorithm), cells_width, cells_height);
+					return 1;
+				}
+
+				const double seconds = timer.elapsed();
+
+				double distinct = 0.0;
+				double chi_squared = 0.0;
+				double collisions = 0.0;
+
+				table.ForEach([&](std::uint64_t, std::uint32_t count)
+					{
+						distinct += 1.0;
+						chi_squared += (count - expected) * (count - expected) / expected;
+						collisions += 0.5 * count * (count - 1.0);
+					});
+
+				printf("%s algorithm %d, %zu mazes %dx%d (%.0f spanning trees), seed %u: sampled in %f seconds (%.1f million mazes/min), %.0f distinct\n", 
+					app_engine ? "Maze" : "GridMaze", static_cast<int>(algorithm), maze_count, cells_width, cells_height, tree_count, seed, seconds, maze_count / seconds * 60.0 / 1e6, distinct);
+
+				double p_value = 0.0;
+
+				/* Chi-squared needs about five expected hits per tree; below that, count colliding pairs (birthday test) instead. */
+				if (expected >= 5.0)
+				{
+					chi_squared += (tree_count - distinct) * expected;
+					p_value = uniformity::ChiSquaredPValue(chi_squared, tree_count - 1.0);
+					printf("  chi-squared: %.1f with %.0f degrees of freedom, p = %.6f", chi_squared, tree_count - 1.0, p_value);
+				}
+				else
+				{
+					const double expected_collisions = 0.5 * maze_count * (maze_count - 1.0) / tree_count;
+					p_value = 0.5 * std::erfc((collisions - expected_collisions) / std::sqrt(2.0 * expected_collisions));
+					printf("  colliding pairs: %.0f, expected %.1f for uniform sampling, p = %.6f", collisions, expected_collisions, p_value);
+				}
+
+				printf(" (%s)\n", (p_value < 0.001) ? "not uniform" : "consistent with uniform");
+			}
+		}
+
+		return 0;
+	}
+
+	int RunBatch(int argc, char* argv[])
+	{
+		std::string value;
+		int cells_width = 8;
+		int cells_height = 8;
+
+		if (FindOption(argc, argv, "--size", value) && std::sscanf(value.c_str(), "%dx%d", &cells_width, &cells_height) != 2)
+		{
+			printf("Invalid size %s!\n", value.c_str());
+			return 1;
+		}
+
+		if (cells_width < 1 || cells_height < 1 || static_cast<double>(cells_width) * cells_height < 2.0)
+		{
+			printf("Invalid size %s!\n", value.c_str());
+			return 1;
+		}
+
+		const GenerationAlgorithm algorithm = FindOption(argc, argv, "--algorithm", value) ? ParseAlgorithm(value) : GenerationAlgorithm::RecursiveBacktracker;
+
+		if (algorithm == GenerationAlgorithm::None)
+		{
+			printf("Unknown algorithm %s!\n", value.c_str());
+			return 1;
+		}
+
+		const std::size_t maze_count = FindOption(argc, argv, "--batch", value) ? std::strtoull(value.c_str(), nullptr, 10) : 0;
+
+		if (maze_count == 0)
+		{
+			printf("%s\n", "Usage: output --batch <maze count> [--size <W>x<H>] [--algorithm <1-10>] [--seed <n>] [--threads <n>] [--symmetric] [--list <file>] [--archive <file>]");
+			return 1;
+		}
+
+		const std::uint32_t seed = FindOption(argc, argv, "--seed", value) ? static_cast<std::uint32_t>(std::strtoul(value.c_str(), nullptr, 10)) : std::random_device{}();
+		const int thread_count = FindOption(argc, argv, "--threads", value) ? std::max(std::atoi(value.c_str()), 1) : std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+		WorkerPool pool(thread_count);
+		const bool canonical = HasFlag(argc, argv, "--symmetric");
+
+		std::string archive_path;
+		const bool archive = FindOption(argc, argv, "--archive", archive_path);
+
+		fingerprint::ShardedFingerprintSet unique_mazes;
+		MazeArchiveWriter writer(pool);
+
+		if (archive && !writer.Open(archive_path, cells_width, cells_height, static_cast<std::uint32_t>(algorithm)))
+		{
+			printf("Could not write the archive %s!\n", archive_path.c_str());
+			return 1;
+		}
+
+		Timer timer;
+
+		if (archive)
+		{
+			if (!DeduplicateAndArchiveMazes(unique_mazes, writer, { cells_width, cells_height, 1 }, algorithm, seed, maze_count, canonical, pool) || !writer.Close())
+			{
+				printf("Could not write the archive %s!\n", archive_path.c_str());
+				return 1;
+			}
+		}
+		else
+		{
+			DeduplicateMazes(unique_mazes, { cells_width, cells_height, 1 }, algorithm, seed, maze_count, canonical, pool);
+		}
+
+		const double seconds = timer.elapsed();
+
+		const std::size_t unique_count = unique_mazes.GetSize();
+		printf("Algorithm %d, %zu mazes %dx%d, seeds %u..%u: generated%s in %f seconds (%.0f mazes/s), %zu unique, %zu duplicates%s\n", 
+			static_cast<int>(algorithm), maze_count, cells_width, cells_height, seed, static_cast<std::uint32_t>(seed + maze_count - 1), archive ? ", deduplicated and archived" : " and deduplicated", 
+			seconds, maze_count / seconds, unique_count, maze_count - unique_count, canonical ? " (rotations and reflections count as duplicates)" : "");
+
+		if (FindOption(argc, argv, "--list", value))
+		{
+			std::ofstream list(value);
+
+			if (!list)
+			{
+				printf("Could not open %s!\n", value.c_str());
+				return 1;
+			}
+
+			/* One line per unique maze: the seed that regenerates it and its fingerprint. */
+			char line[64];
+
+			for (const auto& [maze_seed, maze_fingerprint] : unique_mazes.GetEntries())
+			{
+				std::snprintf(line, sizeof(line), "%u %016llx\n", maze_seed, static_cast<unsigned long long>(maze_fingerprint));
+				list << line;
+			}
+
+			printf("Wrote %zu seeds to %s\n", unique_count, value.c_str());
+		}
+
+		if (archive)
+		{
+			printf("Archived %zu mazes to %s: %llu bytes, %.3f bits per cell\n", unique_count, archive_path.c_str(), static_cast<unsigned long long>(writer.GetSize()), 
+				writer.GetSize() * 8.0 / (static_cast<double>(unique_count) * cells_width * cells_height));
+		}
+
+		return 0;
+	}
+
+	int RunArchiveRead(int argc, char* argv[])
+	{
+		std::string path;
+
+		if (!FindOption(argc, argv, "--archive-read", path))
+		{
+			printf("%s\n", "Usage: output --archive-read <file> [--id <n>] [--threads <n>] [--verify]");
+			return 1;
+		}
+
+		std::string value;
+		const int thread_count = FindOption(argc, argv, "--threads", value) ? std::max(std::atoi(value.c_str()), 1) : std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+		WorkerPool pool(thread_count);
+		MazeArchiveReader reader(pool);
+
+		if (!reader.Open(path))
+		{
+			return 1;
+		}
+
+		const int cells_width = reader.GetWidth();
+		const int cells_height = reader.GetHeight();
+
+		if (FindOption(argc, argv, "--id", value))
+		{
+			const std::uint64_t id = std::strtoull(value.c_str(), nullptr, 10);
+			std::vector<std::uint8_t> walls;
+
+			Timer timer;
+
+			if (!reader.ReadMaze(id, walls))
+			{
+				printf("No maze with id %llu in %s!\n", static_cast<unsigned long long>(id), path.c_str());
+				return 1;
+			}
+
+			const double seconds = timer.elapsed();
+
+			printf("%llu %016llx (read in %.3f ms)\n", static_cast<unsigned long long>(id), static_cast<unsigned long long>(packed_walls::Hash(cells_width, cells_height, walls.data())), seconds * 1000.0);
+			return 0;
+		}
+
+		/* Archives written by --batch record their algorithm, so every maze can be checked against its seed. */
+		const std::uint32_t algorithm_number = reader.GetAlgorithm();
+		const bool verify = HasFlag(argc, argv, "--verify");
+
+		if (verify && (algorithm_number == 0 || algorithm_number > static_cast<std::uint32_t>(GenerationAlgorithm::PrimWeighted)))
+		{
+			printf("%s does not record the algorithm of its mazes, nothing to verify against!\n", path.c_str());
+			return 1;
+		}
+
+		const GenerationAlgorithm algorithm = static_cast<GenerationAlgorithm>(algorithm_number);
+		std::vector<std::unique_ptr<GridMaze<SquareTopology, SplitMix64Engine>>> mazes(thread_count);
+		std::vector<std::vector<std::uint8_t>> expected_walls(thread_count);
+		std::atomic<std::size_t> mismatches(0);
+
+		const auto check = [&](std::uint64_t id, const std::vector<std::uint8_t>& walls, int thread_index)
+		{
+			if (!verify)
+			{
+				return;
+			}
+
+			std::unique_ptr<GridMaze<SquareTopology, SplitMix64Engine>>& maze = mazes[thread_index];
+
+			if (maze == nullptr)
+			{
+				maze = std::make_unique<GridMaze<SquareTopology, SplitMix64Engine>>(GridDimensions{ cells_width, cells_height, 1 });
+			}
+
+			maze->Generate(algorithm, static_cast<std::uint32_t>(id));
+			packed_walls::Pack(*maze, expected_walls[thread_index]);
+
+			if (expected_walls[thread_index] != walls)
+			{
+				mismatches.fetch_add(1, std::memory_order_relaxed);
+			}
+		};
+
+		Timer timer;
+		const bool complete = reader.ReadAll(check);
+		const double seconds = timer.elapsed();
+
+		const std::uint64_t maze_count = reader.GetMazeCount();
+		const double file_bytes = static_cast<double>(std::ifstream(path, std::ios::binary | std::ios::ate).tellg());
+
+		printf("%s: %llu mazes %dx%d, algorithm %u, %zu blocks, %.0f bytes (%.3f bits per cell), decoded%s in %f seconds (%.0f mazes/s) on %d threads%s\n", 
+			path.c_str(), static_cast<unsigned long long>(maze_count), cells_width, cells_height, algorithm_number, reader.GetBlockCount(), file_bytes, 
+			file_bytes * 8.0 / (static_cast<double>(maze_count) * cells_width * cells_height), verify ? " and verified" : "", seconds, maze_count / seconds, thread_count, 
+			complete ? "" : ", archive is damaged");
+
+		if (verify)
+		{
+			printf("  %zu of the mazes differ from the ones their seeds generate\n", mismatches.load());
+		}
+
+		return (complete && mismatches.load() == 0) ? 0 : 1;
+	}
+
+	int RunPaths(int argc, char* argv[])
+	{
+		std::string value;
+		int cells_width = 200;
+		int cells_height = 200;
+
+		if (FindOption(argc, argv, "--size", value) && (std::sscanf(value.c_str(), "%dx%d", &cells_width, &cells_height) != 2 || cells_width < 1 || cells_height < 1))
+		{
+			printf("Invalid size %s!\n", value.c_str());
+			return 1;
+		}
+
+		const GenerationAlgorithm algorithm = FindOption(argc, argv, "--algorithm", value) ? ParseAlgorithm(value) : GenerationAlgorithm::RecursiveBacktracker;
+
+		if (algorithm == GenerationAlgorithm::None)
+		{
+			printf("Unknown algorithm %s!\n", value.c_str());
+			return 1;
+		}
+
+		const std::size_t query_count = FindOption(argc, argv, "--paths", value) ? std::strtoull(value.c_str(), nullptr, 10) : 0;
+
+		if (query_count == 0)
+		{
+			printf("%s\n", "Usage: output --paths <query count> [--size <W>x<H>] [--algorithm <1-10>] [--seed <n>] [--threads <n>] [--sources <n>] [--rounds <n>] [--no-paths]");
+			return 1;
+		}
+
+		const std::uint32_t seed = FindOption(argc, argv, "--seed", value) ? static_cast<std::uint32_t>(std::strtoul(value.c_str(), nullptr, 10)) : std::random_device{}();
+		const int thread_count = FindOption(argc, argv, "--threads", value) ? std::max(std::atoi(value.c_str()), 1) : std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+		WorkerPool pool(thread_count);
+		const std::size_t source_count = FindOption(argc, argv, "--sources", value) ? std::max<std::size_t>(std::strtoull(value.c_str(), nullptr, 10), 1) : std::max<std::size_t>(query_count / 16, 1);
+		const int round_count = FindOption(argc, argv, "--rounds", value) ? std::max(std::atoi(value.c_str()), 1) : 10;
+		const bool with_paths = !HasFlag(argc, argv, "--no-paths");
+
+		GridMaze<SquareTopology> maze({ cells_width, cells_height, 1 });
+		maze.Generate(algorithm, seed);
+
+		/* Like agents of a simulation: a few start cells shared by many queries, each heading to its own target. */
+		SplitMix64Engine random_engine(seed);
+		std::vector<std::uint32_t> sources(source_count);
+		std::vector<PathQuery> queries(query_count);
+
+		for (std::uint32_t& source : sources)
+		{
+			source = static_cast<std::uint32_t>(random_engine() % maze.GetCellCount());
+		}
+
+		for (PathQuery& query : queries)
+		{
+			query.source_ = sources[random_engine() % source_count];
+			query.target_ = static_cast<std::uint32_t>(random_engine() % maze.GetCellCount());
+		}
+
+		PathQueries<SquareTopology> path_queries(pool);
+		PathQueryResults results;
+		double best_seconds = 0.0;
+
+		for (int round = 0; round < round_count; ++round)
+		{
+			Timer timer;
+			path_queries.Run(maze, queries, with_paths, results);
+			const double seconds = timer.elapsed();
+
+			best_seconds = (round == 0) ? seconds : std::min(best_seconds, seconds);
+		}
+
+		std::uint64_t distance_sum = 0;
+		std::size_t reached = 0;
+
+		for (const std::uint32_t distance : results.distances_)
+		{
+			if (distance != PathQueryResults::unreachable)
+			{
+				distance_sum += distance;
+				++reached;
+			}
+		}
+
+		printf("%zu queries from %zu sources on a %dx%d maze (algorithm %d, seed %u), %d threads: best of %d rounds %.3f ms (%.0f queries/s)\n", 
+			query_count, source_count, cells_width, cells_height, static_cast<int>(algorithm), seed, path_queries.GetThreadCount(), round_count, best_seconds * 1000.0, query_count / best_seconds);
+		printf("  reached: %zu, mean distance: %.1f, path cells: %zu\n", reached, (reached == 0) ? 0.0 : static_cast<double>(distance_sum) / reached, results.path_cells_.size());
+
+		return 0;
+	}
+
+	int RunServe(int argc, char* argv[])
+	{
+		std::string socket_path;
+
+		if (!FindOption(argc, argv, "--serve", socket_path))
+		{
+			printf("%s\n", "Usage: output --serve <socket path> [--workers <n>]");
+			return 1;
+		}
+
+		std::string value;
+		const int worker_count = FindOption(argc, argv, "--workers", value) ? std::max(std::atoi(value.c_str()), 1) : std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+
+		return server::Serve(socket_path, worker_count);
+	}
+
+	int RunServeBenchmark(int argc, char* argv[])
+	{
+		std::string socket_path;
+
+		if (!FindOption(argc, argv, "--serve-bench", socket_path))
+		{
+			printf("%s\n", "Usage: output --serve-bench <socket path> [--requests <n>] [--pipeline <n>] [--size <W>x<H>] [--algorithm <1-10>] [--seed <n>] [--solve] [--stats]");
+			return 1;
+		}
+
+		std::string value;
+		int cells_width = 32;
+		int cells_height = 32;
+
+		if (FindOption(argc, argv, "--size", value) && (std::sscanf(value.c_str(), "%dx%d", &cells_width, &cells_height) != 2 || cells_width < 1 || cells_height < 1))
+		{
+			printf("Invalid size %s!\n", value.c_str());
+			return 1;
+		}
+
+		const GenerationAlgorithm algorithm = FindOption(argc, argv, "--algorithm", value) ? ParseAlgorithm(value) : GenerationAlgorithm::RecursiveBacktracker;
+
+		if (algorithm == GenerationAlgorithm::None)
+		{
+			printf("Unknown algorithm %s!\n", value.c_str());
+			return 1;
+		}
+
+		server::Request request = {};
+		request.width_ = static_cast<std::uint32_t>(cells_width);
+		request.height_ = static_cast<std::uint32_t>(cells_height);
+		request.seed_ = FindOption(argc, argv, "--seed", value) ? static_cast<std::uint32_t>(std::strtoul(value.c_str(), nullptr, 10)) : std::random_device{}();
+		request.algorithm_ = static_cast<std::uint8_t>(algorithm);
+		request.flags_ = (HasFlag(argc, argv, "--solve") ? server::flag_solve : 0) | (HasFlag(argc, argv, "--stats") ? server::flag_statistics : 0);
+
+		const std::size_t request_count = FindOption(argc, argv, "--requests", value) ? std::strtoull(value.c_str(), nullptr, 10) : 10000;
+		const std::size_t pipeline_depth = FindOption(argc, argv, "--pipeline", value) ? std::max<std::size_t>(std::strtoull(value.c_str(), nullptr, 10), 1) : 16;
+
+		return server::Benchmark(socket_path, request, request_count, pipeline_depth);
+	}
+
+	int RunSharded(int argc, char* argv[])
+	{
+		std::string value;
+		int cells_width = 0;
+		int cells_height = 0;
+
+		if (!FindOption(argc, argv, "--sharded", value) || std::sscanf(value.c_str(), "%dx%d", &cells_width, &cells_height) != 2 || cells_width < 1 || cells_height < 1)
+		{
+			printf("%s\n", "Usage: output --sharded <W>x<H> [--tile-size <w>x<h>] [--algorithm <1-10>] [--seed <n>] [--processes <n>] [--archive <file>]");
+			return 1;
+		}
+
+		sharding::Options options = {};
+		options.width_ = cells_width;
+		options.height_ = cells_height;
+		options.tile_width_ = 1024;
+		options.tile_height_ = 1024;
+
+		if (FindOption(argc, argv, "--tile-size", value) && (std::sscanf(value.c_str(), "%dx%d", &options.tile_width_, &options.tile_height_) != 2 || options.tile_width_ < 1 || options.tile_height_ < 1))
+		{
+			printf("Invalid tile size %s!\n", value.c_str());
+			return 1;
+		}
+
+		options.algorithm_ = FindOption(argc, argv, "--algorithm", value) ? ParseAlgorithm(value) : GenerationAlgorithm::RecursiveBacktracker;
+
+		if (options.algorithm_ == GenerationAlgorithm::None)
+		{
+			printf("Unknown algorithm %s!\n", value.c_str());
+			return 1;
+		}
+
+		options.seed_ = FindOption(argc, argv, "--seed", value) ? static_cast<std::uint32_t>(std::strtoul(value.c_str(), nullptr, 10)) : std::random_device{}();
+		options.process_count_ = FindOption(argc, argv, "--processes", value) ? std::max(std::atoi(value.c_str()), 1) : std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+
+		std::vector<std::uint8_t> walls;
+		sharding::Report report = {};
+
+		if (!sharding::Generate(options, walls, report))
+		{
+			return 1;
+		}
+
+		printf("Algorithm %d, %dx%d cells in %zu tiles of %dx%d, seed %u: generated in %f seconds on %d processes, assembled in %f seconds, %zu seams stitched in %f seconds\n", 
+			static_cast<int>(options.algorithm_), cells_width, cells_height, report.tile_count_, options.tile_width_, options.tile_height_, options.seed_, 
+			report.generation_seconds_, report.process_count_, report.assembly_seconds_, report.seam_count_, report.stitching_seconds_);
+
+		Timer timer;
+		const bool perfect = sharding::IsPerfect(cells_width, cells_height, walls);
+		const double seconds = timer.elapsed();
+
+		printf("  %s (checked in %f seconds), fingerprint %016llx\n", perfect ? "perfect" : "NOT perfect", seconds, static_cast<unsigned long long>(packed_walls::Hash(cells_width, cells_height, walls.data())));
+
+		/* The maze cannot be regenerated from its seed by a single algorithm, so the archive records algorithm 0 and the seed as its id. */
+		if (FindOption(argc, argv, "--archive", value))
+		{
+			if (!perfect)
+			{
+				printf("Not writing the archive %s, the maze is not perfect!\n", value.c_str());
+				return 1;
+			}
+
+			WorkerPool pool(1);
+			MazeArchiveWriter writer(pool);
+
+			const auto source = [&](std::size_t, std::vector<std::uint8_t>& maze_walls, int)
+			{
+				maze_walls = walls;
+				return static_cast<std::uint64_t>(options.seed_);
+			};
+
+			if (!writer.Open(value, cells_width, cells_height, 0) || !writer.Append(1, source) || !writer.Close())
+			{
+				printf("Could not write the archive %s!\n", value.c_str());
+				return 1;
+			}
+
+			printf("Archived to %s: %llu bytes, %.3f bits per cell\n", value.c_str(), static_cast<unsigned long long>(writer.GetSize()), 
+				writer.GetSize() * 8.0 / (static_cast<double>(cells_width) * cells_height));
+		}
+
+		return perfect ? 0 : 1;
+	}
+} // namespace headless
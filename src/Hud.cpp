@@ -0,0 +1,314 @@
+#include "Hud.hpp"
+#include "Maze.hpp"
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+namespace
+{
+	constexpr int font_point_size = 16;
+	constexpr int atlas_width = 512;
+	constexpr int margin = 8;
+	constexpr int padding = 8;
+
+	/* Every recorded frame is one bar of the graph; bars reach the top at graph_max_ms. */
+	constexpr int graph_bar_width = 2;
+	constexpr int graph_height = 64;
+	constexpr double graph_max_ms = 1000.0 / 30.0;
+	constexpr double frame_budget_ms = 1000.0 / 60.0;
+
+	constexpr double refresh_interval_seconds = 0.25;
+
+	/* Tried in order when MAZE_HUD_FONT does not name a font; any monospaced font keeps the columns aligned. */
+	constexpr const char* font_paths[] = {
+		"/usr/share/fonts/truetype/dejavu/DejaVuSansMono.ttf",
+		"/usr/share/fonts/dejavu/DejaVuSansMono.ttf",
+		"/usr/share/fonts/TTF/DejaVuSansMono.ttf",
+		"/usr/share/fonts/truetype/liberation/LiberationMono-Regular.ttf",
+		"/System/Library/Fonts/Menlo.ttc",
+		"C:/Windows/Fonts/consola.ttf"
+	};
+} // namespace
+
+Hud::Hud() :
+	atlas_(nullptr),
+	glyphs_{},
+	line_height_(0),
+	visible_(false),
+	frame_seconds_{},
+	frame_index_(0),
+	frame_count_(0),
+	refresh_seconds_(refresh_interval_seconds),
+	lines_{}
+{
+	graph_rects_.reserve(frame_history);
+}
+
+Hud::~Hud()
+{
+	Finalize();
+}
+
+TTF_Font* Hud::OpenFont(int point_size)
+{
+	const char* const font_path = std::getenv("MAZE_HUD_FONT");
+
+	if (font_path != nullptr)
+	{
+		return TTF_OpenFont(font_path, point_size);
+	}
+
+	for (const char* path : font_paths)
+	{
+		if (TTF_Font* font = TTF_OpenFont(path, point_size))
+		{
+			return font;
+		}
+	}
+
+	return nullptr;
+}
+
+bool Hud::BuildAtlas(SDL_Renderer* renderer, TTF_Font* font)
+{
+	constexpr SDL_Color white = { 0xff, 0xff, 0xff, 0xff };
+
+	line_height_ = TTF_FontHeight(font);
+
+	std::array<SDL_Surface*, last_glyph - first_glyph + 1> surfaces{};
+	SDL_Point position = { 0, 0 };
+
+	/* Lay the glyphs out in rows of the atlas width, each of them as tall as the font. */
+	for (int glyph = first_glyph; glyph <= last_glyph; ++glyph)
+	{
+		Glyph& entry = glyphs_[glyph - first_glyph];
+		int min_x, max_x, min_y, max_y;
+
+		if (TTF_GlyphMetrics(font, static_cast<Uint16>(glyph), &min_x, &max_x, &min_y, &max_y, &entry.advance_) != 0)
+		{
+			continue;
+		}
+
+		SDL_Surface*& surface = surfaces[glyph - first_glyph];
+		surface = TTF_RenderGlyph_Blended(font, static_cast<Uint16>(glyph), white);
+
+		if (surface == nullptr)
+		{
+			continue;
+		}
+
+		if (position.x + surface->w > atlas_width)
+		{
+			position.x = 0;
+			position.y += line_height_;
+		}
+
+		entry.source_ = { position.x, position.y, surface->w, surface->h };
+		position.x += surface->w;
+	}
+
+	SDL_Surface* const atlas_surface = SDL_CreateRGBSurfaceWithFormat(0, atlas_width, position.y + line_height_, 32, SDL_PIXELFORMAT_RGBA32);
+
+	if (atlas_surface != nullptr)
+	{
+		for (std::size_t index = 0; index < surfaces.size(); ++index)
+		{
+			if (surfaces[index] != nullptr)
+			{
+				/* Copy the coverage as it is instead of blending it onto the transparent atlas. */
+				SDL_SetSurfaceBlendMode(surfaces[index], SDL_BLENDMODE_NONE);
+				SDL_BlitSurface(surfaces[index], nullptr, atlas_surface, &glyphs_[index].source_);
+			}
+		}
+
+		atlas_ = SDL_CreateTextureFromSurface(renderer, atlas_surface);
+		SDL_FreeSurface(atlas_surface);
+	}
+
+	for (SDL_Surface* surface : surfaces)
+	{
+		SDL_FreeSurface(surface);
+	}
+
+	if (atlas_ == nullptr)
+	{
+		return false;
+	}
+
+	SDL_SetTextureBlendMode(atlas_, SDL_BLENDMODE_BLEND);
+
+	return true;
+}
+
+bool Hud::Initialize(SDL_Renderer* renderer)
+{
+	TTF_Font* const font = OpenFont(font_point_size);
+
+	if (font == nullptr)
+	{
+		printf("HUD font could not be loaded, set MAZE_HUD_FONT to a TrueType font! SDL_ttf Error: %s\n", TTF_GetError());
+		return false;
+	}
+
+	const bool built = BuildAtlas(renderer, font);
+	TTF_CloseFont(font);
+
+	if (!built)
+	{
+		printf("HUD glyph atlas could not be created! SDL Error: %s\n", SDL_GetError());
+	}
+
+	return built;
+}
+
+void Hud::Finalize()
+{
+	SDL_DestroyTexture(atlas_);
+	atlas_ = nullptr;
+}
+
+void Hud::Toggle()
+{
+	visible_ = !visible_;
+	refresh_seconds_ = refresh_interval_seconds;
+}
+
+void Hud::RecordFrame(double seconds)
+{
+	frame_seconds_[frame_index_] = seconds;
+	frame_index_ = (frame_index_ + 1) % frame_history;
+	frame_count_ = std::min(frame_count_ + 1, frame_history);
+	refresh_seconds_ += seconds;
+}
+
+void Hud::FormatLines(const Maze& maze)
+{
+	double total_seconds = 0.0;
+	double max_seconds = 0.0;
+
+	for (std::size_t i = 0; i < frame_count_; ++i)
+	{
+		total_seconds += frame_seconds_[i];
+		max_seconds = std::max(max_seconds, frame_seconds_[i]);
+	}
+
+	const double mean_seconds = (frame_count_ == 0) ? 0.0 : total_seconds / static_cast<double>(frame_count_);
+	const PerformanceStats& stats = maze.GetPerformanceStats();
+
+	std::snprintf(lines_[0].data(), line_length, "FPS: %.1f", (mean_seconds > 0.0) ? 1.0 / mean_seconds : 0.0);
+	std::snprintf(lines_[1].data(), line_length, "Frame: %.2f ms mean, %.2f ms max", mean_seconds * 1000.0, max_seconds * 1000.0);
+
+	if (stats.algorithm_ == GenerationAlgorithm::None)
+	{
+		std::snprintf(lines_[2].data(), line_length, "Generation: none yet");
+		std::snprintf(lines_[3].data(), line_length, " ");
+	}
+	else
+	{
+		const double cells_per_second = (stats.generation_seconds_ > 0.0) ? static_cast<double>(stats.generated_cells_) / stats.generation_seconds_ : 0.0;
+
+		std::snprintf(lines_[2].data(), line_length, "Generation: %s%s", maze.GetAlgorithmName(stats.algorithm_), maze.IsGenerating() ? " (running)" : "");
+		std::snprintf(lines_[3].data(), line_length, "  %zu cells in %.2f ms, %.2f M cells/s", stats.generated_cells_, stats.generation_seconds_ * 1000.0, cells_per_second / 1'000'000.0);
+	}
+
+	std::snprintf(lines_[4].data(), line_length, "Search: %zu nodes expanded in %.2f ms", stats.search_nodes_expanded_, stats.search_seconds_ * 1000.0);
+
+	if (stats.path_length_ == 0)
+	{
+		std::snprintf(lines_[5].data(), line_length, "Path: none");
+	}
+	else
+	{
+		std::snprintf(lines_[5].data(), line_length, "Path: %zu cells", stats.path_length_);
+	}
+
+	std::snprintf(lines_[6].data(), line_length, "Memory: %.2f MiB", static_cast<double>(maze.GetMemoryFootprint()) / (1024.0 * 1024.0));
+}
+
+void Hud::RenderText(SDL_Renderer* renderer, const char* text, int x, int y) const
+{
+	for (; *text != '\0'; ++text)
+	{
+		const int glyph = static_cast<unsigned char>(*text);
+
+		if (glyph < first_glyph || glyph > last_glyph)
+		{
+			continue;
+		}
+
+		const Glyph& entry = glyphs_[glyph - first_glyph];
+		const SDL_Rect destination = { x, y, entry.source_.w, entry.source_.h };
+
+		SDL_RenderCopy(renderer, atlas_, &entry.source_, &destination);
+		x += entry.advance_;
+	}
+}
+
+void Hud::Render(SDL_Renderer* renderer, const Maze& maze)
+{
+	if (!visible_ || atlas_ == nullptr)
+	{
+		return;
+	}
+
+	if (refresh_seconds_ >= refresh_interval_seconds)
+	{
+		FormatLines(maze);
+		refresh_seconds_ = 0.0;
+	}
+
+	const int graph_width = static_cast<int>(frame_history) * graph_bar_width;
+	const int text_height = static_cast<int>(line_count) * line_height_;
+	const SDL_Rect panel = { margin, margin, graph_width + 2 * padding, text_height + graph_height + 3 * padding };
+
+	SDL_SetRenderDrawColor(renderer, 0x00, 0x00, 0x00, 0xc0);
+	SDL_RenderFillRect(renderer, &panel);
+
+	for (std::size_t line = 0; line < line_count; ++line)
+	{
+		RenderText(renderer, lines_[line].data(), panel.x + padding, panel.y + padding + static_cast<int>(line) * line_height_);
+	}
+
+	/* Oldest frame on the left; bars over the 60 Hz budget are drawn in a second batch, in red. */
+	const int graph_left = panel.x + padding;
+	const int graph_bottom = panel.y + 2 * padding + text_height + graph_height;
+
+	for (int over_budget = 0; over_budget < 2; ++over_budget)
+	{
+		graph_rects_.clear();
+
+		for (std::size_t i = 0; i < frame_count_; ++i)
+		{
+			const std::size_t sample = (frame_index_ + frame_history - frame_count_ + i) % frame_history;
+			const double ms = frame_seconds_[sample] * 1000.0;
+
+			if ((ms > frame_budget_ms) != (over_budget != 0))
+			{
+				continue;
+			}
+
+			const int height = std::max(1, static_cast<int>(std::min(ms / graph_max_ms, 1.0) * graph_height));
+			graph_rects_.push_back({ graph_left + static_cast<int>(frame_history - frame_count_ + i) * graph_bar_width, graph_bottom - height, graph_bar_width, height });
+		}
+
+		if (over_budget != 0)
+		{
+			SDL_SetRenderDrawColor(renderer, 0xe0, 0x40, 0x40, 0xff);
+		}
+		else
+		{
+			SDL_SetRenderDrawColor(renderer, 0x40, 0xc0, 0x60, 0xff);
+		}
+
+		SDL_RenderFillRects(renderer, graph_rects_.data(), static_cast<int>(graph_rects_.size()));
+	}
+
+	const int budget_y = graph_bottom - static_cast<int>(frame_budget_ms / graph_max_ms * graph_height);
+
+	SDL_SetRenderDrawColor(renderer, 0xff, 0xff, 0xff, 0x80);
+	SDL_RenderDrawLine(renderer, graph_left, budget_y, graph_left + graph_width, budget_y);
+}
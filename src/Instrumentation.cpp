@@ -0,0 +1,178 @@
+#include "Instrumentation.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+namespace
+{
+	thread_local std::uint64_t heap_allocations = 0;
+
+	std::mutex& OutputMutex()
+	{
+		static std::mutex output_mutex;
+		return output_mutex;
+	}
+
+	std::FILE* OutputFile()
+	{
+		/* Opened on first use and closed by the runtime at exit. */
+		static std::FILE* const output_file = []()
+		{
+			const char* path = std::getenv("MAZE_STATS_FILE");
+			return std::fopen(path != nullptr ? path : "maze_stats.jsonl", "a");
+		}();
+
+		return output_file;
+	}
+} // namespace
+
+namespace instrumentation
+{
+	RunStats::RunStats() : 
+		run_name_(""), 
+		active_(false), 
+		rng_draws_(0), 
+		neighbor_lookups_(0), 
+		rejected_samples_(0), 
+		stack_high_water_(0), 
+		queue_high_water_(0), 
+		heap_allocations_(0), 
+		phases_(), 
+		phase_count_(0), 
+		current_phase_(nullptr), 
+		phase_start_()
+	{
+	}
+
+	void RunStats::BeginRun(const char* run_name)
+	{
+		*this = RunStats();
+		run_name_ = run_name;
+		active_ = true;
+		heap_allocations_ = HeapAllocations();
+	}
+
+	void RunStats::StartPhase(const char* name)
+	{
+		EndPhase();
+		current_phase_ = name;
+		phase_start_ = clock::now();
+	}
+
+	void RunStats::EndPhase()
+	{
+		if (current_phase_ == nullptr)
+		{
+			return;
+		}
+
+		AddPhaseTime(current_phase_, std::chrono::duration<double>(clock::now() - phase_start_).count());
+		current_phase_ = nullptr;
+	}
+
+	void RunStats::AddPhaseTime(const char* name, double seconds)
+	{
+		std::size_t index = 0;
+
+		while (index < phase_count_ && std::strcmp(phases_[index].name_, name) != 0)
+		{
+			++index;
+		}
+
+		if (index == phase_count_ && phase_count_ < max_phases)
+		{
+			phases_[phase_count_++] = { name, 0.0 };
+		}
+
+		if (index < phase_count_)
+		{
+			phases_[index].seconds_ += seconds;
+		}
+	}
+
+	void RunStats::EndRun(int cells_width, int cells_height, std::uint32_t seed)
+	{
+		if (!active_)
+		{
+			return;
+		}
+
+		EndPhase();
+		active_ = false;
+		heap_allocations_ = HeapAllocations() - heap_allocations_;
+
+		const std::lock_guard<std::mutex> lock(OutputMutex());
+		std::FILE* file = OutputFile();
+
+		if (file == nullptr)
+		{
+			return;
+		}
+
+		std::fprintf(file, "{\"run\":\"%s\",\"cells_width\":%d,\"cells_height\":%d,\"seed\":%u,", run_name_, cells_width, cells_height, seed);
+		std::fprintf(file, "\"rng_draws\":%llu,\"neighbor_lookups\":%llu,\"rejected_samples\":%llu,", 
+			static_cast<unsigned long long>(rng_draws_), static_cast<unsigned long long>(neighbor_lookups_), static_cast<unsigned long long>(rejected_samples_));
+		std::fprintf(file, "\"stack_high_water\":%zu,\"queue_high_water\":%zu,\"heap_allocations\":%llu,\"phases\":{", 
+			stack_high_water_, queue_high_water_, static_cast<unsigned long long>(heap_allocations_));
+
+		for (std::size_t i = 0; i < phase_count_; ++i)
+		{
+			std::fprintf(file, "%s\"%s\":%.9f", i == 0 ? "" : ",", phases_[i].name_, phases_[i].seconds_);
+		}
+
+		std::fprintf(file, "}}\n");
+	}
+
+	ScopedRun::ScopedRun(RunStats*& current, const char* run_name, int cells_width, int cells_height, std::uint32_t seed) : 
+		stats_(), 
+		current_(current), 
+		previous_(current), 
+		cells_width_(cells_width), 
+		cells_height_(cells_height), 
+		seed_(seed)
+	{
+		stats_.BeginRun(run_name);
+		current_ = &stats_;
+	}
+
+	ScopedRun::~ScopedRun()
+	{
+		stats_.EndRun(cells_width_, cells_height_, seed_);
+		current_ = previous_;
+	}
+
+	std::uint64_t HeapAllocations()
+	{
+		return heap_allocations;
+	}
+} // namespace instrumentation
+
+#ifdef MAZE_INSTRUMENTATION
+/* Counting replacements of the global allocation functions; the array and nothrow forms forward to these. */
+void* operator new(std::size_t size)
+{
+	++heap_allocations;
+
+	if (void* pointer = std::malloc(size == 0 ? 1 : size))
+	{
+		return pointer;
+	}
+
+	throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+	std::free(pointer);
+}
+#endif
@@ -1,40 +1,106 @@
 #include "Game.hpp"
 #include "Maze.hpp"
 #include "Constants.hpp"
+#include "PngWriter.hpp"
+#include "Fingerprint.hpp"
+#include "PackedWalls.hpp"
+#include "RandomEngine.hpp"
+#include "SoftwareRasterizer.hpp"
+#include "Tracing.hpp"
+#include "WorkerPool.hpp"
 
 #include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <iostream>
 #include <cmath>
 #include <cassert>
-#include <stack>
 #include <vector>
-#include <deque>
-#include <set>
 #include <random>
 #include <ctime>
+#include <limits>
 #include <string>
 #include <mutex>
+#include <atomic>
+
+namespace
+{
+	/* Steps between two cancellation checks in the long loops of background jobs. */
+	constexpr std::size_t cancel_check_interval = 1024;
+
+	/* From this many cells on the recursive backtracker keeps two bits per cell instead of an 8-byte stack entry. */
+	constexpr std::size_t stackless_backtracker_cells = std::size_t(1) << 20;
+
+	/* Indexed like CellNeighbors: left, right, top, bottom. The opposite direction is direction ^ 1. */
+	CellEdge& GetCellEdge(Cell& cell, int direction)
+	{
+		switch (direction)
+		{
+		case 0:
+			return cell.left_edge_;
+		case 1:
+			return cell.right_edge_;
+		case 2:
+			return cell.top_edge_;
+		default:
+			return cell.bottom_edge_;
+		}
+	}
+
+	int CountPassages(const Cell& cell)
+	{
+		return (cell.left_edge_.destination_cell_ != nullptr) + (cell.right_edge_.destination_cell_ != nullptr) + 
+			(cell.top_edge_.destination_cell_ != nullptr) + (cell.bottom_edge_.destination_cell_ != nullptr);
+	}
+} // namespace
 
 Maze::Maze(Game* game) : 
     game_(game), 
     test_loops_(5'000), 
     shift_pressed_(false), 
 	left_mouse_button_pressed_(false), 
+	right_mouse_button_pressed_(false), 
 	cell_size_(128), 
 	cells_width_(constants::screen_width / cell_size_), 
 	cells_height_(constants::screen_height / cell_size_), 
 	custom_maze_current_cell_(nullptr), 
 	start_cell_(nullptr), 
 	end_cell_(nullptr), 
-	shortest_path_found_(false)
+	shortest_path_found_(false), 
+	path_tree_complete_(false), 
+	connection_stamp_(0), 
+	path_revealed_points_(0), 
+	animate_path_(true), 
+	random_bits_(std::random_device{}()), 
+	seed_(0), 
+	generation_algorithm_(GenerationAlgorithm::None), 
+	animate_generation_(true), 
+	generation_steps_per_tick_(16), 
+	generation_time_budget_us_(4'000.0), 
+	generation_current_cell_(nullptr), 
+	generation_hunt_index_(0), 
+	generation_remaining_(0), 
+	stackless_backtracker_(false), 
+	backtracker_first_index_(0), 
+	braid_fraction_(0.5), 
+	sparsify_fraction_(0.5), 
+	camera_(constants::screen_width, constants::screen_height), 
+	generation_stats_(), 
+	stats_(&generation_stats_), 
+	performance_{ GenerationAlgorithm::None, 0, 0.0, 0, 0.0, 0 }, 
+	lod_dirty_(true), 
+	software_rendering_(true), 
+	raster_first_changed_row_(std::numeric_limits<int>::max()), 
+	raster_last_changed_row_(-1), 
+	background_algorithm_(GenerationAlgorithm::None), 
+	back_maze_footprint_(0), 
+	cancel_flag_(nullptr), 
+	worker_pool_(nullptr)
 {
-    board_.resize(cells_width_ * cells_height_);
-	ResetBoard();
-
-	std::srand(std::time(0));
-	std::rand();
+	BuildBoard();
+	camera_.Fit(cells_width_ * cell_size_, cells_height_ * cell_size_);
 
 	mouse_position_ = { 0, 0 };
 }
@@ -46,38 +112,63 @@ Maze::~Maze()
 
 void Maze::HandleEvent(SDL_Event* e)
 {
+    if (camera_.HandleEvent(e))
+    {
+        return;
+    }
+
+    if (e->type == SDL_DROPFILE)
+    {
+        LoadMask(e->drop.file);
+        SDL_free(e->drop.file);
+        return;
+    }
+
     SDL_GetMouseState(&mouse_position_.x, &mouse_position_.y);
 
-    mouse_position_.x = std::clamp(mouse_position_.x, 0, constants::screen_width - cell_size_);
-    mouse_position_.y = std::clamp(mouse_position_.y, 0, constants::screen_height - cell_size_);
+    /* nullptr when the mouse is over a cell outside of the mask. */
+    Cell* const hovered_cell = GetCellAtScreen(mouse_position_.x, mouse_position_.y);
 
-    const std::size_t index = (mouse_position_.y / cell_size_) * cells_width_ + (mouse_position_.x / cell_size_);
+    /* Carving and path finding reuse the visited flags the running generator depends on, and a background generation replaces the board. */
+    const bool generating = IsGenerating() || background_algorithm_ != GenerationAlgorithm::None;
+    const bool interaction_blocked = generating || hovered_cell == nullptr;
 
-    if (e->type == SDL_MOUSEMOTION)
+    if (e->type == SDL_MOUSEMOTION && !interaction_blocked)
     {
-        if (shift_pressed_ && left_mouse_button_pressed_)
+        if (shift_pressed_ && (left_mouse_button_pressed_ || right_mouse_button_pressed_) && custom_maze_current_cell_ != nullptr)
         {
-            const int neighbor_index = GetNeighborIndex(*custom_maze_current_cell_, board_[index]);
+            const int neighbor_index = GetNeighborIndex(*custom_maze_current_cell_, *hovered_cell);
 
-            if (neighbor_index != -1 && custom_maze_current_cell_ != nullptr && &board_[index] != custom_maze_current_cell_)
+            if (neighbor_index != -1 && hovered_cell != custom_maze_current_cell_)
             {
                 const std::size_t maze_cell_index = GetCellIndex(*custom_maze_current_cell_);
-                const std::vector<Cell*> neighbors = GetNeighborCells(maze_cell_index);
+                const CellNeighbors neighbors = GetNeighborCells(maze_cell_index);
+                const bool connected = GetConnectedNeighborCells(*custom_maze_current_cell_)[neighbor_index] == hovered_cell;
+
+                CancelBackgroundJob();
 
-                SetConnections(custom_maze_current_cell_, neighbors, neighbor_index);
-                
-                if (DetectCycleDepthFirstSearch(&board_[index]))
+                if (left_mouse_button_pressed_ && !connected)
+                {
+                    /* Opening the wall between cells that are already connected would close a loop. */
+                    if (!AreCellsConnected(*custom_maze_current_cell_, *hovered_cell))
+                    {
+                        SetConnections(custom_maze_current_cell_, neighbors, neighbor_index);
+                        UpdatePathAfterCarving(*custom_maze_current_cell_, *hovered_cell, true);
+                    }
+                }
+                else if (!left_mouse_button_pressed_ && connected)
                 {
                     SetConnections(custom_maze_current_cell_, neighbors, neighbor_index, true);
+                    UpdatePathAfterCarving(*custom_maze_current_cell_, *hovered_cell, false);
                 }
-                
-                custom_maze_current_cell_ = &board_[index];
+
+                custom_maze_current_cell_ = hovered_cell;
             }
 
         }
     }
 
-    if (e->type == SDL_MOUSEBUTTONDOWN)
+    if (e->type == SDL_MOUSEBUTTONDOWN && !interaction_blocked)
     {
         if (e->button.button == SDL_BUTTON_LEFT)
         {
@@ -85,37 +176,44 @@ void Maze::HandleEvent(SDL_Event* e)
 
             if (shift_pressed_)
             {
-                custom_maze_current_cell_ = &board_[index];
+                custom_maze_current_cell_ = hovered_cell;
             }
 
-            if (end_cell_ != &board_[index] && !shift_pressed_)
+            if (end_cell_ != hovered_cell && !shift_pressed_)
             {
-                if (start_cell_ != &board_[index])
+                if (start_cell_ != hovered_cell)
                 {
-                    start_cell_ = &board_[index];
-                    shortest_path_found_ = FindShortestPathBetweenStartEnd();
+                    start_cell_ = hovered_cell;
                 }
                 else
                 {
                     start_cell_ = nullptr;
-                    shortest_path_found_ = false;
                 }
+
+                StartBackgroundSolve();
             }
         }
         if (e->button.button == SDL_BUTTON_RIGHT)
         {
-            if (start_cell_ != &board_[index] && !shift_pressed_)
+            right_mouse_button_pressed_ = true;
+
+            if (shift_pressed_ && !left_mouse_button_pressed_)
+            {
+                custom_maze_current_cell_ = hovered_cell;
+            }
+
+            if (start_cell_ != hovered_cell && !shift_pressed_)
             {
-                if (end_cell_ != &board_[index])
+                if (end_cell_ != hovered_cell)
                 {
-                    end_cell_ = &board_[index];
-                    shortest_path_found_ = FindShortestPathBetweenStartEnd();
+                    end_cell_ = hovered_cell;
                 }
                 else
                 {
                     end_cell_ = nullptr;
-                    shortest_path_found_ = false;
                 }
+
+                StartBackgroundSolve();
             }
         }
     }
@@ -126,41 +224,96 @@ void Maze::HandleEvent(SDL_Event* e)
             left_mouse_button_pressed_ = false;
             custom_maze_current_cell_ = nullptr;
         }
+        else if (e->button.button == SDL_BUTTON_RIGHT)
+        {
+            right_mouse_button_pressed_ = false;
+            custom_maze_current_cell_ = nullptr;
+        }
     }
 
     if (e->type == SDL_KEYDOWN)
     {
-        std::string new_title = "";
+        GenerationAlgorithm algorithm = GenerationAlgorithm::None;
 
         if (e->key.keysym.sym == SDLK_1)
         {
-            GenerateMazeRecursiveBacktracker();
-            new_title = std::string(constants::game_title) + " - Recursive backtracker algorithm.";
-            SDL_SetWindowTitle(game_->window_, new_title.c_str());
+            algorithm = GenerationAlgorithm::RecursiveBacktracker;
         }
         else if (e->key.keysym.sym == SDLK_2)
         {
-            GenerateMazeHuntAndKill();
-            new_title = std::string(constants::game_title) + " - Hunt and kill algorithm.";
-            SDL_SetWindowTitle(game_->window_, new_title.c_str());
+            algorithm = GenerationAlgorithm::HuntAndKill;
         }
         else if (e->key.keysym.sym == SDLK_3)
         {
-            GenerateMazeWilsons();
-            new_title = std::string(constants::game_title) + " - Wilson's algorithm.";
-            SDL_SetWindowTitle(game_->window_, new_title.c_str());
+            algorithm = GenerationAlgorithm::Wilsons;
         }
         else if (e->key.keysym.sym == SDLK_4)
         {
-            GenerateMazeRandomizedKruskal();
-            new_title = std::string(constants::game_title) + " - Randomized Kruskal's algorithm.";
-            SDL_SetWindowTitle(game_->window_, new_title.c_str());
+            algorithm = GenerationAlgorithm::RandomizedKruskal;
         }
         else if (e->key.keysym.sym == SDLK_5)
         {
-            GenerateMazePrimSimplified();
-            new_title = std::string(constants::game_title) + " - Prim's simplified algorithm.";
-            SDL_SetWindowTitle(game_->window_, new_title.c_str());
+            algorithm = GenerationAlgorithm::PrimSimplified;
+        }
+        else if (e->key.keysym.sym == SDLK_6)
+        {
+            algorithm = GenerationAlgorithm::GrowingTreeNewest;
+        }
+        else if (e->key.keysym.sym == SDLK_7)
+        {
+            algorithm = GenerationAlgorithm::GrowingTreeOldest;
+        }
+        else if (e->key.keysym.sym == SDLK_8)
+        {
+            algorithm = GenerationAlgorithm::GrowingTreeRandom;
+        }
+        else if (e->key.keysym.sym == SDLK_9)
+        {
+            algorithm = GenerationAlgorithm::GrowingTreeMixed;
+        }
+        else if (e->key.keysym.sym == SDLK_0)
+        {
+            algorithm = GenerationAlgorithm::PrimWeighted;
+        }
+
+        if (algorithm != GenerationAlgorithm::None)
+        {
+            const std::uint32_t seed = NextSeed();
+
+            if (animate_generation_)
+            {
+                BeginGeneration(algorithm, seed);
+                SetWindowTitle(algorithm, seed);
+            }
+            else
+            {
+                /* The current maze stays on screen until the new one is swapped in by Tick(). */
+                StartBackgroundJob(algorithm, [this, algorithm, seed](Maze& back_maze)
+                    {
+                        back_maze.CopyLayout(*this);
+                        back_maze.GenerateMaze(algorithm, seed);
+                    });
+            }
+        }
+        else if (e->key.keysym.sym == SDLK_g)
+        {
+            animate_generation_ = !animate_generation_;
+        }
+        else if (e->key.keysym.sym == SDLK_p)
+        {
+            animate_path_ = !animate_path_;
+        }
+        else if (e->key.keysym.sym == SDLK_v)
+        {
+            software_rendering_ = !software_rendering_;
+        }
+        else if (e->key.keysym.sym == SDLK_EQUALS)
+        {
+            generation_steps_per_tick_ = std::min<std::size_t>(generation_steps_per_tick_ * 2, std::size_t(1) << 24);
+        }
+        else if (e->key.keysym.sym == SDLK_MINUS)
+        {
+            generation_steps_per_tick_ = std::max<std::size_t>(generation_steps_per_tick_ / 2, 1);
         }
         else if (e->key.keysym.sym == SDLK_UP)
         {
@@ -170,22 +323,60 @@ void Maze::HandleEvent(SDL_Event* e)
         {
             SetCellSize(cell_size_ * 2);
         }
-        else if (e->key.keysym.sym == SDLK_a)
+        else if (e->key.keysym.sym == SDLK_PAGEUP)
+        {
+            constexpr int max_interactive_cells = 16'384;
+
+            if (std::max(cells_width_, cells_height_) * 2 <= max_interactive_cells)
+            {
+                SetBoardSize(cells_width_ * 2, cells_height_ * 2);
+            }
+        }
+        else if (e->key.keysym.sym == SDLK_PAGEDOWN)
+        {
+            SetBoardSize(cells_width_ / 2, cells_height_ / 2);
+        }
+        else if (e->key.keysym.sym == SDLK_HOME)
+        {
+            camera_.Fit(cells_width_ * cell_size_, cells_height_ * cell_size_);
+        }
+        else if (e->key.keysym.sym == SDLK_a && !generating)
         {		
-            FindLongestPathInMaze();
+            StartBackgroundJob(GenerationAlgorithm::None, [this](Maze& back_maze)
+                {
+                    back_maze.CopyLayout(*this);
+                    back_maze.CopyWalls(*this);
+                    back_maze.FindLongestPathInMaze();
+                });
+        }
+        else if (e->key.keysym.sym == SDLK_b && !generating)
+        {
+            BraidMaze(braid_fraction_, NextSeed());
+        }
+        else if (e->key.keysym.sym == SDLK_s && !generating)
+        {
+            SparsifyMaze(sparsify_fraction_, NextSeed());
         }
         else if (e->key.keysym.sym == SDLK_r)
         {
             ResetBoard();
         }
+        else if (e->key.keysym.sym == SDLK_m)
+        {
+            ClearMask();
+        }
+        else if (e->key.keysym.sym == SDLK_ESCAPE)
+        {
+            CancelBackgroundJob();
+        }
 
         if (e->key.keysym.sym == SDLK_LSHIFT)
         {
             shift_pressed_ = true;
 
-            if (left_mouse_button_pressed_)
+            if ((left_mouse_button_pressed_ || right_mouse_button_pressed_) && !interaction_blocked)
             {
-                custom_maze_current_cell_ = &board_[index];
+                custom_maze_current_cell_ = hovered_cell;
             }
         }
     }
@@ -201,593 +392,2270 @@ void Maze::HandleEvent(SDL_Event* e)
 
 void Maze::Tick()
 {
+	if (background_worker_ != nullptr && background_worker_->TakeCompleted())
+	{
+		SwapBoards(*back_maze_, background_algorithm_ != GenerationAlgorithm::None);
+		back_maze_footprint_ = back_maze_->GetMemoryFootprint();
 
-}
-
-void Maze::Render()
-{
-    RenderCells();
-}
-
-int Maze::GetRandomNeighborIndex(const std::vector<Cell*>& neighbors, bool unvisited)
-{
-	assert(neighbors.size() == 4);
-
-	const int valid_neighbors_count = std::count_if(neighbors.begin(), neighbors.end(), [unvisited](Cell* neighbor)
+		if (background_algorithm_ != GenerationAlgorithm::None)
 		{
-			return neighbor != nullptr && (!unvisited || !neighbor->visited_);
-		});
+			SetWindowTitle(background_algorithm_, seed_);
+			background_algorithm_ = GenerationAlgorithm::None;
+		}
+	}
 
-	if (valid_neighbors_count == 0)
+	if (shortest_path_found_ && path_revealed_points_ < path_points_.size())
 	{
-		return -1;
-	}
+		/* The reveal takes about a second whatever the length of the path. */
+		constexpr std::size_t reveal_ticks = 60;
 
-	int random_neighbour_index = std::rand() % 4;
+		if (animate_path_)
+		{
+			path_revealed_points_ = std::min(path_points_.size(), path_revealed_points_ + std::max<std::size_t>(1, path_points_.size() / reveal_ticks));
+		}
+		else
+		{
+			path_revealed_points_ = path_points_.size();
+		}
+	}
 
-	while (neighbors[random_neighbour_index] == nullptr || (unvisited && neighbors[random_neighbour_index]->visited_))
+	if (!IsGenerating())
 	{
-		random_neighbour_index = (random_neighbour_index + 1) % 4;
+		return;
 	}
 
-	return random_neighbour_index;
-}
+	/*
+	 * Advance the generator by at most generation_steps_per_tick_ steps, checking the clock after the first step and then
+	 * every few steps. The interval never exceeds the step count, so small step counts are held to the budget too.
+	 */
+	MAZE_TRACE_ZONE("generation steps");
+	const std::size_t clock_check_interval = std::min<std::size_t>(64, generation_steps_per_tick_);
+	const Timer timer;
 
-void Maze::SetConnections(Cell* current_cell, const std::vector<Cell*>& neighbors, std::size_t neighbor_index, bool unset)
-{
-	assert(current_cell != nullptr);
+	bool finished = false;
 
-	switch (neighbor_index)
+	for (std::size_t step = 1; step <= generation_steps_per_tick_; ++step)
+	{
+		if (!StepGeneration())
 		{
-		case 0:
-			current_cell->left_edge_.destination_cell_ = unset ? nullptr : neighbors[neighbor_index];
-			neighbors[neighbor_index]->right_edge_.destination_cell_ = unset ? nullptr : current_cell;
+			finished = true;
 			break;
+		}
 
-		case 1:
-			current_cell->right_edge_.destination_cell_ = unset ? nullptr : neighbors[neighbor_index];
-			neighbors[neighbor_index]->left_edge_.destination_cell_ = unset ? nullptr : current_cell;
-			break;
-		
-		case 2:
-			current_cell->top_edge_.destination_cell_ = unset ? nullptr : neighbors[neighbor_index];
-			neighbors[neighbor_index]->bottom_edge_.destination_cell_ = unset ? nullptr : current_cell;
-			break;
-		
-		case 3:
-			current_cell->bottom_edge_.destination_cell_ = unset ? nullptr : neighbors[neighbor_index];
-			neighbors[neighbor_index]->top_edge_.destination_cell_ = unset ? nullptr : current_cell;
+		if ((step == 1 || step % clock_check_interval == 0) && timer.elapsed() * 1'000'000.0 >= generation_time_budget_us_)
+		{
 			break;
-
-		default:
-			assert(false);
 		}
+	}
+
+	/* Only the time spent stepping counts as carving, not the idle time between ticks. */
+	const double seconds = timer.elapsed();
+	performance_.generation_seconds_ += seconds;
+	MAZE_STATS_PHASE_TIME(&generation_stats_, "carve", seconds);
+
+	if (finished)
+	{
+		MAZE_STATS_END_RUN(&generation_stats_, cells_width_, cells_height_, seed_);
+	}
 }
 
-std::size_t Maze::GetCellIndex(const Cell& cell)
+void Maze::Render()
 {
-	return (cell.rect_.y / cell_size_) * cells_width_ + (cell.rect_.x / cell_size_);
+    RenderCells();
 }
 
-void Maze::GenerateMazeRecursiveBacktracker()
+std::uint32_t Maze::NextSeed()
+{
+	MAZE_STATS_COUNT(stats_, rng_draws_);
+	return random_bits_.Next32();
+}
+
+std::size_t Maze::RandomIndex(std::size_t bound)
+{
+	MAZE_STATS_COUNT(stats_, rng_draws_);
+	return random_bits_.Below(static_cast<std::uint32_t>(bound));
+}
+
+void Maze::BeginGeneration(GenerationAlgorithm algorithm, std::uint32_t seed)
 {
+	MAZE_STATS_BEGIN_RUN(&generation_stats_, GetAlgorithmId(algorithm));
+	MAZE_STATS_PHASE(&generation_stats_, "setup");
+
 	ResetBoard();
 
-	std::stack<Cell*> cell_stack;
-	cell_stack.push(&board_[std::rand() % board_.size()]);
-	cell_stack.top()->visited_ = true;
+	seed_ = seed;
+	random_bits_.Seed(seed_);
 
-	while (!cell_stack.empty())
+	switch (algorithm)
 	{
-		Cell* const stack_top = cell_stack.top();
-		const std::vector<Cell*> neighbors = GetNeighborCells(GetCellIndex(*stack_top));
-		const int random_neighbour_index = GetRandomNeighborIndex(neighbors, true);
+	case GenerationAlgorithm::RecursiveBacktracker:
+		stackless_backtracker_ = board_.size() >= stackless_backtracker_cells;
 
-		if (random_neighbour_index == -1)
+		if (stackless_backtracker_)
 		{
-			cell_stack.pop();
-			continue;
+			backtracker_came_from_.assign((board_.size() + 3) / 4, 0);
+			backtracker_first_index_ = RandomIndex(board_.size());
+			generation_current_cell_ = &board_[backtracker_first_index_];
+			generation_current_cell_->visited_ = true;
+			break;
 		}
 
-		SetConnections(stack_top, neighbors, random_neighbour_index);
-		cell_stack.push(neighbors[random_neighbour_index]);
-		cell_stack.top()->visited_ = true;
-	}
-}
+		generation_cells_.reserve(board_.size());
+		generation_cells_.push_back(&board_[RandomIndex(board_.size())]);
+		generation_cells_.back()->visited_ = true;
+		break;
 
-void Maze::GenerateMazeHuntAndKill()
-{
-	ResetBoard();
+	case GenerationAlgorithm::HuntAndKill:
+		generation_current_cell_ = &board_[RandomIndex(board_.size())];
+		generation_current_cell_->visited_ = true;
+		break;
 
-	Cell* current_cell = &board_[std::rand() % board_.size()];
-	current_cell->visited_ = true;
-	
-	while (true)
+	case GenerationAlgorithm::Wilsons:
 	{
-		std::vector<Cell*> neighbors = GetNeighborCells(GetCellIndex(*current_cell));
-		const int random_neighbour_index = GetRandomNeighborIndex(neighbors, true);
+		Cell* target_cell = &board_[RandomIndex(board_.size())];
+		target_cell->visited_ = true;
+		generation_remaining_ = board_.size() - 1;
+		generation_cells_.reserve(board_.size());
+		break;
+	}
 
-		if (random_neighbour_index == -1)
+	case GenerationAlgorithm::RandomizedKruskal:
+		kruskal_parents_.resize(board_.size());
+		kruskal_set_sizes_.assign(board_.size(), 1);
+
+		for (std::size_t index = 0; index < board_.size(); ++index)
 		{
-			bool found_new_cell = false;
-			bool found_visited_neighbor = false;
+			kruskal_parents_[index] = index;
+		}
 
-			for (Cell& cell : board_)
-			{
-				if (cell.visited_)
-				{
-					continue;
-				}
+		generation_remaining_ = board_.size();
+		break;
 
-				neighbors = GetNeighborCells(GetCellIndex(cell));
-				
-				for (std::size_t index = 0; index < neighbors.size(); ++index)
-				{
-					if (neighbors[index] != nullptr && neighbors[index]->visited_)
-					{
-						SetConnections(&cell, neighbors, index);
-						found_visited_neighbor = true;
-						break;
-					}
-				}
+	case GenerationAlgorithm::PrimSimplified:
+		generation_cells_.reserve(board_.size());
+		generation_cells_.push_back(&board_[RandomIndex(board_.size())]);
+		generation_cells_.back()->visited_ = true;
+		break;
 
-				if (found_visited_neighbor)
-				{
-					current_cell = &cell;
-					current_cell->visited_ = true;
-					found_new_cell = true;
-					break;
-				}
-			}
+	case GenerationAlgorithm::GrowingTreeNewest:
+		BeginGrowingTree<NewestSelection>();
+		break;
 
-			if (!found_new_cell)
-			{
-				return;
-			}
-		}
-		else
-		{
-			SetConnections(current_cell, neighbors, random_neighbour_index);
-			current_cell = neighbors[random_neighbour_index];
-			current_cell->visited_ = true;
-		}
-	}
-}
+	case GenerationAlgorithm::GrowingTreeOldest:
+		BeginGrowingTree<OldestSelection>();
+		break;
 
-void Maze::GenerateMazeWilsons()
-{
-	ResetBoard();
+	case GenerationAlgorithm::GrowingTreeRandom:
+		BeginGrowingTree<RandomSelection>();
+		break;
 
-	Cell* target_cell = &board_[std::rand() % board_.size()];
-	target_cell->visited_ = true;
-	std::size_t unvisited_cells = board_.size() - 1;
-	std::vector<Cell*> carving_path;
+	case GenerationAlgorithm::GrowingTreeMixed:
+		BeginGrowingTree<MixedSelection>();
+		break;
 
-	while (unvisited_cells != 0)
+	case GenerationAlgorithm::PrimWeighted:
 	{
-		if (carving_path.empty())
-		{
-			std::size_t random_index = std::rand() % board_.size();
+		const std::size_t first_index = RandomIndex(board_.size());
+
+		GenerateEdgesWeights();
+		prim_frontier_.Reset(board_.size());
+		prim_parent_directions_.resize(board_.size());
+		board_[first_index].visited_ = true;
+		QueuePrimWeightedNeighbors(first_index);
+		break;
+	}
 
-			while (board_[random_index].visited_)
-			{
-				random_index = std::rand() % board_.size();
-			}
+	case GenerationAlgorithm::None:
+		return;
+	}
 
-			board_[random_index].seen_ = true;
-			carving_path.push_back(&board_[random_index]);
-		}
+	generation_algorithm_ = algorithm;
+	performance_.algorithm_ = algorithm;
+	performance_.generated_cells_ = board_.size();
+	performance_.generation_seconds_ = 0.0;
+
+	MAZE_STATS_END_PHASE(&generation_stats_);
+}
 
-		std::vector<Cell*> neighbors = GetNeighborCells(GetCellIndex(*carving_path.back()));
-		int random_neighbour_index = GetRandomNeighborIndex(neighbors, false);
+bool Maze::StepGeneration()
+{
+	bool running = false;
 
-		if (neighbors[random_neighbour_index]->visited_)
-		{
-			carving_path.push_back(neighbors[random_neighbour_index]);
-			carving_path.back()->seen_ = true;
+	switch (generation_algorithm_)
+	{
+	case GenerationAlgorithm::RecursiveBacktracker:
+		running = stackless_backtracker_ ? StepStacklessBacktracker() : StepRecursiveBacktracker();
+		break;
 
-			for (std::size_t i = 0; i < carving_path.size() - 1; ++i)
-			{
-				carving_path[i]->visited_ = true;
-				carving_path[i]->seen_ = false;
-				SetConnections(carving_path[i], GetNeighborCells(GetCellIndex(*carving_path[i])), GetNeighborIndex(*carving_path[i], *carving_path[i + 1]));
-				--unvisited_cells;
-			}
+	case GenerationAlgorithm::HuntAndKill:
+		running = StepHuntAndKill();
+		break;
 
-			carving_path.clear();
-		}
-		else
-		{
-			if (neighbors[random_neighbour_index]->seen_)
-			{
-				Cell* cycle_begin = neighbors[random_neighbour_index];
+	case GenerationAlgorithm::Wilsons:
+		running = StepWilsons();
+		break;
 
-				while (carving_path.back() != cycle_begin)
-				{
-					carving_path.back()->seen_ = false;
-					carving_path.pop_back();
-				}
-			}
-			else
-			{
-				carving_path.push_back(neighbors[random_neighbour_index]);
-				carving_path.back()->seen_ = true;
-			}
-		}
-	}
-}
+	case GenerationAlgorithm::RandomizedKruskal:
+		running = StepRandomizedKruskal();
+		break;
 
-void Maze::GenerateMazeRandomizedKruskal()
-{
-	ResetBoard();
+	case GenerationAlgorithm::PrimSimplified:
+		running = StepPrimSimplified();
+		break;
 
-	std::vector<std::set<Cell* const>> set_vector;
+	case GenerationAlgorithm::GrowingTreeNewest:
+		running = StepGrowingTree<NewestSelection>();
+		break;
 
-	for (Cell& cell : board_)
-	{
-		set_vector.push_back( { &cell } );
-	}
+	case GenerationAlgorithm::GrowingTreeOldest:
+		running = StepGrowingTree<OldestSelection>();
+		break;
 
-	std::size_t non_empty_sets_remaining = board_.size();
+	case GenerationAlgorithm::GrowingTreeRandom:
+		running = StepGrowingTree<RandomSelection>();
+		break;
 
-	while (non_empty_sets_remaining != 1)
-	{
-		const std::size_t random_index = std::rand() % board_.size();
-		Cell* random_cell = &board_[random_index];
-		std::vector<Cell*> neighbors = GetNeighborCells(random_index);
-		const int random_neighbour_index = GetRandomNeighborIndex(neighbors, false);
-		Cell* random_neighbor = neighbors[random_neighbour_index];
+	case GenerationAlgorithm::GrowingTreeMixed:
+		running = StepGrowingTree<MixedSelection>();
+		break;
 
-		const auto cell_set_it = std::find_if(set_vector.begin(), set_vector.end(), [random_cell](const std::set<Cell* const>& set)
-		{
-			return set.find(random_cell) != set.end();
-		});
+	case GenerationAlgorithm::PrimWeighted:
+		running = StepPrimWeighted();
+		break;
 
-		/* Neighboring cells are not in the same set. */
-		if (cell_set_it->find(random_neighbor) == cell_set_it->end())
-		{
-			const auto neighbor_set_it = std::find_if(set_vector.begin(), set_vector.end(), [random_neighbor](const std::set<Cell* const>& set)
-			{
-				return set.find(random_neighbor) != set.end();
-			});
+	case GenerationAlgorithm::None:
+		break;
+	}
 
-			cell_set_it->merge(*neighbor_set_it);
-			SetConnections(random_cell, neighbors, random_neighbour_index);
-			--non_empty_sets_remaining;
-		}
+	if (!running)
+	{
+		generation_algorithm_ = GenerationAlgorithm::None;
+		generation_cells_.clear();
+		generation_current_cell_ = nullptr;
 	}
+
+	return running;
 }
-	
-void Maze::GenerateMazePrimSimplified()
-{
-	ResetBoard();
 
-	std::vector<Cell*> visited_cells = { &board_[std::rand() % board_.size()] };		
-	visited_cells.front()->visited_ = true;
+bool Maze::FinishGeneration()
+{
+	MAZE_TRACE_ZONE(GetAlgorithmId(generation_algorithm_));
+	const Timer timer;
 
-	while (visited_cells.size() != board_.size())
+	for (std::size_t step = 1; StepGeneration(); ++step)
 	{
-		Cell* random_visited_cell = visited_cells[std::rand() % visited_cells.size()];
-		std::vector<Cell*> neighbors = GetNeighborCells(GetCellIndex(*random_visited_cell));
-		int random_unvisited_neighbor_index = GetRandomNeighborIndex(neighbors, true);
-		
-		while (random_unvisited_neighbor_index == -1)
+		if (step % cancel_check_interval == 0 && IsCancelled())
 		{
-			random_visited_cell = visited_cells[std::rand() % visited_cells.size()];
-			neighbors = GetNeighborCells(GetCellIndex(*random_visited_cell));
-			random_unvisited_neighbor_index = GetRandomNeighborIndex(neighbors, true);
+			return false;
 		}
-		
-		SetConnections(random_visited_cell, neighbors, random_unvisited_neighbor_index);
-		visited_cells.push_back(neighbors[random_unvisited_neighbor_index]);
-		visited_cells.back()->visited_ = true;
 	}
+
+	const double seconds = timer.elapsed();
+	performance_.generation_seconds_ += seconds;
+
+	MAZE_STATS_PHASE_TIME(&generation_stats_, "carve", seconds);
+	MAZE_STATS_END_RUN(&generation_stats_, cells_width_, cells_height_, seed_);
+
+	return true;
 }
 
-void Maze::BreadthFirstSearch(Cell* start_cell)
+void Maze::GenerateMaze(GenerationAlgorithm algorithm, std::uint32_t seed)
 {
-	for (Cell& cell : board_)
-	{
-		cell.visited_ = false;
-	}
+	BeginGeneration(algorithm, seed);
+	FinishGeneration();
+}
 
-	bfs_cells_predecessors_.clear();
-	bfs_cells_predecessors_.resize(board_.size());
-	bfs_cells_distances_.clear();
-	bfs_cells_distances_.resize(board_.size());
-	std::fill(bfs_cells_distances_.begin(), bfs_cells_distances_.end(), 0);
+bool Maze::IsGenerating() const
+{
+	return generation_algorithm_ != GenerationAlgorithm::None;
+}
 
-	const std::size_t random_index = std::rand() % board_.size();
-	std::deque<Cell*> bfs_queue = { (start_cell == nullptr) ? &board_[random_index] : start_cell };
-	
-	while (!bfs_queue.empty())
+const char* Maze::GetAlgorithmName(GenerationAlgorithm algorithm) const
+{
+	switch (algorithm)
 	{
-		Cell* current_cell = bfs_queue.front();
-		current_cell->visited_ = true;
-		bfs_queue.pop_front();
+	case GenerationAlgorithm::RecursiveBacktracker:
+		return "Recursive backtracker algorithm.";
+
+	case GenerationAlgorithm::HuntAndKill:
+		return "Hunt and kill algorithm.";
+
+	case GenerationAlgorithm::Wilsons:
+		return "Wilson's algorithm.";
+
+	case GenerationAlgorithm::RandomizedKruskal:
+		return "Randomized Kruskal's algorithm.";
+
+	case GenerationAlgorithm::PrimSimplified:
+		return "Prim's simplified algorithm.";
+
+	case GenerationAlgorithm::GrowingTreeNewest:
+		return "Growing tree algorithm (newest cell).";
+
+	case GenerationAlgorithm::GrowingTreeOldest:
+		return "Growing tree algorithm (oldest cell).";
+
+	case GenerationAlgorithm::GrowingTreeRandom:
+		return "Growing tree algorithm (random cell).";
+
+	case GenerationAlgorithm::GrowingTreeMixed:
+		return "Growing tree algorithm (newest and random cells).";
+
+	case GenerationAlgorithm::PrimWeighted:
+		return "Prim's algorithm (weighted).";
+
+	case GenerationAlgorithm::None:
+		break;
+	}
+
+	return "";
+}
+
+const char* Maze::GetAlgorithmId(GenerationAlgorithm algorithm) const
+{
+	switch (algorithm)
+	{
+	case GenerationAlgorithm::RecursiveBacktracker:
+		return "recursive_backtracker";
+
+	case GenerationAlgorithm::HuntAndKill:
+		return "hunt_and_kill";
+
+	case GenerationAlgorithm::Wilsons:
+		return "wilsons";
+
+	case GenerationAlgorithm::RandomizedKruskal:
+		return "randomized_kruskal";
+
+	case GenerationAlgorithm::PrimSimplified:
+		return "prim_simplified";
+
+	case GenerationAlgorithm::GrowingTreeNewest:
+		return "growing_tree_newest";
+
+	case GenerationAlgorithm::GrowingTreeOldest:
+		return "growing_tree_oldest";
+
+	case GenerationAlgorithm::GrowingTreeRandom:
+		return "growing_tree_random";
+
+	case GenerationAlgorithm::GrowingTreeMixed:
+		return "growing_tree_mixed";
+
+	case GenerationAlgorithm::PrimWeighted:
+		return "prim_weighted";
+
+	case GenerationAlgorithm::None:
+		break;
+	}
+
+	return "none";
+}
+
+int Maze::GetRandomNeighborIndex(const CellNeighbors& neighbors, bool unvisited)
+{
+	std::uint32_t valid_neighbors = 0;
+
+	for (int direction = 0; direction < 4; ++direction)
+	{
+		if (neighbors[direction] != nullptr && (!unvisited || !neighbors[direction]->visited_))
+		{
+			valid_neighbors |= 1u << direction;
+		}
+	}
+
+	if (valid_neighbors == 0)
+	{
+		return -1;
+	}
+
+	MAZE_STATS_COUNT(stats_, rng_draws_);
+
+	return random_bits_.SelectBit(valid_neighbors);
+}
+
+void Maze::SetConnections(Cell* current_cell, const CellNeighbors& neighbors, std::size_t neighbor_index, bool unset)
+{
+	assert(current_cell != nullptr);
+
+	/* A passage to the top or bottom neighbor is drawn as the top wall of the lower of the two rows. */
+	const int row = current_cell->rect_.y / cell_size_;
+	const int column = current_cell->rect_.x / cell_size_;
+	MarkLevelOfDetailChanged(column, row);
+	MarkLevelOfDetailChanged(column + (neighbor_index == 1) - (neighbor_index == 0), row + (neighbor_index == 3) - (neighbor_index == 2));
+	MarkRowsChanged((neighbor_index == 2) ? row - 1 : row, (neighbor_index == 3) ? row + 1 : row);
+
+	switch (neighbor_index)
+		{
+		case 0:
+			current_cell->left_edge_.destination_cell_ = unset ? nullptr : neighbors[neighbor_index];
+			neighbors[neighbor_index]->right_edge_.destination_cell_ = unset ? nullptr : current_cell;
+			break;
+
+		case 1:
+			current_cell->right_edge_.destination_cell_ = unset ? nullptr : neighbors[neighbor_index];
+			neighbors[neighbor_index]->left_edge_.destination_cell_ = unset ? nullptr : current_cell;
+			break;
+		
+		case 2:
+			current_cell->top_edge_.destination_cell_ = unset ? nullptr : neighbors[neighbor_index];
+			neighbors[neighbor_index]->bottom_edge_.destination_cell_ = unset ? nullptr : current_cell;
+			break;
+		
+		case 3:
+			current_cell->bottom_edge_.destination_cell_ = unset ? nullptr : neighbors[neighbor_index];
+			neighbors[neighbor_index]->top_edge_.destination_cell_ = unset ? nullptr : current_cell;
+			break;
+
+		default:
+			assert(false);
+		}
+}
+
+std::size_t Maze::GetCellIndex(const Cell& cell)
+{
+	return static_cast<std::size_t>(&cell - board_.data());
+}
+
+void Maze::GenerateMazeRecursiveBacktracker()
+{
+	GenerateMaze(GenerationAlgorithm::RecursiveBacktracker, NextSeed());
+}
+
+void Maze::GenerateMazeHuntAndKill()
+{
+	GenerateMaze(GenerationAlgorithm::HuntAndKill, NextSeed());
+}
+
+void Maze::GenerateMazeWilsons()
+{
+	GenerateMaze(GenerationAlgorithm::Wilsons, NextSeed());
+}
+
+void Maze::GenerateMazeRandomizedKruskal()
+{
+	GenerateMaze(GenerationAlgorithm::RandomizedKruskal, NextSeed());
+}
+
+void Maze::GenerateMazePrimSimplified()
+{
+	GenerateMaze(GenerationAlgorithm::PrimSimplified, NextSeed());
+}
+
+bool Maze::StepRecursiveBacktracker()
+{
+	if (generation_cells_.empty())
+	{
+		return false;
+	}
+
+	Cell* const stack_top = generation_cells_.back();
+	const CellNeighbors neighbors = GetNeighborCells(GetCellIndex(*stack_top));
+	const int random_neighbour_index = GetRandomNeighborIndex(neighbors, true);
+
+	if (random_neighbour_index == -1)
+	{
+		generation_cells_.pop_back();
+		return !generation_cells_.empty();
+	}
+
+	SetConnections(stack_top, neighbors, random_neighbour_index);
+	generation_cells_.push_back(neighbors[random_neighbour_index]);
+	generation_cells_.back()->visited_ = true;
+	MAZE_STATS_HIGH_WATER(stats_, stack_high_water_, generation_cells_.size());
+
+	return true;
+}
+
+bool Maze::StepStacklessBacktracker()
+{
+	/* Same walk and random draws as StepRecursiveBacktracker, with the stack top kept in generation_current_cell_. */
+	const std::size_t cell_index = GetCellIndex(*generation_current_cell_);
+	const CellNeighbors neighbors = GetNeighborCells(cell_index);
+	const int random_neighbour_index = GetRandomNeighborIndex(neighbors, true);
+
+	if (random_neighbour_index == -1)
+	{
+		if (cell_index == backtracker_first_index_)
+		{
+			return false;
+		}
+
+		const int came_from = (backtracker_came_from_[cell_index / 4] >> (cell_index % 4 * 2)) & 3;
+		generation_current_cell_ = GetCellEdge(*generation_current_cell_, came_from).destination_cell_;
+
+		return true;
+	}
+
+	SetConnections(generation_current_cell_, neighbors, random_neighbour_index);
+	generation_current_cell_ = neighbors[random_neighbour_index];
+	generation_current_cell_->visited_ = true;
+
+	const std::size_t neighbor_index = GetCellIndex(*generation_current_cell_);
+	backtracker_came_from_[neighbor_index / 4] |= static_cast<std::uint8_t>((random_neighbour_index ^ 1) << (neighbor_index % 4 * 2));
+
+	return true;
+}
+
+bool Maze::StepHuntAndKill()
+{
+	/* Kill phase: random walk from the current cell until it gets stuck. */
+	if (generation_current_cell_ != nullptr)
+	{
+		const CellNeighbors neighbors = GetNeighborCells(GetCellIndex(*generation_current_cell_));
+		const int random_neighbour_index = GetRandomNeighborIndex(neighbors, true);
+
+		if (random_neighbour_index == -1)
+		{
+			generation_current_cell_ = nullptr;
+			generation_hunt_index_ = 0;
+			return true;
+		}
+
+		SetConnections(generation_current_cell_, neighbors, random_neighbour_index);
+		generation_current_cell_ = neighbors[random_neighbour_index];
+		generation_current_cell_->visited_ = true;
+
+		return true;
+	}
+
+	/* Hunt phase: scan one cell per step for an unvisited cell next to the visited region. */
+	if (generation_hunt_index_ == board_.size())
+	{
+		return false;
+	}
+
+	Cell& cell = board_[generation_hunt_index_++];
+
+	if (cell.visited_)
+	{
+		return true;
+	}
+
+	const CellNeighbors neighbors = GetNeighborCells(GetCellIndex(cell));
+	
+	for (std::size_t index = 0; index < neighbors.size(); ++index)
+	{
+		if (neighbors[index] != nullptr && neighbors[index]->visited_)
+		{
+			SetConnections(&cell, neighbors, index);
+			generation_current_cell_ = &cell;
+			generation_current_cell_->visited_ = true;
+			break;
+		}
+	}
+
+	return true;
+}
+
+bool Maze::StepWilsons()
+{
+	if (generation_remaining_ == 0)
+	{
+		return false;
+	}
+
+	std::vector<Cell*>& carving_path = generation_cells_;
+
+	if (carving_path.empty())
+	{
+		std::size_t random_index = RandomIndex(board_.size());
+
+		while (board_[random_index].visited_)
+		{
+			MAZE_STATS_COUNT(stats_, rejected_samples_);
+			random_index = RandomIndex(board_.size());
+		}
+
+		board_[random_index].seen_ = true;
+		carving_path.push_back(&board_[random_index]);
+	}
+
+	CellNeighbors neighbors = GetNeighborCells(GetCellIndex(*carving_path.back()));
+	int random_neighbour_index = GetRandomNeighborIndex(neighbors, false);
+
+	if (neighbors[random_neighbour_index]->visited_)
+	{
+		carving_path.push_back(neighbors[random_neighbour_index]);
+		carving_path.back()->seen_ = true;
+
+		for (std::size_t i = 0; i < carving_path.size() - 1; ++i)
+		{
+			carving_path[i]->visited_ = true;
+			carving_path[i]->seen_ = false;
+			SetConnections(carving_path[i], GetNeighborCells(GetCellIndex(*carving_path[i])), GetNeighborIndex(*carving_path[i], *carving_path[i + 1]));
+			--generation_remaining_;
+		}
+
+		carving_path.clear();
+	}
+	else
+	{
+		if (neighbors[random_neighbour_index]->seen_)
+		{
+			Cell* cycle_begin = neighbors[random_neighbour_index];
+
+			while (carving_path.back() != cycle_begin)
+			{
+				carving_path.back()->seen_ = false;
+				carving_path.pop_back();
+			}
+		}
+		else
+		{
+			carving_path.push_back(neighbors[random_neighbour_index]);
+			carving_path.back()->seen_ = true;
+			MAZE_STATS_HIGH_WATER(stats_, stack_high_water_, carving_path.size());
+		}
+	}
+
+	return generation_remaining_ != 0;
+}
+
+bool Maze::StepRandomizedKruskal()
+{
+	if (generation_remaining_ <= 1)
+	{
+		return false;
+	}
+
+	const std::size_t random_index = RandomIndex(board_.size());
+	Cell* random_cell = &board_[random_index];
+	const CellNeighbors neighbors = GetNeighborCells(random_index);
+	const int random_neighbour_index = GetRandomNeighborIndex(neighbors, false);
+	Cell* random_neighbor = neighbors[random_neighbour_index];
+
+	std::size_t cell_set = FindKruskalSet(random_index);
+	std::size_t neighbor_set = FindKruskalSet(GetCellIndex(*random_neighbor));
+
+	/* Neighboring cells are not in the same set. */
+	if (cell_set != neighbor_set)
+	{
+		if (kruskal_set_sizes_[cell_set] < kruskal_set_sizes_[neighbor_set])
+		{
+			std::swap(cell_set, neighbor_set);
+		}
+
+		kruskal_parents_[neighbor_set] = cell_set;
+		kruskal_set_sizes_[cell_set] += kruskal_set_sizes_[neighbor_set];
+		SetConnections(random_cell, neighbors, random_neighbour_index);
+		--generation_remaining_;
+	}
+	else
+	{
+		MAZE_STATS_COUNT(stats_, rejected_samples_);
+	}
+
+	return generation_remaining_ != 1;
+}
+
+template <typename Selection>
+void Maze::BeginGrowingTree()
+{
+	const std::uint32_t first_index = static_cast<std::uint32_t>(RandomIndex(board_.size()));
+
+	growing_tree_cells_.Reset<Selection>(board_.size());
+	growing_tree_cells_.Add<Selection>(first_index);
+	board_[first_index].visited_ = true;
+}
+
+template <typename Selection>
+bool Maze::StepGrowingTree()
+{
+	if (growing_tree_cells_.IsEmpty<Selection>())
+	{
+		return false;
+	}
+
+	const std::size_t cell_index = growing_tree_cells_.Select<Selection>([this](std::size_t bound) { return RandomIndex(bound); });
+	const CellNeighbors neighbors = GetNeighborCells(cell_index);
+	const int random_neighbour_index = GetRandomNeighborIndex(neighbors, true);
+
+	/* Shown as the head of the animation. */
+	generation_current_cell_ = &board_[cell_index];
+
+	if (random_neighbour_index == -1)
+	{
+		growing_tree_cells_.RemoveSelected<Selection>();
+		return !growing_tree_cells_.IsEmpty<Selection>();
+	}
+
+	SetConnections(generation_current_cell_, neighbors, random_neighbour_index);
+	neighbors[random_neighbour_index]->visited_ = true;
+	growing_tree_cells_.Add<Selection>(static_cast<std::uint32_t>(GetCellIndex(*neighbors[random_neighbour_index])));
+
+	return true;
+}
+
+std::size_t Maze::FindKruskalSet(std::size_t cell_index)
+{
+	/* Disjoint-set find with path halving. */
+	while (kruskal_parents_[cell_index] != cell_index)
+	{
+		kruskal_parents_[cell_index] = kruskal_parents_[kruskal_parents_[cell_index]];
+		cell_index = kruskal_parents_[cell_index];
+	}
+
+	return cell_index;
+}
+
+bool Maze::StepPrimSimplified()
+{
+	std::vector<Cell*>& visited_cells = generation_cells_;
+
+	if (visited_cells.size() == board_.size())
+	{
+		return false;
+	}
+
+	Cell* random_visited_cell = visited_cells[RandomIndex(visited_cells.size())];
+	CellNeighbors neighbors = GetNeighborCells(GetCellIndex(*random_visited_cell));
+	int random_unvisited_neighbor_index = GetRandomNeighborIndex(neighbors, true);
+	
+	while (random_unvisited_neighbor_index == -1)
+	{
+		MAZE_STATS_COUNT(stats_, rejected_samples_);
+		random_visited_cell = visited_cells[RandomIndex(visited_cells.size())];
+		neighbors = GetNeighborCells(GetCellIndex(*random_visited_cell));
+		random_unvisited_neighbor_index = GetRandomNeighborIndex(neighbors, true);
+	}
+	
+	SetConnections(random_visited_cell, neighbors, random_unvisited_neighbor_index);
+	visited_cells.push_back(neighbors[random_unvisited_neighbor_index]);
+	visited_cells.back()->visited_ = true;
+
+	return visited_cells.size() != board_.size();
+}
+
+void Maze::QueuePrimWeightedNeighbors(std::size_t cell_index)
+{
+	const CellNeighbors neighbors = GetNeighborCells(cell_index);
+
+	for (int direction = 0; direction < 4; ++direction)
+	{
+		Cell* const neighbor = neighbors[direction];
+
+		if (neighbor == nullptr || neighbor->visited_)
+		{
+			continue;
+		}
+
+		const std::size_t neighbor_index = GetCellIndex(*neighbor);
+		const std::uint32_t weight = static_cast<std::uint32_t>(GetCellEdge(board_[cell_index], direction).weight_);
+
+		if (prim_frontier_.PushOrDecrease(static_cast<std::uint32_t>(neighbor_index), weight))
+		{
+			prim_parent_directions_[neighbor_index] = static_cast<std::uint8_t>(direction ^ 1);
+		}
+	}
+}
+
+bool Maze::StepPrimWeighted()
+{
+	if (prim_frontier_.IsEmpty())
+	{
+		return false;
+	}
+
+	/* The frontier cell with the lightest edge into the tree joins it through that edge. */
+	const std::size_t cell_index = prim_frontier_.PopMin();
+
+	generation_current_cell_ = &board_[cell_index];
+	SetConnections(generation_current_cell_, GetNeighborCells(cell_index), prim_parent_directions_[cell_index]);
+	generation_current_cell_->visited_ = true;
+	QueuePrimWeightedNeighbors(cell_index);
+
+	return !prim_frontier_.IsEmpty();
+}
+
+void Maze::BraidMaze(double dead_end_fraction, std::uint32_t seed)
+{
+	RunDeadEndPass(dead_end_fraction, seed, true);
+}
+
+void Maze::SparsifyMaze(double dead_end_fraction, std::uint32_t seed)
+{
+	RunDeadEndPass(dead_end_fraction, seed, false);
+}
+
+void Maze::RunDeadEndPass(double dead_end_fraction, std::uint32_t seed, bool braid)
+{
+	MAZE_TRACE_ZONE(braid ? "braid" : "sparsify");
+
+	if (IsGenerating())
+	{
+		return;
+	}
+
+	CancelBackgroundJob();
+
+	MAZE_STATS_SCOPED_RUN(stats_, braid ? "braid" : "sparsify", cells_width_, cells_height_, seed);
+	MAZE_STATS_PHASE(stats_, "bands");
+
+	/* 
+	 * Rows are split into fixed bands; all even bands are processed concurrently, then all odd ones. A band only ever touches 
+	 * its own cells and the boundary rows of its neighbours, so bands of the same parity never share a cell. Cells on a boundary 
+	 * are always settled by the even band first, which together with per-cell random bits makes the result independent of the 
+	 * number of threads.
+	 */
+	constexpr int band_rows = 32;
+	const int band_count = (cells_height_ + band_rows - 1) / band_rows;
+	const std::uint64_t seed_key = MixBits((static_cast<std::uint64_t>(seed) << 1) | (braid ? 1 : 0));
+
+	WorkerPool inline_pool(1);
+	WorkerPool& pool = worker_pool_ != nullptr ? *worker_pool_ : inline_pool;
+
+	for (int parity = 0; parity < 2; ++parity)
+	{
+		pool.ParallelFor(static_cast<std::size_t>((band_count - parity + 1) / 2), [&](std::size_t task, int)
+			{
+				const int band = parity + 2 * static_cast<int>(task);
+				ProcessDeadEndRows(band * band_rows, std::min((band + 1) * band_rows, cells_height_) - 1, dead_end_fraction, seed_key, braid);
+			});
+	}
+
+	lod_dirty_ = true;
+	MarkRowsChanged(0, cells_height_ - 1);
+	shortest_path_found_ = FindShortestPathBetweenStartEnd();
+}
+
+void Maze::ProcessDeadEndRows(int first_row, int last_row, double dead_end_fraction, std::uint64_t seed_key, bool braid)
+{
+	MAZE_TRACE_ZONE("dead end rows");
+
+	for (int y = first_row; y <= last_row; ++y)
+	{
+		for (int x = 0; x < cells_width_; ++x)
+		{
+			Cell* const cell = GetCellAt(x, y);
+
+			if (cell == nullptr || CountPassages(*cell) != 1)
+			{
+				continue;
+			}
+
+			const std::uint64_t random_bits = MixBits(seed_key + static_cast<std::uint64_t>(y) * cells_width_ + x);
+
+			if ((random_bits >> 11) * 0x1.0p-53 >= dead_end_fraction)
+			{
+				continue;
+			}
+
+			if (!braid)
+			{
+				/* Sparsify: wall the dead end off completely, which may turn the cell it led to into a new dead end. */
+				if (cell == start_cell_ || cell == end_cell_)
+				{
+					continue;
+				}
+
+				for (int direction = 0; direction < 4; ++direction)
+				{
+					Cell* const neighbor = GetCellEdge(*cell, direction).destination_cell_;
+
+					if (neighbor != nullptr)
+					{
+						GetCellEdge(*cell, direction).destination_cell_ = nullptr;
+						GetCellEdge(*neighbor, direction ^ 1).destination_cell_ = nullptr;
+					}
+				}
+
+				continue;
+			}
+
+			/* Braid: open a wall to a neighbor in the maze, preferring neighbors that are dead ends themselves so both get removed. */
+			const std::size_t cell_index = GetCellIndex(*cell);
+			const CellNeighbors neighbors = { GetLeftNeighbor(cell_index), GetRightNeighbor(cell_index), GetTopNeighbor(cell_index), GetBottomNeighbor(cell_index) };
+			std::array<int, 4> candidates;
+			int candidate_count = 0;
+			bool dead_end_candidates = false;
+
+			for (int direction = 0; direction < 4; ++direction)
+			{
+				Cell* const neighbor = neighbors[direction];
+
+				if (neighbor == nullptr || GetCellEdge(*cell, direction).destination_cell_ != nullptr || CountPassages(*neighbor) == 0)
+				{
+					continue;
+				}
+
+				const bool dead_end = CountPassages(*neighbor) == 1;
+
+				if (dead_end && !dead_end_candidates)
+				{
+					dead_end_candidates = true;
+					candidate_count = 0;
+				}
+
+				if (dead_end || !dead_end_candidates)
+				{
+					candidates[candidate_count++] = direction;
+				}
+			}
+
+			if (candidate_count == 0)
+			{
+				continue;
+			}
+
+			const int direction = candidates[((random_bits & 0xffffffffULL) * candidate_count) >> 32];
+			GetCellEdge(*cell, direction).destination_cell_ = neighbors[direction];
+			GetCellEdge(*neighbors[direction], direction ^ 1).destination_cell_ = cell;
+		}
+	}
+}
+
+void Maze::BreadthFirstSearch(Cell* start_cell)
+{
+	MAZE_STATS_SCOPED_RUN(stats_, "breadth_first_search", cells_width_, cells_height_, seed_);
+	MAZE_STATS_PHASE(stats_, "setup");
+
+	for (Cell& cell : board_)
+	{
+		cell.visited_ = false;
+	}
+
+	bfs_cells_predecessors_.clear();
+	bfs_cells_predecessors_.resize(board_.size());
+	bfs_cells_distances_.clear();
+	bfs_cells_distances_.resize(board_.size());
+	std::fill(bfs_cells_distances_.begin(), bfs_cells_distances_.end(), 0);
+	path_tree_complete_ = false;
+
+	const std::size_t random_index = RandomIndex(board_.size());
+
+	/* search_cells_ is used as a FIFO queue; every cell is enqueued at most once, when it is first discovered. */
+	search_cells_.clear();
+	search_cells_.reserve(board_.size());
+	search_cells_.push_back((start_cell == nullptr) ? &board_[random_index] : start_cell);
+	search_cells_.front()->visited_ = true;
+
+	MAZE_STATS_PHASE(stats_, "search");
+	
+	for (std::size_t queue_front = 0; queue_front < search_cells_.size(); ++queue_front)
+	{
+		if (queue_front % cancel_check_interval == 0 && IsCancelled())
+		{
+			return;
+		}
+
+		Cell* current_cell = search_cells_[queue_front];
+
+		for (Cell* cell : GetConnectedNeighborCells(*current_cell))
+		{
+			if (cell == nullptr || cell->visited_)
+			{
+				continue;
+			}
+
+			std::size_t cell_index = GetCellIndex(*cell);
+			cell->visited_ = true;
+			bfs_cells_predecessors_[cell_index] = current_cell;
+			bfs_cells_distances_[cell_index] = bfs_cells_distances_[GetCellIndex(*current_cell)] + 1;
+			search_cells_.push_back(cell);
+			MAZE_STATS_HIGH_WATER(stats_, queue_high_water_, search_cells_.size() - queue_front);
+		}
+	}
+}
+
+bool Maze::DetectCycleDepthFirstSearch(Cell* start_cell)
+{
+	MAZE_TRACE_ZONE("detect cycle");
+	MAZE_STATS_SCOPED_RUN(stats_, "detect_cycle_depth_first_search", cells_width_, cells_height_, seed_);
+	MAZE_STATS_PHASE(stats_, "setup");
+
+	for (Cell& board_cell : board_)
+	{
+		board_cell.visited_ = false;
+	}
+
+	dfs_cells_parents_.assign(board_.size(), nullptr);
+	dfs_cells_discovering_.assign(board_.size(), false);
+
+	/* search_cells_ is used as the DFS stack; the discovering flags keep every cell on it at most once. */
+	std::vector<Cell*>& cell_stack = search_cells_;
+	cell_stack.clear();
+	cell_stack.reserve(board_.size());
+	cell_stack.push_back((start_cell == nullptr) ? &board_[RandomIndex(board_.size())] : start_cell);
+	dfs_cells_parents_[GetCellIndex(*cell_stack.back())] = nullptr;
+	dfs_cells_discovering_[GetCellIndex(*cell_stack.back())] = true;
+	Cell* current_cell = nullptr;
+
+	MAZE_STATS_PHASE(stats_, "search");
+
+	while (!cell_stack.empty())
+	{
+		current_cell = cell_stack.back();
+		current_cell->visited_ = true;
+		cell_stack.pop_back();
+
+		for (Cell* cell : GetConnectedNeighborCells(*current_cell))
+		{
+			if (cell == nullptr)
+			{
+				continue;
+			}
+
+			const std::size_t cell_index = GetCellIndex(*cell);
+
+			if (dfs_cells_parents_[cell_index] == nullptr && !cell->visited_)
+			{
+				dfs_cells_parents_[cell_index] = current_cell;
+			}
+
+			if (cell->visited_)
+			{
+				if (dfs_cells_parents_[GetCellIndex(*current_cell)] != cell)
+				{
+					return true;
+				}
+				else
+				{
+					continue;
+				}
+			}
+			else if (!dfs_cells_discovering_[cell_index])
+			{
+				cell_stack.push_back(cell);
+				dfs_cells_discovering_[cell_index] = true;
+				MAZE_STATS_HIGH_WATER(stats_, stack_high_water_, cell_stack.size());
+			}
+		}
+	}
+
+	return false;
+}
+
+bool Maze::FindShortestPathBetweenStartEnd()
+{
+	MAZE_TRACE_ZONE("shortest path");
+
+	if (start_cell_ == nullptr || end_cell_ == nullptr)
+	{
+		return false;
+	}
+
+	MAZE_STATS_SCOPED_RUN(stats_, "shortest_path_breadth_first_search", cells_width_, cells_height_, seed_);
+	MAZE_STATS_PHASE(stats_, "setup");
+
+	for (Cell& cell : board_)
+	{
+		cell.visited_ = false;
+	}
+
+	bfs_cells_predecessors_.clear();
+	bfs_cells_predecessors_.resize(board_.size());
+	bfs_cells_distances_.clear();
+	bfs_cells_distances_.resize(board_.size());
+
+	search_cells_.clear();
+	search_cells_.reserve(board_.size());
+	search_cells_.push_back(start_cell_);
+	start_cell_->visited_ = true;
+
+	const Timer timer;
+	performance_.path_length_ = 0;
+	path_points_.clear();
+	path_revealed_points_ = 0;
+	path_tree_complete_ = false;
+
+	MAZE_STATS_PHASE(stats_, "search");
+
+	for (std::size_t queue_front = 0; queue_front < search_cells_.size(); ++queue_front)
+	{
+		if (queue_front % cancel_check_interval == 0 && IsCancelled())
+		{
+			return false;
+		}
+
+		Cell* current_cell = search_cells_[queue_front];
+
+		for (Cell* cell : GetConnectedNeighborCells(*current_cell))
+		{
+			if (cell == nullptr || cell->visited_)
+			{
+				continue;
+			}
+
+			cell->visited_ = true;
+			bfs_cells_predecessors_[GetCellIndex(*cell)] = current_cell;
+
+			if (cell == end_cell_)
+			{
+				performance_.search_nodes_expanded_ = queue_front + 1;
+				performance_.search_seconds_ = timer.elapsed();
+
+				BuildPathPoints();
+				performance_.path_length_ = path_points_.size();
+
+				return true;
+			}
+			
+			search_cells_.push_back(cell);
+			MAZE_STATS_HIGH_WATER(stats_, queue_high_water_, search_cells_.size() - queue_front);
+		}
+	}
+
+	performance_.search_nodes_expanded_ = search_cells_.size();
+	performance_.search_seconds_ = timer.elapsed();
+
+	return false;
+}
+
+bool Maze::AreCellsConnected(Cell& first_cell, Cell& second_cell)
+{
+	MAZE_TRACE_ZONE("connected cells");
+
+	/* The complete tree of the start cell spans its whole component, so a cell in it is connected to exactly the others in it. */
+	if (path_tree_complete_)
+	{
+		const bool first_reached = bfs_cells_distances_[GetCellIndex(first_cell)] != unreached_distance;
+		const bool second_reached = bfs_cells_distances_[GetCellIndex(second_cell)] != unreached_distance;
+
+		if (first_reached || second_reached)
+		{
+			return first_reached && second_reached;
+		}
+	}
+
+	if (connection_marks_.size() != board_.size() || connection_stamp_ >= std::numeric_limits<std::uint32_t>::max() - 2)
+	{
+		connection_marks_.assign(board_.size(), 0);
+		connection_stamp_ = 0;
+	}
+
+	connection_stamp_ += 2;
+
+	/* 
+	 * Both cells grow a breadth-first search, one cell per side in turn, until the searches meet or one of them runs out. A
+	 * cell walled off in a small pocket is answered after about twice the size of the pocket, whatever the size of the board.
+	 */
+	Cell* const cells[2] = { &first_cell, &second_cell };
+	std::size_t queue_fronts[2] = { 0, 0 };
+
+	for (int side = 0; side < 2; ++side)
+	{
+		connection_queues_[side].clear();
+		connection_queues_[side].push_back(cells[side]);
+		connection_marks_[GetCellIndex(*cells[side])] = connection_stamp_ + side;
+	}
+
+	while (queue_fronts[0] < connection_queues_[0].size() && queue_fronts[1] < connection_queues_[1].size())
+	{
+		for (int side = 0; side < 2; ++side)
+		{
+			Cell* const current_cell = connection_queues_[side][queue_fronts[side]++];
+
+			for (Cell* cell : GetConnectedNeighborCells(*current_cell))
+			{
+				if (cell == nullptr)
+				{
+					continue;
+				}
+
+				std::uint32_t& mark = connection_marks_[GetCellIndex(*cell)];
+
+				if (mark == connection_stamp_ + (1 - side))
+				{
+					return true;
+				}
+
+				if (mark != connection_stamp_ + side)
+				{
+					mark = connection_stamp_ + side;
+					connection_queues_[side].push_back(cell);
+				}
+			}
+		}
+	}
+
+	return false;
+}
+	
+std::size_t Maze::BuildPathTree()
+{
+	MAZE_TRACE_ZONE("build path tree");
+
+	bfs_cells_predecessors_.assign(board_.size(), nullptr);
+	bfs_cells_distances_.assign(board_.size(), unreached_distance);
+	bfs_cells_distances_[GetCellIndex(*start_cell_)] = 0;
+
+	/* Distances double as the visited marks, so the flags a generator may depend on are left alone. */
+	repair_cells_.clear();
+	repair_cells_.push_back(start_cell_);
+
+	for (std::size_t queue_front = 0; queue_front < repair_cells_.size(); ++queue_front)
+	{
+		Cell* const current_cell = repair_cells_[queue_front];
+		const int distance = bfs_cells_distances_[GetCellIndex(*current_cell)] + 1;
 
 		for (Cell* cell : GetConnectedNeighborCells(*current_cell))
 		{
-			if (cell == nullptr || cell->visited_)
+			if (cell != nullptr && bfs_cells_distances_[GetCellIndex(*cell)] == unreached_distance)
 			{
-				continue;
+				bfs_cells_distances_[GetCellIndex(*cell)] = distance;
+				bfs_cells_predecessors_[GetCellIndex(*cell)] = current_cell;
+				repair_cells_.push_back(cell);
+			}
+		}
+	}
+
+	path_tree_complete_ = true;
+
+	return repair_cells_.size();
+}
+
+std::size_t Maze::RepairPathTree(Cell& first_cell, Cell& second_cell, bool opened)
+{
+	MAZE_TRACE_ZONE("repair path tree");
+
+	std::size_t touched_cells = 0;
+	repair_cells_.clear();
+	repair_seeds_.clear();
+
+	if (opened)
+	{
+		/* A new passage can only bring cells closer, and only through its farther end. Carving never closes a loop, so that end is one the tree has not reached. */
+		Cell* near_cell = &first_cell;
+		Cell* far_cell = &second_cell;
+
+		if (bfs_cells_distances_[GetCellIndex(*near_cell)] > bfs_cells_distances_[GetCellIndex(*far_cell)])
+		{
+			std::swap(near_cell, far_cell);
+		}
+
+		const int near_distance = bfs_cells_distances_[GetCellIndex(*near_cell)];
+
+		if (near_distance == unreached_distance || near_distance + 1 >= bfs_cells_distances_[GetCellIndex(*far_cell)])
+		{
+			return 0;
+		}
+
+		bfs_cells_distances_[GetCellIndex(*far_cell)] = near_distance + 1;
+		bfs_cells_predecessors_[GetCellIndex(*far_cell)] = near_cell;
+		repair_seeds_.push_back(far_cell);
+	}
+	else
+	{
+		/* Only cells below the closed passage in the tree lose their route; everything else keeps its distance. */
+		Cell* child_cell = nullptr;
+
+		if (bfs_cells_predecessors_[GetCellIndex(second_cell)] == &first_cell)
+		{
+			child_cell = &second_cell;
+		}
+		else if (bfs_cells_predecessors_[GetCellIndex(first_cell)] == &second_cell)
+		{
+			child_cell = &first_cell;
+		}
+		else
+		{
+			return 0;
+		}
+
+		repair_cells_.push_back(child_cell);
+
+		for (std::size_t i = 0; i < repair_cells_.size(); ++i)
+		{
+			for (Cell* cell : GetConnectedNeighborCells(*repair_cells_[i]))
+			{
+				if (cell != nullptr && bfs_cells_predecessors_[GetCellIndex(*cell)] == repair_cells_[i])
+				{
+					repair_cells_.push_back(cell);
+				}
+			}
+		}
+
+		for (Cell* cell : repair_cells_)
+		{
+			bfs_cells_distances_[GetCellIndex(*cell)] = unreached_distance;
+			bfs_cells_predecessors_[GetCellIndex(*cell)] = nullptr;
+		}
+
+		/* Cells of the cut off subtree next to the rest of the tree restart from their nearest such neighbor. */
+		for (Cell* cell : repair_cells_)
+		{
+			const std::size_t cell_index = GetCellIndex(*cell);
+
+			for (Cell* neighbor : GetConnectedNeighborCells(*cell))
+			{
+				if (neighbor != nullptr && bfs_cells_distances_[GetCellIndex(*neighbor)] != unreached_distance && bfs_cells_distances_[GetCellIndex(*neighbor)] + 1 < bfs_cells_distances_[cell_index])
+				{
+					bfs_cells_distances_[cell_index] = bfs_cells_distances_[GetCellIndex(*neighbor)] + 1;
+					bfs_cells_predecessors_[cell_index] = neighbor;
+				}
+			}
+
+			if (bfs_cells_distances_[cell_index] != unreached_distance)
+			{
+				repair_seeds_.push_back(cell);
+			}
+		}
+
+		touched_cells = repair_cells_.size();
+
+		std::sort(repair_seeds_.begin(), repair_seeds_.end(), [this](Cell* first, Cell* second)
+			{
+				return bfs_cells_distances_[GetCellIndex(*first)] < bfs_cells_distances_[GetCellIndex(*second)];
+			});
+	}
+
+	/* Breadth-first wave from the seeds, taken in order of distance together with the queue, relaxing every cell it improves. */
+	repair_cells_.clear();
+	std::size_t next_seed = 0;
+	std::size_t queue_front = 0;
+
+	while (next_seed < repair_seeds_.size() || queue_front < repair_cells_.size())
+	{
+		Cell* current_cell = nullptr;
+
+		if (queue_front < repair_cells_.size() && (next_seed == repair_seeds_.size() || 
+			bfs_cells_distances_[GetCellIndex(*repair_cells_[queue_front])] <= bfs_cells_distances_[GetCellIndex(*repair_seeds_[next_seed])]))
+		{
+			current_cell = repair_cells_[queue_front++];
+		}
+		else
+		{
+			current_cell = repair_seeds_[next_seed++];
+		}
+
+		const int distance = bfs_cells_distances_[GetCellIndex(*current_cell)] + 1;
+		++touched_cells;
+
+		for (Cell* cell : GetConnectedNeighborCells(*current_cell))
+		{
+			if (cell != nullptr && distance < bfs_cells_distances_[GetCellIndex(*cell)])
+			{
+				bfs_cells_distances_[GetCellIndex(*cell)] = distance;
+				bfs_cells_predecessors_[GetCellIndex(*cell)] = current_cell;
+				repair_cells_.push_back(cell);
 			}
+		}
+	}
+
+	return touched_cells;
+}
+
+void Maze::UpdatePathAfterCarving(Cell& first_cell, Cell& second_cell, bool opened)
+{
+	if (start_cell_ == nullptr || end_cell_ == nullptr)
+	{
+		return;
+	}
+
+	const Timer timer;
+
+	/* The first edit after a solve completes the tree once; every later one only repairs it. */
+	performance_.search_nodes_expanded_ = path_tree_complete_ ? RepairPathTree(first_cell, second_cell, opened) : BuildPathTree();
+	performance_.search_seconds_ = timer.elapsed();
+
+	shortest_path_found_ = (bfs_cells_distances_[GetCellIndex(*end_cell_)] != unreached_distance);
+	path_points_.clear();
+
+	if (shortest_path_found_)
+	{
+		BuildPathPoints();
+	}
+
+	/* The path follows the mouse, so it is shown whole instead of being revealed again. */
+	path_revealed_points_ = path_points_.size();
+	performance_.path_length_ = path_points_.size();
+}
+
+bool Maze::FindLongestPathInMaze()
+{
+	MAZE_TRACE_ZONE("longest path");
+
+	start_cell_ = nullptr;
+	end_cell_ = nullptr;
+
+	/* Sparsified mazes contain walled-off cells, so start from the first cell after a random one that is part of the maze. */
+	std::size_t first_index = RandomIndex(board_.size());
+
+	for (std::size_t i = 0; i < board_.size() && CountPassages(board_[first_index]) == 0; ++i)
+	{
+		first_index = (first_index + 1) % board_.size();
+	}
+
+	BreadthFirstSearch(&board_[first_index]);
+	const std::size_t start_index = std::max_element(bfs_cells_distances_.begin(), bfs_cells_distances_.end()) - bfs_cells_distances_.begin();
+	BreadthFirstSearch(&board_[start_index]);
+	const std::size_t end_index = std::max_element(bfs_cells_distances_.begin(), bfs_cells_distances_.end()) - bfs_cells_distances_.begin();
+
+	if (start_index == end_index)
+	{
+		return false;
+	}
+	
+	start_cell_ = &board_[start_index];
+	end_cell_ = &board_[end_index];
+	shortest_path_found_ = FindShortestPathBetweenStartEnd();
+	
+	return true;
+}
+
+void Maze::ResetBoard()
+{
+	CancelBackgroundJob();
+
+    if (game_ != nullptr)
+    {
+	    SDL_SetWindowTitle(game_->window_, constants::game_title);
+    }
+
+	for (Cell& cell : board_)
+	{
+		cell.left_edge_.destination_cell_ = nullptr;
+		cell.left_edge_.weight_ = 0;
+		cell.right_edge_.destination_cell_ = nullptr;
+		cell.right_edge_.weight_ = 0;
+		cell.top_edge_.destination_cell_ = nullptr;
+		cell.top_edge_.weight_ = 0;
+		cell.bottom_edge_.destination_cell_ = nullptr;
+		cell.bottom_edge_.weight_ = 0;
+
+		cell.visited_ = false;
+		cell.seen_ = false;
+		cell.weight_ = 0;
+	}
+	
+	bfs_cells_predecessors_.clear();
+	std::fill(bfs_cells_distances_.begin(), bfs_cells_distances_.end(), 0);
+	start_cell_ = nullptr;
+	end_cell_ = nullptr;
+	shortest_path_found_ = false;
+	path_tree_complete_ = false;
+	path_points_.clear();
+	path_revealed_points_ = 0;
+
+	generation_algorithm_ = GenerationAlgorithm::None;
+	generation_cells_.clear();
+	generation_current_cell_ = nullptr;
+	generation_hunt_index_ = 0;
+	generation_remaining_ = 0;
+
+	lod_dirty_ = true;
+	MarkRowsChanged(0, cells_height_ - 1);
+}
+
+void Maze::GenerateEdgesWeights()
+{
+	/* Every passage gets one random nonnegative weight, stored on both of its sides. */
+	for (std::size_t cell_index = 0; cell_index < board_.size(); ++cell_index)
+	{
+		Cell& cell = board_[cell_index];
+		Cell* const right_neighbor = GetRightNeighbor(cell_index);
+		Cell* const bottom_neighbor = GetBottomNeighbor(cell_index);
+
+		if (right_neighbor != nullptr)
+		{
+			cell.right_edge_.weight_ = static_cast<int>(NextSeed() >> 1);
+			right_neighbor->left_edge_.weight_ = cell.right_edge_.weight_;
+		}
+
+		if (bottom_neighbor != nullptr)
+		{
+			cell.bottom_edge_.weight_ = static_cast<int>(NextSeed() >> 1);
+			bottom_neighbor->top_edge_.weight_ = cell.bottom_edge_.weight_;
+		}
+	}
+}
+
+void Maze::SetCellSize(std::size_t new_size)
+{
+	constexpr std::size_t max_size = 128;
+	constexpr std::size_t min_size = 32;
+	
+	if (constants::screen_width % new_size != 0 || constants::screen_height % new_size != 0 || new_size > max_size || new_size < min_size)
+	{
+		return;
+	}
+
+	CancelBackgroundJob();
+
+	cell_size_ = new_size;
+	cells_width_ = constants::screen_width / cell_size_;
+	cells_height_ = constants::screen_height / cell_size_;
+
+	BuildBoard();
+	camera_.Fit(cells_width_ * cell_size_, cells_height_ * cell_size_);
+}
+
+bool Maze::SetBoardSize(int cells_width, int cells_height)
+{
+	/* Cell rects are stored in world pixels, which have to fit into an int. */
+	const int max_cells = std::numeric_limits<int>::max() / cell_size_ - 1;
+	constexpr int min_cells = 4;
+
+	if (cells_width > max_cells || cells_height > max_cells || cells_width < min_cells || cells_height < min_cells)
+	{
+		return false;
+	}
+
+	if (static_cast<std::uint64_t>(cells_width) * cells_height >= masked_out_cell)
+	{
+		return false;
+	}
+
+	CancelBackgroundJob();
+
+	cells_width_ = cells_width;
+	cells_height_ = cells_height;
+
+	BuildBoard();
+	camera_.Fit(cells_width_ * cell_size_, cells_height_ * cell_size_);
+
+	return true;
+}
+
+std::size_t Maze::GetCellCount() const
+{
+	return board_.size();
+}
+
+const PerformanceStats& Maze::GetPerformanceStats() const
+{
+	return performance_;
+}
+
+std::size_t Maze::GetMemoryFootprint() const
+{
+	const auto bytes = [](const auto& buffer)
+	{
+		return buffer.capacity() * sizeof(buffer[0]);
+	};
+
+	std::size_t footprint = bytes(board_) + bytes(cell_lookup_) + bytes(bfs_cells_predecessors_) + bytes(bfs_cells_distances_) + 
+		bytes(generation_cells_) + bytes(kruskal_parents_) + bytes(kruskal_set_sizes_) + bytes(backtracker_came_from_) + 
+		bytes(prim_parent_directions_) + bytes(search_cells_) + bytes(connection_marks_) + bytes(dfs_cells_parents_) + dfs_cells_discovering_.capacity() / 8 + 
+		bytes(render_floor_rects_) + bytes(render_wall_rects_) + bytes(path_points_) + bytes(render_path_points_) + bytes(lod_dirty_blocks_);
+
+	for (const std::vector<std::uint8_t>& level : lod_levels_)
+	{
+		footprint += bytes(level);
+	}
+
+	for (const std::vector<SDL_Rect>& rects : render_lod_rects_)
+	{
+		footprint += bytes(rects);
+	}
+
+	return footprint + back_maze_footprint_;
+}
+
+std::uint64_t Maze::GetFingerprint(bool canonical)
+{
+	const auto is_open = [this](int x, int y, int direction)
+	{
+		Cell* const cell = GetCellAt(x, y);
+		return cell != nullptr && GetCellEdge(*cell, direction).destination_cell_ != nullptr;
+	};
+
+	return canonical ? fingerprint::HashWallsCanonical(cells_width_, cells_height_, is_open) : fingerprint::HashWalls(cells_width_, cells_height_, 0, is_open);
+}
+
+void Maze::PackWalls(std::vector<std::uint8_t>& walls)
+{
+	walls.assign(packed_walls::GetSize(static_cast<std::size_t>(cells_width_) * cells_height_), 0);
+
+	for (const Cell& cell : board_)
+	{
+		const std::size_t index = static_cast<std::size_t>(cell.rect_.y / cell_size_) * cells_width_ + cell.rect_.x / cell_size_;
+		const int passages = ((cell.right_edge_.destination_cell_ != nullptr) ? packed_walls::right_open : 0) | 
+			((cell.bottom_edge_.destination_cell_ != nullptr) ? packed_walls::bottom_open : 0);
+
+		packed_walls::AddPassages(walls.data(), index, passages);
+	}
+}
+
+GridMaze<SquareTopology> Maze::GetGridSnapshot()
+{
+	GridMaze<SquareTopology> grid({ cells_width_, cells_height_, 1 });
+	std::vector<std::uint8_t> walls;
+
+	PackWalls(walls);
+	packed_walls::Unpack(walls.data(), grid);
+
+	return grid;
+}
+
+bool Maze::GetSolutionPath(std::vector<std::uint32_t>& path)
+{
+	path.clear();
+
+	if (!shortest_path_found_)
+	{
+		return false;
+	}
 
-			std::size_t cell_index = GetCellIndex(*cell);
-			bfs_cells_predecessors_[cell_index] = current_cell;
-			bfs_cells_distances_[cell_index] = bfs_cells_distances_[GetCellIndex(*current_cell)] + 1;
-			bfs_queue.push_back(cell);
-		}
+	for (Cell* current = end_cell_; current != nullptr; current = (current == start_cell_) ? nullptr : bfs_cells_predecessors_[GetCellIndex(*current)])
+	{
+		path.push_back(static_cast<std::uint32_t>((current->rect_.y / cell_size_) * cells_width_ + current->rect_.x / cell_size_));
 	}
+
+	std::reverse(path.begin(), path.end());
+
+	return true;
 }
 
-bool Maze::DetectCycleDepthFirstSearch(Cell* start_cell)
+bool Maze::SetStartEndCells(std::size_t start_index, std::size_t end_index)
 {
-	for (Cell& board_cell : board_)
+	if (start_index >= board_.size() || end_index >= board_.size() || start_index == end_index)
 	{
-		board_cell.visited_ = false;
+		return false;
+	}
+
+	start_cell_ = &board_[start_index];
+	end_cell_ = &board_[end_index];
+	shortest_path_found_ = FindShortestPathBetweenStartEnd();
+
+	return shortest_path_found_;
+}
+
+bool Maze::ExportPng(const std::string& path, int cell_pixels, int wall_pixels, bool draw_solution)
+{
+	if (cell_pixels < 1 || wall_pixels < 0)
+	{
+		return false;
 	}
 
-	std::vector<Cell*> dfs_cells_parents_(board_.size());
-	std::fill(dfs_cells_parents_.begin(), dfs_cells_parents_.end(), nullptr);
+	const std::uint64_t image_width = static_cast<std::uint64_t>(cells_width_) * (cell_pixels + wall_pixels) + wall_pixels;
+	const std::uint64_t image_height = static_cast<std::uint64_t>(cells_height_) * (cell_pixels + wall_pixels) + wall_pixels;
 
-	std::vector<bool> dfs_cells_discovering_(board_.size());
-	std::fill(dfs_cells_discovering_.begin(), dfs_cells_discovering_.end(), false);
+	if (image_width > static_cast<std::uint64_t>(std::numeric_limits<int>::max()) || image_height > static_cast<std::uint64_t>(std::numeric_limits<int>::max()))
+	{
+		printf("Image of %llu x %llu pixels is too large for PNG!\n", static_cast<unsigned long long>(image_width), static_cast<unsigned long long>(image_height));
+		return false;
+	}
 
-	std::stack<Cell*> cell_stack;
-	cell_stack.push((start_cell == nullptr) ? &board_[std::rand() % board_.size()] : start_cell);
-	dfs_cells_parents_[GetCellIndex(*cell_stack.top())] = nullptr;
-	dfs_cells_discovering_[GetCellIndex(*cell_stack.top())] = true;
-	Cell* current_cell = nullptr;
+	std::vector<bool> on_path;
 
-	while (!cell_stack.empty())
+	if (draw_solution && shortest_path_found_)
 	{
-		current_cell = cell_stack.top();
-		current_cell->visited_ = true;
-		cell_stack.pop();
+		on_path.resize(board_.size());
 
-		for (Cell* cell : GetConnectedNeighborCells(*current_cell))
+		for (Cell* current = end_cell_; current != nullptr; current = (current == start_cell_) ? nullptr : bfs_cells_predecessors_[GetCellIndex(*current)])
+		{
+			on_path[GetCellIndex(*current)] = true;
+		}
+	}
+
+	const auto is_on_path = [&on_path](std::size_t index)
+	{
+		return !on_path.empty() && on_path[index];
+	};
+
+	PngWriter writer;
+
+	if (!writer.Open(path, static_cast<int>(image_width), static_cast<int>(image_height)))
+	{
+		return false;
+	}
+
+	constexpr std::uint8_t wall_colour[] = { 0x00, 0x00, 0x00 };
+	constexpr std::uint8_t floor_colour[] = { 0xff, 0xff, 0xff };
+	constexpr std::uint8_t path_colour[] = { 0x00, 0x00, 0xff };
+	constexpr std::uint8_t start_colour[] = { 0x00, 0xff, 0x00 };
+	constexpr std::uint8_t end_colour[] = { 0xff, 0x00, 0x00 };
+
+	/* Only one scanline is kept in memory; every band of identical scanlines is emitted by writing it repeatedly. */
+	std::vector<std::uint8_t> row(image_width * 3);
+	std::size_t row_position = 0;
+
+	const auto append = [&row, &row_position](const std::uint8_t* colour, int count)
+	{
+		for (int i = 0; i < count; ++i)
+		{
+			row[row_position++] = colour[0];
+			row[row_position++] = colour[1];
+			row[row_position++] = colour[2];
+		}
+	};
+
+	const auto write_band = [&writer, &row, &row_position](int count)
+	{
+		bool success = true;
+
+		for (int i = 0; i < count; ++i)
+		{
+			success = writer.WriteRow(row.data()) && success;
+		}
+
+		row_position = 0;
+		return success;
+	};
+
+	bool success = true;
+
+	/* Cells outside the mask are drawn entirely in the wall colour. */
+	for (int y = 0; y <= cells_height_ && success; ++y)
+	{
+		/* Wall band above row y, or the bottom border after the last row. */
+		if (wall_pixels > 0)
+		{
+			for (int x = 0; x < cells_width_; ++x)
+			{
+				const std::uint8_t* colour = wall_colour;
+				const Cell* cell = (y < cells_height_) ? GetCellAt(x, y) : nullptr;
+
+				if (cell != nullptr && cell->top_edge_.destination_cell_ != nullptr)
+				{
+					colour = (is_on_path(GetCellIndex(*cell)) && is_on_path(GetCellIndex(*cell->top_edge_.destination_cell_))) ? path_colour : floor_colour;
+				}
+
+				append(wall_colour, wall_pixels);
+				append(colour, cell_pixels);
+			}
+
+			append(wall_colour, wall_pixels);
+			success = write_band(wall_pixels);
+		}
+
+		if (y == cells_height_)
+		{
+			break;
+		}
+
+		/* Band of cell interiors, separated by the left walls. */
+		for (int x = 0; x < cells_width_; ++x)
 		{
+			const Cell* cell = GetCellAt(x, y);
+			const std::uint8_t* wall = wall_colour;
+			const std::uint8_t* interior = floor_colour;
+
 			if (cell == nullptr)
 			{
+				append(wall_colour, wall_pixels + cell_pixels);
 				continue;
 			}
 
-			const std::size_t cell_index = GetCellIndex(*cell);
+			const std::size_t index = GetCellIndex(*cell);
 
-			if (dfs_cells_parents_[cell_index] == nullptr && !cell->visited_)
+			if (cell->left_edge_.destination_cell_ != nullptr)
 			{
-				dfs_cells_parents_[cell_index] = current_cell;
+				wall = (is_on_path(index) && is_on_path(GetCellIndex(*cell->left_edge_.destination_cell_))) ? path_colour : floor_colour;
 			}
 
-			if (cell->visited_)
+			if (cell == start_cell_)
 			{
-				if (dfs_cells_parents_[GetCellIndex(*current_cell)] != cell)
-				{
-					return true;
-				}
-				else
-				{
-					continue;
-				}
+				interior = start_colour;
 			}
-			else if (!dfs_cells_discovering_[cell_index])
+			else if (cell == end_cell_)
 			{
-				cell_stack.push(cell);
-				dfs_cells_discovering_[cell_index] = true;
+				interior = end_colour;
+			}
+			else if (is_on_path(index))
+			{
+				interior = path_colour;
 			}
+
+			append(wall, wall_pixels);
+			append(interior, cell_pixels);
 		}
+
+		append(wall_colour, wall_pixels);
+		success = write_band(cell_pixels);
 	}
 
-	return false;
+	return writer.Close() && success;
 }
 
-bool Maze::FindShortestPathBetweenStartEnd()
+Cell* Maze::GetCellAtScreen(int screen_x, int screen_y)
 {
-	if (start_cell_ == nullptr || end_cell_ == nullptr)
+	const double world_x = camera_.ScreenToWorldX(screen_x) / cell_size_;
+	const double world_y = camera_.ScreenToWorldY(screen_y) / cell_size_;
+	const int x = static_cast<int>(std::clamp(world_x, 0.0, cells_width_ - 1.0));
+	const int y = static_cast<int>(std::clamp(world_y, 0.0, cells_height_ - 1.0));
+
+	return GetCellAt(x, y);
+}
+
+Cell* Maze::GetCellAt(int x, int y)
+{
+	const std::uint32_t index = cell_lookup_[static_cast<std::size_t>(y) * cells_width_ + x];
+
+	return (index == masked_out_cell) ? nullptr : &board_[index];
+}
+
+void Maze::BuildBoard()
+{
+	const std::size_t grid_size = static_cast<std::size_t>(cells_width_) * cells_height_;
+	std::vector<bool> active_cells;
+
+	if (!mask_path_.empty() && !SampleMask(active_cells))
 	{
-		return false;
+		mask_path_.clear();
 	}
 
-	for (Cell& cell : board_)
+	if (mask_path_.empty())
 	{
-		cell.visited_ = false;
+		active_cells.assign(grid_size, true);
 	}
 
-	bfs_cells_predecessors_.clear();
-	bfs_cells_predecessors_.resize(board_.size());
-	bfs_cells_distances_.clear();
-	bfs_cells_distances_.resize(board_.size());
-	std::deque<Cell*> bfs_queue = { start_cell_ };
+	const std::size_t active_count = std::count(active_cells.begin(), active_cells.end(), true);
 
-	while (!bfs_queue.empty())
-	{
-		Cell* current_cell = bfs_queue.front();
-		current_cell->visited_ = true;
-		bfs_queue.pop_front();
+	board_.clear();
+	board_.resize(active_count);
+	cell_lookup_.assign(grid_size, masked_out_cell);
 
-		for (Cell* cell : GetConnectedNeighborCells(*current_cell))
+	std::size_t index = 0;
+
+	for (int y = 0; y < cells_height_; ++y)
+	{
+		for (int x = 0; x < cells_width_; ++x)
 		{
-			if (cell == nullptr || cell->visited_)
+			const std::size_t grid_index = static_cast<std::size_t>(y) * cells_width_ + x;
+
+			if (!active_cells[grid_index])
 			{
 				continue;
 			}
 
-			bfs_cells_predecessors_[GetCellIndex(*cell)] = current_cell;
+			cell_lookup_[grid_index] = static_cast<std::uint32_t>(index);
+			board_[index].rect_ = { x * cell_size_, y * cell_size_, cell_size_, cell_size_ };
+			++index;
+		}
+	}
 
-			if (cell == end_cell_)
+	custom_maze_current_cell_ = nullptr;
+	ResetBoard();
+}
+
+bool Maze::SampleMask(std::vector<bool>& active_cells)
+{
+	SDL_Surface* const loaded_surface = IMG_Load(mask_path_.c_str());
+
+	if (loaded_surface == nullptr)
+	{
+		printf("Unable to load mask %s! SDL_image Error: %s\n", mask_path_.c_str(), IMG_GetError());
+		return false;
+	}
+
+	SDL_Surface* const surface = SDL_ConvertSurfaceFormat(loaded_surface, SDL_PIXELFORMAT_RGBA32, 0);
+	SDL_FreeSurface(loaded_surface);
+
+	if (surface == nullptr)
+	{
+		printf("Unable to convert mask %s! SDL Error: %s\n", mask_path_.c_str(), SDL_GetError());
+		return false;
+	}
+
+	const std::size_t grid_size = static_cast<std::size_t>(cells_width_) * cells_height_;
+	std::vector<bool> inside(grid_size);
+
+	/* A cell is inside when the mask pixel under its centre is opaque and dark. */
+	SDL_LockSurface(surface);
+
+	for (int y = 0; y < cells_height_; ++y)
+	{
+		const int pixel_y = static_cast<int>((y + 0.5) * surface->h / cells_height_);
+		const std::uint8_t* const row = static_cast<const std::uint8_t*>(surface->pixels) + static_cast<std::size_t>(pixel_y) * surface->pitch;
+
+		for (int x = 0; x < cells_width_; ++x)
+		{
+			const std::uint8_t* const pixel = row + static_cast<std::size_t>((x + 0.5) * surface->w / cells_width_) * 4;
+			const int luminance = (pixel[0] * 299 + pixel[1] * 587 + pixel[2] * 114) / 1000;
+
+			inside[static_cast<std::size_t>(y) * cells_width_ + x] = pixel[3] >= 128 && luminance < 128;
+		}
+	}
+
+	SDL_UnlockSurface(surface);
+	SDL_FreeSurface(surface);
+
+	/* Generators need a connected domain, so only the largest 4-connected region of the mask is kept. */
+	std::vector<std::uint32_t> component(grid_size, masked_out_cell);
+	std::vector<std::size_t> queue;
+	std::uint32_t largest_component = masked_out_cell;
+	std::size_t largest_size = 0;
+	std::uint32_t component_count = 0;
+
+	for (std::size_t seed_index = 0; seed_index < grid_size; ++seed_index)
+	{
+		if (!inside[seed_index] || component[seed_index] != masked_out_cell)
+		{
+			continue;
+		}
+
+		queue.clear();
+		queue.push_back(seed_index);
+		component[seed_index] = component_count;
+
+		for (std::size_t queue_front = 0; queue_front < queue.size(); ++queue_front)
+		{
+			const std::size_t grid_index = queue[queue_front];
+			const int x = static_cast<int>(grid_index % cells_width_);
+			const int y = static_cast<int>(grid_index / cells_width_);
+			const std::size_t neighbors[] = { 
+				(x > 0) ? grid_index - 1 : grid_size, 
+				(x + 1 < cells_width_) ? grid_index + 1 : grid_size, 
+				(y > 0) ? grid_index - cells_width_ : grid_size, 
+				(y + 1 < cells_height_) ? grid_index + cells_width_ : grid_size 
+			};
+
+			for (const std::size_t neighbor : neighbors)
 			{
-				return true;
+				if (neighbor != grid_size && inside[neighbor] && component[neighbor] == masked_out_cell)
+				{
+					component[neighbor] = component_count;
+					queue.push_back(neighbor);
+				}
 			}
-			
-			bfs_queue.push_back(cell);
 		}
+
+		if (queue.size() > largest_size)
+		{
+			largest_size = queue.size();
+			largest_component = component_count;
+		}
+
+		++component_count;
 	}
 
-	return false;
+	if (largest_size < 2)
+	{
+		printf("Mask %s has no connected region of at least 2 cells!\n", mask_path_.c_str());
+		return false;
+	}
+
+	active_cells.resize(grid_size);
+
+	for (std::size_t grid_index = 0; grid_index < grid_size; ++grid_index)
+	{
+		active_cells[grid_index] = component[grid_index] == largest_component;
+	}
+
+	return true;
 }
-	
-bool Maze::FindLongestPathInMaze()
+
+bool Maze::LoadMask(const std::string& path)
 {
-	start_cell_ = nullptr;
-	end_cell_ = nullptr;
+	CancelBackgroundJob();
 
-	BreadthFirstSearch(nullptr);
-	const std::size_t start_index = std::max_element(bfs_cells_distances_.begin(), bfs_cells_distances_.end()) - bfs_cells_distances_.begin();
-	BreadthFirstSearch(&board_[start_index]);
-	const std::size_t end_index = std::max_element(bfs_cells_distances_.begin(), bfs_cells_distances_.end()) - bfs_cells_distances_.begin();
+	mask_path_ = path;
+	BuildBoard();
 
-	if (start_index == end_index)
+	return !mask_path_.empty();
+}
+
+void Maze::ClearMask()
+{
+	CancelBackgroundJob();
+
+	mask_path_.clear();
+	BuildBoard();
+}
+
+BlockRange Maze::GetVisibleBlockRange(int block) const
+{
+	const double block_size = static_cast<double>(cell_size_) * block;
+	const double blocks_width = (cells_width_ + block - 1) / block;
+	const double blocks_height = (cells_height_ + block - 1) / block;
+
+	BlockRange range;
+	range.first_x_ = static_cast<int>(std::clamp(std::floor(camera_.ScreenToWorldX(0) / block_size), 0.0, blocks_width - 1.0));
+	range.first_y_ = static_cast<int>(std::clamp(std::floor(camera_.ScreenToWorldY(0) / block_size), 0.0, blocks_height - 1.0));
+	range.last_x_ = static_cast<int>(std::clamp(std::floor(camera_.ScreenToWorldX(camera_.GetViewWidth()) / block_size), 0.0, blocks_width - 1.0));
+	range.last_y_ = static_cast<int>(std::clamp(std::floor(camera_.ScreenToWorldY(camera_.GetViewHeight()) / block_size), 0.0, blocks_height - 1.0));
+
+	return range;
+}
+
+void Maze::MarkLevelOfDetailChanged(int x, int y)
+{
+	/* Nothing to patch before the pyramid is built or while it is going to be rebuilt anyway. */
+	if (lod_dirty_ || lod_levels_.size() < 2 || x < 0 || y < 0 || x >= cells_width_ || y >= cells_height_)
 	{
-		return false;
+		return;
 	}
-	
-	start_cell_ = &board_[start_index];
-	end_cell_ = &board_[end_index];
-	shortest_path_found_ = FindShortestPathBetweenStartEnd();
-	
-	return true;
+
+	const std::size_t level_width = (cells_width_ + 1) / 2;
+	const std::size_t level_size = lod_levels_[1].size();
+
+	/* Changes touching a large part of the board are cheaper to handle with one rebuild. */
+	if (lod_dirty_blocks_.size() >= level_size / 4 + 64)
+	{
+		lod_dirty_ = true;
+		lod_dirty_blocks_.clear();
+		return;
+	}
+
+	lod_dirty_blocks_.push_back(static_cast<std::size_t>(y / 2) * level_width + x / 2);
 }
 
-void Maze::ResetBoard()
+std::uint8_t Maze::GetBlockDensity(std::size_t level, int x, int y)
 {
-    if (game_ != nullptr)
-    {
-	    SDL_SetWindowTitle(game_->window_, constants::game_title);
-    }
+	const int source_block = 1 << (level - 1);
+	const int source_width = (cells_width_ + source_block - 1) / source_block;
+	const int source_height = (cells_height_ + source_block - 1) / source_block;
+	const std::vector<std::uint8_t>& source = lod_levels_[level - 1];
 
-	for (int y = 0; y < cells_height_; ++y)
+	int sum = 0;
+	int count = 0;
+
+	for (int sy = 2 * y; sy < std::min(2 * y + 2, source_height); ++sy)
 	{
-		for (int x = 0; x < cells_width_; ++x)
+		for (int sx = 2 * x; sx < std::min(2 * x + 2, source_width); ++sx)
+		{
+			if (level == 1)
+			{
+				/* Cells outside the mask count as solid wall. */
+				const Cell* cell = GetCellAt(sx, sy);
+				const int closed_walls = (cell == nullptr) ? 4 : (cell->left_edge_.destination_cell_ == nullptr) + (cell->right_edge_.destination_cell_ == nullptr) + (cell->top_edge_.destination_cell_ == nullptr) + (cell->bottom_edge_.destination_cell_ == nullptr);
+				sum += closed_walls * 255 / 4;
+			}
+			else
+			{
+				sum += source[static_cast<std::size_t>(sy) * source_width + sx];
+			}
+
+			++count;
+		}
+	}
+
+	return static_cast<std::uint8_t>(sum / count);
+}
+
+void Maze::BuildLevelOfDetail(std::size_t level)
+{
+	MAZE_TRACE_ZONE("build level of detail");
+
+	if (lod_dirty_)
+	{
+		lod_levels_.clear();
+		lod_dirty_blocks_.clear();
+		lod_dirty_ = false;
+	}
+
+	/* Changed blocks are recomputed level by level, each mapped to the block containing it on the next level. */
+	for (std::size_t dirty_level = 1; dirty_level < lod_levels_.size() && !lod_dirty_blocks_.empty(); ++dirty_level)
+	{
+		const int block = 1 << dirty_level;
+		const std::size_t width = (cells_width_ + block - 1) / block;
+		const std::size_t next_width = (width + 1) / 2;
+
+		std::sort(lod_dirty_blocks_.begin(), lod_dirty_blocks_.end());
+		lod_dirty_blocks_.erase(std::unique(lod_dirty_blocks_.begin(), lod_dirty_blocks_.end()), lod_dirty_blocks_.end());
+
+		for (std::size_t& index : lod_dirty_blocks_)
 		{
-			const int index = y * cells_width_ + x;
+			lod_levels_[dirty_level][index] = GetBlockDensity(dirty_level, static_cast<int>(index % width), static_cast<int>(index / width));
+			index = (index / width / 2) * next_width + (index % width) / 2;
+		}
+	}
+
+	lod_dirty_blocks_.clear();
+
+	/* Level 0 is the board itself and is never stored. */
+	if (lod_levels_.empty())
+	{
+		lod_levels_.emplace_back();
+	}
 
-			board_[index].rect_.x = x * cell_size_;
-			board_[index].rect_.y = y * cell_size_;
-			board_[index].rect_.w = cell_size_;
-			board_[index].rect_.h = board_[index].rect_.w;
+	while (lod_levels_.size() <= level)
+	{
+		const std::size_t next_level = lod_levels_.size();
+		const int block = 1 << next_level;
+		const int width = (cells_width_ + block - 1) / block;
+		const int height = (cells_height_ + block - 1) / block;
 
-			board_[index].left_edge_.destination_cell_ = nullptr;
-			board_[index].left_edge_.weight_ = 0;
-			board_[index].right_edge_.destination_cell_ = nullptr;
-			board_[index].right_edge_.weight_ = 0;
-			board_[index].top_edge_.destination_cell_ = nullptr;
-			board_[index].top_edge_.weight_ = 0;
-			board_[index].bottom_edge_.destination_cell_ = nullptr;
-			board_[index].bottom_edge_.weight_ = 0;
+		std::vector<std::uint8_t> densities(static_cast<std::size_t>(width) * height);
+		lod_levels_.push_back(std::move(densities));
 
-			board_[index].visited_ = false;
-			board_[index].seen_ = false;
-			board_[index].weight_ = 0;
+		for (int y = 0; y < height; ++y)
+		{
+			for (int x = 0; x < width; ++x)
+			{
+				lod_levels_[next_level][static_cast<std::size_t>(y) * width + x] = GetBlockDensity(next_level, x, y);
+			}
 		}
 	}
-	
-	bfs_cells_predecessors_.clear();
-	std::fill(bfs_cells_distances_.begin(), bfs_cells_distances_.end(), 0);
-	start_cell_ = nullptr;
-	end_cell_ = nullptr;
-	shortest_path_found_ = false;
 }
 
-void Maze::GenerateEdgesWeights()
+void Maze::RenderLevelOfDetail(std::size_t level)
 {
+	BuildLevelOfDetail(level);
+
+	constexpr std::size_t shade_count = 16;
+	const int block = 1 << level;
+	const int blocks_width = (cells_width_ + block - 1) / block;
+	const std::vector<std::uint8_t>& densities = lod_levels_[level];
+
+	const BlockRange range = GetVisibleBlockRange(block);
+
+	render_lod_rects_.resize(shade_count);
 
-}
+	for (std::vector<SDL_Rect>& rects : render_lod_rects_)
+	{
+		rects.clear();
+	}
 
-void Maze::SetCellSize(std::size_t new_size)
-{
-	constexpr std::size_t max_size = 128;
-	constexpr std::size_t min_size = 32;
-	
-	if (constants::screen_width % new_size != 0 || constants::screen_height % new_size != 0 || new_size > max_size || new_size < min_size)
+	for (int y = range.first_y_; y <= range.last_y_; ++y)
 	{
-		return;
+		for (int x = range.first_x_; x <= range.last_x_; ++x)
+		{
+			const int cells_x = std::min(block, cells_width_ - x * block);
+			const int cells_y = std::min(block, cells_height_ - y * block);
+			const SDL_Rect world_rect = { x * block * cell_size_, y * block * cell_size_, cells_x * cell_size_, cells_y * cell_size_ };
+			const std::uint8_t density = densities[static_cast<std::size_t>(y) * blocks_width + x];
+
+			render_lod_rects_[density * shade_count / 256].push_back(camera_.WorldToScreen(world_rect));
+		}
 	}
 
-	cell_size_ = new_size;
-	cells_width_ = constants::screen_width / cell_size_;
-	cells_height_ = constants::screen_height / cell_size_;
+	/* One batched fill per shade: denser walls are drawn darker. */
+	for (std::size_t shade = 0; shade < shade_count; ++shade)
+	{
+		const std::vector<SDL_Rect>& rects = render_lod_rects_[shade];
 
-	board_.resize(cells_width_ * cells_height_);
-	ResetBoard();
+		if (rects.empty())
+		{
+			continue;
+		}
+
+		const Uint8 colour = static_cast<Uint8>(255 - (shade * 256 + 128) / shade_count);
+		SDL_SetRenderDrawColor(game_->renderer_, colour, colour, colour, 0xff);
+		SDL_RenderFillRects(game_->renderer_, rects.data(), static_cast<int>(rects.size()));
+	}
 }
 
 void Maze::RenderCells()
 {
-	SDL_SetRenderDrawColor(game_->renderer_, 0xff, 0xff, 0xff, 0xff);
-	
-	constexpr int padding = 1;
+	MAZE_TRACE_ZONE("render cells");
 
-	for (const Cell& cell : board_)
+	/* Below this many screen pixels per cell, blocks of cells are drawn by wall density instead. */
+	constexpr double lod_min_block_pixels = 4.0;
+
+	/* Cells the software rasterizer draws: a wall and a floor pixel at least, and too many of them for a rect each. */
+	constexpr double raster_min_cell_pixels = 2.0;
+	constexpr double raster_max_cell_pixels = 8.0;
+
+	const double cell_pixels = cell_size_ * camera_.GetZoom();
+	std::size_t lod_level = 0;
+
+	while (cell_pixels * (1 << lod_level) < lod_min_block_pixels && (1 << lod_level) < std::max(cells_width_, cells_height_))
 	{
-		if (&cell == start_cell_)
-		{
-			SDL_SetRenderDrawColor(game_->renderer_, 0x00, 0xff, 0x00, 0xff);
-		}
-		else if (&cell == end_cell_)
+		++lod_level;
+	}
+
+	if (software_rendering_ && cell_pixels >= raster_min_cell_pixels && cell_pixels < raster_max_cell_pixels && RenderRasterized())
+	{
+		for (const Cell* cell : { start_cell_, end_cell_ })
 		{
-			SDL_SetRenderDrawColor(game_->renderer_, 0xff, 0x00, 0x00, 0xff);
+			if (cell != nullptr)
+			{
+				const SDL_Rect rect = camera_.WorldToScreen(cell->rect_);
+				SDL_SetRenderDrawColor(game_->renderer_, (cell == start_cell_) ? 0x00 : 0xff, (cell == start_cell_) ? 0xff : 0x00, 0x00, 0xff);
+				SDL_RenderFillRect(game_->renderer_, &rect);
+			}
 		}
-		
-		SDL_RenderFillRect(game_->renderer_, &cell.rect_);
-		SDL_SetRenderDrawColor(game_->renderer_, 0x00, 0x00, 0x00, 0xff);
+	}
+	else if (lod_level > 0)
+	{
+		RenderLevelOfDetail(lod_level);
+	}
+	else
+	{
+		const int padding = std::max(1, static_cast<int>(camera_.GetZoom()));
 
-		SDL_Rect wall;
+		const BlockRange range = GetVisibleBlockRange(1);
 
-		if (cell.left_edge_.destination_cell_ == nullptr)
-		{
-			wall = cell.rect_;
-			wall.w = padding;
-			SDL_RenderFillRect(game_->renderer_, &wall);
-		}
+		render_floor_rects_.clear();
+		render_wall_rects_.clear();
 
-		if (cell.right_edge_.destination_cell_ == nullptr)
+		for (int y = range.first_y_; y <= range.last_y_; ++y)
 		{
-			wall = cell.rect_;
-			wall.x = cell.rect_.x + cell.rect_.w - padding;
-			SDL_RenderFillRect(game_->renderer_, &wall);
+			for (int x = range.first_x_; x <= range.last_x_; ++x)
+			{
+				const Cell* cell_pointer = GetCellAt(x, y);
+
+				if (cell_pointer == nullptr)
+				{
+					continue;
+				}
+
+				const Cell& cell = *cell_pointer;
+				const SDL_Rect rect = camera_.WorldToScreen(cell.rect_);
+				SDL_Rect wall;
+
+				render_floor_rects_.push_back(rect);
+
+				if (cell.left_edge_.destination_cell_ == nullptr)
+				{
+					wall = rect;
+					wall.w = padding;
+					render_wall_rects_.push_back(wall);
+				}
+
+				if (cell.right_edge_.destination_cell_ == nullptr)
+				{
+					wall = rect;
+					wall.x = rect.x + rect.w - padding;
+					wall.w = padding;
+					render_wall_rects_.push_back(wall);
+				}
+
+				if (cell.top_edge_.destination_cell_ == nullptr)
+				{
+					wall = rect;
+					wall.h = padding;
+					render_wall_rects_.push_back(wall);
+				}
+
+				if (cell.bottom_edge_.destination_cell_ == nullptr)
+				{
+					wall = rect;
+					wall.y = rect.y + rect.h - padding;
+					wall.h = padding;
+					render_wall_rects_.push_back(wall);
+				}
+			}
 		}
 
-		if (cell.top_edge_.destination_cell_ == nullptr)
+		SDL_SetRenderDrawColor(game_->renderer_, 0xff, 0xff, 0xff, 0xff);
+		SDL_RenderFillRects(game_->renderer_, render_floor_rects_.data(), static_cast<int>(render_floor_rects_.size()));
+
+		if (start_cell_ != nullptr)
 		{
-			wall = cell.rect_;
-			wall.h = padding;
-			SDL_RenderFillRect(game_->renderer_, &wall);
+			const SDL_Rect rect = camera_.WorldToScreen(start_cell_->rect_);
+			SDL_SetRenderDrawColor(game_->renderer_, 0x00, 0xff, 0x00, 0xff);
+			SDL_RenderFillRect(game_->renderer_, &rect);
 		}
 
-		if (cell.bottom_edge_.destination_cell_ == nullptr)
+		if (end_cell_ != nullptr)
 		{
-			wall = cell.rect_;
-			wall.y = cell.rect_.y + cell.rect_.h - padding;
-			SDL_RenderFillRect(game_->renderer_, &wall);
+			const SDL_Rect rect = camera_.WorldToScreen(end_cell_->rect_);
+			SDL_SetRenderDrawColor(game_->renderer_, 0xff, 0x00, 0x00, 0xff);
+			SDL_RenderFillRect(game_->renderer_, &rect);
 		}
 
-		SDL_SetRenderDrawColor(game_->renderer_, 0xff, 0xff, 0xff, 0xff);
+		SDL_SetRenderDrawColor(game_->renderer_, 0x00, 0x00, 0x00, 0xff);
+		SDL_RenderFillRects(game_->renderer_, render_wall_rects_.data(), static_cast<int>(render_wall_rects_.size()));
 	}
 
-	SDL_SetRenderDrawColor(game_->renderer_, 0xff, 0x00, 0x00, 0xff);
-
-	if (shortest_path_found_)
+	if (IsGenerating())
 	{
-		SDL_SetRenderDrawColor(game_->renderer_, 0x00, 0x00, 0xff, 0xff);
-		const double offset = (cell_size_ / 2);
-
-		Cell* current = end_cell_;
+		Cell* head_cell = generation_current_cell_;
 
-		while (current != start_cell_)
+		if (head_cell == nullptr && !generation_cells_.empty())
 		{
-			const std::size_t current_index = GetCellIndex(*current);
-
-			if (bfs_cells_predecessors_[current_index] == nullptr)
-			{
-				break;
-			}
+			head_cell = generation_cells_.back();
+		}
+		else if (head_cell == nullptr && generation_algorithm_ == GenerationAlgorithm::HuntAndKill && generation_hunt_index_ < board_.size())
+		{
+			head_cell = &board_[generation_hunt_index_];
+		}
 
-			SDL_RenderDrawLine(game_->renderer_, board_[current_index].rect_.x + offset, board_[current_index].rect_.y + offset, bfs_cells_predecessors_[current_index]->rect_.x + offset, bfs_cells_predecessors_[current_index]->rect_.y + offset);
-			current = bfs_cells_predecessors_[current_index];
+		if (head_cell != nullptr)
+		{
+			const SDL_Rect rect = camera_.WorldToScreen(head_cell->rect_);
+			SDL_SetRenderDrawColor(game_->renderer_, 0xff, 0xa0, 0x00, 0xff);
+			SDL_RenderFillRect(game_->renderer_, &rect);
 		}
 	}
 
+	RenderPath();
+
 	// for (Cell& cell : board_)
 	// {
 	// 	const double offset = (cell_size_ / 2);
@@ -814,6 +2682,116 @@ void Maze::RenderCells()
 	// }
 }
 
+void Maze::MarkRowsChanged(int first_row, int last_row)
+{
+	raster_first_changed_row_ = std::min(raster_first_changed_row_, std::max(first_row, 0));
+	raster_last_changed_row_ = std::max(raster_last_changed_row_, std::min(last_row, cells_height_ - 1));
+}
+
+bool Maze::RenderRasterized()
+{
+	if (software_rasterizer_ == nullptr)
+	{
+		if (worker_pool_ == nullptr)
+		{
+			software_rendering_ = false;
+			return false;
+		}
+
+		software_rasterizer_ = std::make_unique<SoftwareRasterizer>(*worker_pool_);
+
+		if (!software_rasterizer_->Initialize(game_->renderer_, camera_.GetViewWidth(), camera_.GetViewHeight()))
+		{
+			/* Stay with the renderer backends from now on. */
+			software_rasterizer_.reset();
+			software_rendering_ = false;
+			return false;
+		}
+	}
+
+	if (software_rasterizer_->Resize(cells_width_, cells_height_))
+	{
+		raster_first_changed_row_ = 0;
+		raster_last_changed_row_ = cells_height_ - 1;
+	}
+
+	if (raster_first_changed_row_ <= raster_last_changed_row_)
+	{
+		software_rasterizer_->UpdateRows(raster_first_changed_row_, raster_last_changed_row_, [this](int row, const SoftwareRasterizer::RowWalls& walls)
+			{
+				for (int x = 0; x < cells_width_; ++x)
+				{
+					const Cell* const cell = GetCellAt(x, row);
+					const std::uint64_t bit = std::uint64_t(1) << (x & 63);
+
+					if (cell == nullptr)
+					{
+						walls.outside_[x >> 6] |= bit;
+						continue;
+					}
+
+					if (cell->left_edge_.destination_cell_ == nullptr)
+					{
+						walls.left_[x >> 6] |= bit;
+					}
+
+					if (cell->top_edge_.destination_cell_ == nullptr)
+					{
+						walls.top_[x >> 6] |= bit;
+					}
+				}
+			});
+
+		raster_first_changed_row_ = std::numeric_limits<int>::max();
+		raster_last_changed_row_ = -1;
+	}
+
+	software_rasterizer_->Render(game_->renderer_, { camera_.ScreenToWorldX(0), camera_.ScreenToWorldY(0), camera_.GetZoom(), cell_size_ });
+
+	return true;
+}
+
+void Maze::BuildPathPoints()
+{
+	/* The predecessors lead from the end back to the start, so the points are filled in from the back. */
+	std::size_t point_count = 0;
+
+	for (const Cell* cell = end_cell_; cell != nullptr; cell = (cell == start_cell_) ? nullptr : bfs_cells_predecessors_[GetCellIndex(*cell)])
+	{
+		++point_count;
+	}
+
+	/* Reserved for the longest possible path once, so later solves never reallocate. */
+	const int offset = cell_size_ / 2;
+	path_points_.reserve(board_.size());
+	path_points_.resize(point_count);
+
+	for (const Cell* cell = end_cell_; cell != nullptr; cell = (cell == start_cell_) ? nullptr : bfs_cells_predecessors_[GetCellIndex(*cell)])
+	{
+		path_points_[--point_count] = { cell->rect_.x + offset, cell->rect_.y + offset };
+	}
+}
+
+void Maze::RenderPath()
+{
+	if (!shortest_path_found_ || path_revealed_points_ < 2)
+	{
+		return;
+	}
+
+	MAZE_TRACE_ZONE("render path");
+
+	render_path_points_.resize(path_revealed_points_);
+
+	for (std::size_t i = 0; i < path_revealed_points_; ++i)
+	{
+		render_path_points_[i] = { camera_.WorldToScreenX(path_points_[i].x), camera_.WorldToScreenY(path_points_[i].y) };
+	}
+
+	SDL_SetRenderDrawColor(game_->renderer_, 0x00, 0x00, 0xff, 0xff);
+	SDL_RenderDrawLines(game_->renderer_, render_path_points_.data(), static_cast<int>(render_path_points_.size()));
+}
+
 void Maze::PrintDistancesAndPredecessors()
 {
 	for (std::size_t i = 0; i < bfs_cells_distances_.size(); ++i)
@@ -846,29 +2824,30 @@ void Maze::PrintDistancesAndPredecessors()
 	}
 }
 
-std::vector<Cell*> Maze::GetConnectedNeighborCells(const Cell& current_cell)
+CellNeighbors Maze::GetConnectedNeighborCells(const Cell& current_cell)
 {
+	MAZE_STATS_COUNT(stats_, neighbor_lookups_);
 	return { current_cell.left_edge_.destination_cell_, current_cell.right_edge_.destination_cell_, current_cell.top_edge_.destination_cell_, current_cell.bottom_edge_.destination_cell_ };
 }
 
 int Maze::GetNeighborIndex(const Cell& current_cell, const Cell& neighbor_cell)
 {
-	std::size_t current_index = GetCellIndex(current_cell);
-	std::size_t neighbor_index = GetCellIndex(neighbor_cell);
+	const int dx = (neighbor_cell.rect_.x - current_cell.rect_.x) / cell_size_;
+	const int dy = (neighbor_cell.rect_.y - current_cell.rect_.y) / cell_size_;
 
-	if (neighbor_index + 1 == current_index)
+	if (dx == -1 && dy == 0)
 	{
 		return 0;
 	}
-	else if (neighbor_index - 1 == current_index)
+	else if (dx == 1 && dy == 0)
 	{
 		return 1;
 	}
-	else if (neighbor_index + cells_width_ == current_index)
+	else if (dx == 0 && dy == -1)
 	{
 		return 2;
 	}
-	else if (neighbor_index - cells_width_ == current_index)
+	else if (dx == 0 && dy == 1)
 	{
 		return 3;
 	}
@@ -876,16 +2855,19 @@ int Maze::GetNeighborIndex(const Cell& current_cell, const Cell& neighbor_cell)
 	return -1;
 }
 
-std::vector<Cell*> Maze::GetNeighborCells(std::size_t cell_index)
+CellNeighbors Maze::GetNeighborCells(std::size_t cell_index)
 {
+	MAZE_STATS_COUNT(stats_, neighbor_lookups_);
 	return { GetLeftNeighbor(cell_index), GetRightNeighbor(cell_index), GetTopNeighbor(cell_index), GetBottomNeighbor(cell_index) };
 }
 
 Cell* Maze::GetLeftNeighbor(std::size_t cell_index)
 {
-	if ((board_[cell_index].rect_.x - cell_size_) >= 0)
+	const SDL_Rect& rect = board_[cell_index].rect_;
+
+	if ((rect.x - cell_size_) >= 0)
 	{
-		return &board_[cell_index - 1];
+		return GetCellAt(rect.x / cell_size_ - 1, rect.y / cell_size_);
 	}
 
 	return nullptr;
@@ -893,9 +2875,11 @@ Cell* Maze::GetLeftNeighbor(std::size_t cell_index)
 	
 Cell* Maze::GetRightNeighbor(std::size_t cell_index)
 {
-	if ((board_[cell_index].rect_.x + cell_size_) < constants::screen_width)
+	const SDL_Rect& rect = board_[cell_index].rect_;
+
+	if ((rect.x + cell_size_) < cells_width_ * cell_size_)
 	{
-		return &board_[cell_index + 1];
+		return GetCellAt(rect.x / cell_size_ + 1, rect.y / cell_size_);
 	}
 	
 	return nullptr;
@@ -903,9 +2887,11 @@ Cell* Maze::GetRightNeighbor(std::size_t cell_index)
 
 Cell* Maze::GetTopNeighbor(std::size_t cell_index)
 {
-	if ((board_[cell_index].rect_.y - cell_size_) >= 0)
+	const SDL_Rect& rect = board_[cell_index].rect_;
+
+	if ((rect.y - cell_size_) >= 0)
 	{
-		return &board_[cell_index - cells_width_];
+		return GetCellAt(rect.x / cell_size_, rect.y / cell_size_ - 1);
 	}
 	
 	return nullptr;
@@ -913,9 +2899,11 @@ Cell* Maze::GetTopNeighbor(std::size_t cell_index)
 
 Cell* Maze::GetBottomNeighbor(std::size_t cell_index)
 {
-	if ((board_[cell_index].rect_.y + cell_size_) < constants::screen_height)
+	const SDL_Rect& rect = board_[cell_index].rect_;
+
+	if ((rect.y + cell_size_) < cells_height_ * cell_size_)
 	{
-		return &board_[cell_index + cells_width_];
+		return GetCellAt(rect.x / cell_size_, rect.y / cell_size_ + 1);
 	}
 
 	return nullptr;
@@ -923,65 +2911,223 @@ Cell* Maze::GetBottomNeighbor(std::size_t cell_index)
 
 void Maze::TestRecursiveBacktracker()
 {
-    for (std::size_t i = 0; i < test_loops_; ++i)
-    {
-        GenerateMazeRecursiveBacktracker();
-                        
-        if (DetectCycleDepthFirstSearch(nullptr))
-        {
-            printf("%s\n" ,"Cycle detected in recursive backtracker algorithm!");
-        }
-    }
+	TestGenerator(GenerationAlgorithm::RecursiveBacktracker);
 }
     
 void Maze::TestHuntAndKill()
 {
-    for (std::size_t i = 0; i < test_loops_; ++i)
-    {
-        GenerateMazeHuntAndKill();
-                        
-        if (DetectCycleDepthFirstSearch(nullptr))
-        {
-            printf("%s\n" ,"Cycle detected in hunt and kill algorithm!");
-        }
-    }
+	TestGenerator(GenerationAlgorithm::HuntAndKill);
 }
 
 void Maze::TestWilsons()
 {
-    for (std::size_t i = 0; i < test_loops_; ++i)
-    {
-        GenerateMazeWilsons();
-                        
-        if (DetectCycleDepthFirstSearch(nullptr))
-        {
-            printf("%s\n" ,"Cycle detected in Wilson's algorithm!");
-        }
-    }
+	TestGenerator(GenerationAlgorithm::Wilsons);
 }
 
 void Maze::TestRandomizedKruskals()
 {
-    for (std::size_t i = 0; i < test_loops_; ++i)
-    {
-        GenerateMazeRandomizedKruskal();
-                        
-        if (DetectCycleDepthFirstSearch(nullptr))
-        {
-            printf("%s\n" ,"Cycle detected in randomized Kruskal's algorithm!");
-        }
-    }
+	TestGenerator(GenerationAlgorithm::RandomizedKruskal);
 }
 
 void Maze::TestPrimSimplified()
 {
-    for (std::size_t i = 0; i < test_loops_; ++i)
-    {
-        GenerateMazePrimSimplified();
-                        
-        if (DetectCycleDepthFirstSearch(nullptr))
-        {
-            printf("%s\n" ,"Cycle detected in Prim's simplified algorithm!");
-        }
-    }
-}
\ No newline at end of file
+	TestGenerator(GenerationAlgorithm::PrimSimplified);
+}
+
+void Maze::TestGenerator(GenerationAlgorithm algorithm)
+{
+	/*
+	 * The first iteration warms up the reusable buffers; every later one must generate and solve without touching the heap.
+	 * Allocations are only counted in instrumented builds, where a batch that allocates is reported and stopped.
+	 */
+	constexpr std::size_t warm_up_loops = 1;
+	MAZE_TRACE_THREAD_NAME(GetAlgorithmName(algorithm));
+
+	for (std::size_t i = 0; i < test_loops_ && !IsCancelled(); ++i)
+	{
+		MAZE_TRACE_ZONE("test loop");
+		const std::uint64_t allocations = MAZE_STATS_HEAP_ALLOCATIONS();
+
+		GenerateMaze(algorithm, NextSeed());
+
+		if (DetectCycleDepthFirstSearch(nullptr))
+		{
+			printf("Cycle detected in %s\n", GetAlgorithmName(algorithm));
+		}
+
+		start_cell_ = &board_.front();
+		end_cell_ = &board_.back();
+
+		if (!FindShortestPathBetweenStartEnd())
+		{
+			printf("No path between the corners in %s\n", GetAlgorithmName(algorithm));
+		}
+
+		BreadthFirstSearch(start_cell_);
+
+		if (i >= warm_up_loops && MAZE_STATS_HEAP_ALLOCATIONS() != allocations && !IsCancelled())
+		{
+			printf("Heap allocation after warm-up in %s, stopping the batch\n", GetAlgorithmName(algorithm));
+			return;
+		}
+	}
+}
+
+void Maze::SetCancelFlag(const std::atomic<bool>* cancel_flag)
+{
+	cancel_flag_ = cancel_flag;
+}
+
+void Maze::SetWorkerPool(WorkerPool* worker_pool)
+{
+	worker_pool_ = worker_pool;
+}
+
+bool Maze::IsCancelled() const
+{
+	return cancel_flag_ != nullptr && cancel_flag_->load(std::memory_order_relaxed);
+}
+
+void Maze::StartBackgroundJob(GenerationAlgorithm algorithm, std::function<void(Maze& back_maze)> work)
+{
+	/* An animated generation would keep changing the board the job reads. */
+	if (IsGenerating())
+	{
+		ResetBoard();
+	}
+
+	if (background_worker_ == nullptr)
+	{
+		back_maze_ = std::make_unique<Maze>();
+		background_worker_ = std::make_unique<BackgroundWorker>();
+	}
+
+	background_algorithm_ = algorithm;
+
+	Maze* const back_maze = back_maze_.get();
+
+	background_worker_->Submit([back_maze, work](const std::atomic<bool>& cancelled)
+		{
+			back_maze->SetCancelFlag(&cancelled);
+			work(*back_maze);
+			back_maze->SetCancelFlag(nullptr);
+		});
+}
+
+void Maze::StartBackgroundSolve()
+{
+	/* The tree is rooted at the previous start cell; carving before the solve lands has to rebuild it. */
+	shortest_path_found_ = false;
+	path_tree_complete_ = false;
+
+	if (start_cell_ == nullptr || end_cell_ == nullptr)
+	{
+		/* A solve still in flight would bring back the cell that was just deselected. */
+		CancelBackgroundJob();
+		return;
+	}
+
+	const std::size_t start_index = GetCellIndex(*start_cell_);
+	const std::size_t end_index = GetCellIndex(*end_cell_);
+
+	StartBackgroundJob(GenerationAlgorithm::None, [this, start_index, end_index](Maze& back_maze)
+		{
+			back_maze.CopyLayout(*this);
+			back_maze.CopyWalls(*this);
+			back_maze.SetStartEndCells(start_index, end_index);
+		});
+}
+
+void Maze::CancelBackgroundJob()
+{
+	if (background_worker_ != nullptr)
+	{
+		background_worker_->Cancel();
+	}
+
+	background_algorithm_ = GenerationAlgorithm::None;
+}
+
+void Maze::SetWindowTitle(GenerationAlgorithm algorithm, std::uint32_t seed)
+{
+	if (game_ == nullptr)
+	{
+		return;
+	}
+
+	const std::string new_title = std::string(constants::game_title) + " - " + GetAlgorithmName(algorithm) + " Seed: " + std::to_string(seed);
+	SDL_SetWindowTitle(game_->window_, new_title.c_str());
+}
+
+void Maze::CopyLayout(const Maze& other)
+{
+	if (cell_size_ == other.cell_size_ && cells_width_ == other.cells_width_ && cells_height_ == other.cells_height_ && 
+		mask_path_ == other.mask_path_ && board_.size() == other.board_.size())
+	{
+		return;
+	}
+
+	cell_size_ = other.cell_size_;
+	cells_width_ = other.cells_width_;
+	cells_height_ = other.cells_height_;
+	mask_path_ = other.mask_path_;
+
+	BuildBoard();
+}
+
+void Maze::CopyWalls(const Maze& other)
+{
+	const Cell* const other_board = other.board_.data();
+
+	const auto copy_edge = [this, other_board](CellEdge& edge, const CellEdge& other_edge)
+	{
+		edge.destination_cell_ = (other_edge.destination_cell_ == nullptr) ? nullptr : &board_[other_edge.destination_cell_ - other_board];
+		edge.weight_ = other_edge.weight_;
+	};
+
+	for (std::size_t index = 0; index < board_.size(); ++index)
+	{
+		const Cell& other_cell = other.board_[index];
+		Cell& cell = board_[index];
+
+		copy_edge(cell.left_edge_, other_cell.left_edge_);
+		copy_edge(cell.right_edge_, other_cell.right_edge_);
+		copy_edge(cell.top_edge_, other_cell.top_edge_);
+		copy_edge(cell.bottom_edge_, other_cell.bottom_edge_);
+	}
+
+	performance_.algorithm_ = other.performance_.algorithm_;
+	performance_.generated_cells_ = other.performance_.generated_cells_;
+	performance_.generation_seconds_ = other.performance_.generation_seconds_;
+}
+
+void Maze::SwapBoards(Maze& other, bool generated)
+{
+	/* Swapping the vectors keeps every cell at its address, so the edge and path pointers stay valid. */
+	MAZE_TRACE_ZONE("swap boards");
+	board_.swap(other.board_);
+	cell_lookup_.swap(other.cell_lookup_);
+	bfs_cells_predecessors_.swap(other.bfs_cells_predecessors_);
+	bfs_cells_distances_.swap(other.bfs_cells_distances_);
+	std::swap(start_cell_, other.start_cell_);
+	std::swap(end_cell_, other.end_cell_);
+	std::swap(shortest_path_found_, other.shortest_path_found_);
+	std::swap(path_tree_complete_, other.path_tree_complete_);
+	path_points_.swap(other.path_points_);
+	std::swap(path_revealed_points_, other.path_revealed_points_);
+
+	/* A board that was only solved still is the maze of this seed; the other maze's seed is left over from an older job. */
+	if (generated)
+	{
+		std::swap(seed_, other.seed_);
+	}
+
+	std::swap(performance_, other.performance_);
+
+	custom_maze_current_cell_ = nullptr;
+	other.custom_maze_current_cell_ = nullptr;
+	lod_dirty_ = true;
+	other.lod_dirty_ = true;
+	MarkRowsChanged(0, cells_height_ - 1);
+	other.MarkRowsChanged(0, other.cells_height_ - 1);
+}
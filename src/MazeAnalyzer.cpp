@@ -0,0 +1,65 @@
+#include "MazeAnalyzer.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+
+namespace
+{
+	double Ratio(std::uint64_t numerator, std::uint64_t denominator)
+	{
+		return (denominator == 0) ? 0.0 : static_cast<double>(numerator) / denominator;
+	}
+} // namespace
+
+void MazeStatistics::Merge(const MazeStatistics& other)
+{
+	maze_count_ += other.maze_count_;
+	cell_count_ += other.cell_count_;
+	dead_ends_ += other.dead_ends_;
+	junctions_ += other.junctions_;
+	branches_ += other.branches_;
+	branching_cells_ += other.branching_cells_;
+	corridor_cells_ += other.corridor_cells_;
+	turns_ += other.turns_;
+	dead_end_branches_ += other.dead_end_branches_;
+	dead_end_branch_cells_ += other.dead_end_branch_cells_;
+	diameter_sum_ += other.diameter_sum_;
+	diameter_max_ = std::max(diameter_max_, other.diameter_max_);
+	solution_length_sum_ += other.solution_length_sum_;
+	unsolved_ += other.unsolved_;
+
+	for (std::size_t i = 0; i < corridor_histogram_size; ++i)
+	{
+		corridor_lengths_[i] += other.corridor_lengths_[i];
+	}
+}
+
+void MazeStatistics::Print() const
+{
+	/* River factor: average number of cells from the last junction to a dead end; long, winding dead ends score high. */
+	printf("  dead ends: %.2f%% of cells, junctions: %.2f%% of cells, branching factor: %.3f\n", 
+		100.0 * Ratio(dead_ends_, cell_count_), 100.0 * Ratio(junctions_, cell_count_), Ratio(branches_, branching_cells_));
+	printf("  turn rate: %.3f, river factor: %.3f\n", Ratio(turns_, corridor_cells_), Ratio(dead_end_branch_cells_, dead_end_branches_));
+	printf("  diameter: mean %.1f, max %llu, solution length: mean %.1f", 
+		Ratio(diameter_sum_, maze_count_), static_cast<unsigned long long>(diameter_max_), Ratio(solution_length_sum_, maze_count_ - unsolved_));
+
+	if (unsolved_ != 0)
+	{
+		printf(" (%llu mazes without a solution)", static_cast<unsigned long long>(unsolved_));
+	}
+
+	printf("\n  corridor lengths:");
+
+	const std::uint64_t corridor_count = std::max<std::uint64_t>(maze_count_, 1);
+
+	for (std::size_t i = 0; i < corridor_histogram_size; ++i)
+	{
+		if (corridor_lengths_[i] != 0)
+		{
+			printf(" %zu%s: %.2f", i + 1, (i + 1 == corridor_histogram_size) ? "+" : "", static_cast<double>(corridor_lengths_[i]) / corridor_count);
+		}
+	}
+
+	printf(" (per maze)\n");
+}
@@ -0,0 +1,858 @@
+#include "MazeArchive.hpp"
+#include "PackedWalls.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+	constexpr char magic[4] = { 'M', 'Z', 'A', 'R' };
+	constexpr std::uint32_t version = 1;
+	constexpr std::size_t header_size = 40;
+	constexpr std::size_t index_entry_size = 16;
+
+	/* Blocks of a window per thread, enough to even out blocks that take longer than others. */
+	constexpr std::size_t window_blocks_per_thread = 4;
+
+	constexpr int probability_bits = 12;
+	constexpr std::uint16_t probability_half = 1 << (probability_bits - 1);
+	constexpr int adaptation_shift = 5;
+	constexpr std::uint32_t range_top = 1u << 24;
+
+	/* Six facts known before each bit is coded, see CodeWalls. */
+	constexpr std::size_t context_count = 64;
+
+	void StoreLittleEndian(std::uint8_t* destination, std::uint64_t value, int bytes)
+	{
+		for (int i = 0; i < bytes; ++i)
+		{
+			destination[i] = static_cast<std::uint8_t>(value >> (8 * i));
+		}
+	}
+
+	std::uint64_t LoadLittleEndian(const std::uint8_t* source, int bytes)
+	{
+		std::uint64_t value = 0;
+
+		for (int i = 0; i < bytes; ++i)
+		{
+			value |= static_cast<std::uint64_t>(source[i]) << (8 * i);
+		}
+
+		return value;
+	}
+
+	std::size_t GetWallsSize(int width, int height)
+	{
+		return packed_walls::GetSize(static_cast<std::size_t>(width) * height);
+	}
+
+	/*
+	 * Probabilities, in 1/4096ths, that the passage to the right and to the bottom is closed, for every context,
+	 * and the connected parts of the maze coded so far: a union-find forest over the cells, where every root counts
+	 * the passages from the previous row into cells not coded yet and remembers the last row it continued down in.
+	 */
+	struct WallModel
+	{
+		std::array<std::uint16_t, context_count> right_;
+		std::array<std::uint16_t, context_count> bottom_;
+
+		std::vector<std::uint32_t> parents_;
+		std::vector<std::uint32_t> pending_entries_;
+		std::vector<int> down_rows_;
+
+		void Reset()
+		{
+			right_.fill(probability_half);
+			bottom_.fill(probability_half);
+		}
+
+		void ResetComponents(std::size_t cell_count)
+		{
+			parents_.resize(cell_count);
+			pending_entries_.assign(cell_count, 0);
+			down_rows_.assign(cell_count, -1);
+
+			for (std::size_t cell = 0; cell < cell_count; ++cell)
+			{
+				parents_[cell] = static_cast<std::uint32_t>(cell);
+			}
+		}
+
+		std::uint32_t Find(std::size_t cell)
+		{
+			while (parents_[cell] != cell)
+			{
+				parents_[cell] = parents_[parents_[cell]];
+				cell = parents_[cell];
+			}
+
+			return static_cast<std::uint32_t>(cell);
+		}
+
+		void Unite(std::size_t first_cell, std::size_t second_cell)
+		{
+			const std::uint32_t root = Find(first_cell);
+			const std::uint32_t other_root = Find(second_cell);
+
+			if (root != other_root)
+			{
+				parents_[other_root] = root;
+				pending_entries_[root] += pending_entries_[other_root];
+				down_rows_[root] = std::max(down_rows_[root], down_rows_[other_root]);
+			}
+		}
+	};
+
+	/* Binary range coder with carry propagation through a cached byte, as in LZMA. */
+	class RangeEncoder
+	{
+	private:
+		std::uint64_t low_;
+		std::uint32_t range_;
+		std::uint8_t cache_;
+		std::uint64_t cache_size_;
+
+		void ShiftLow()
+		{
+			if (static_cast<std::uint32_t>(low_) < 0xff000000u || (low_ >> 32) != 0)
+			{
+				const std::uint8_t carry = static_cast<std::uint8_t>(low_ >> 32);
+				std::uint8_t byte = cache_;
+
+				do
+				{
+					bytes_.push_back(static_cast<std::uint8_t>(byte + carry));
+					byte = 0xff;
+				} while (--cache_size_ != 0);
+
+				cache_ = static_cast<std::uint8_t>(low_ >> 24);
+			}
+
+			++cache_size_;
+			low_ = (low_ & 0x00ffffff) << 8;
+		}
+
+	public:
+		static constexpr bool decoding = false;
+
+		std::vector<std::uint8_t> bytes_;
+
+		void Reset()
+		{
+			low_ = 0;
+			range_ = 0xffffffffu;
+			cache_ = 0;
+			cache_size_ = 1;
+			bytes_.clear();
+		}
+
+		int Code(std::uint16_t& probability, int bit)
+		{
+			const std::uint32_t bound = (range_ >> probability_bits) * probability;
+
+			if (bit == 0)
+			{
+				range_ = bound;
+				probability += ((1 << probability_bits) - probability) >> adaptation_shift;
+			}
+			else
+			{
+				low_ += bound;
+				range_ -= bound;
+				probability -= probability >> adaptation_shift;
+			}
+
+			while (range_ < range_top)
+			{
+				range_ <<= 8;
+				ShiftLow();
+			}
+
+			return bit;
+		}
+
+		void Finish()
+		{
+			for (int i = 0; i < 5; ++i)
+			{
+				ShiftLow();
+			}
+		}
+	};
+
+	class RangeDecoder
+	{
+	private:
+		const std::uint8_t* next_;
+		const std::uint8_t* end_;
+		std::uint32_t code_;
+		std::uint32_t range_;
+
+		/* A truncated block reads as zeros; Code never runs past the end. */
+		std::uint8_t NextByte()
+		{
+			return (next_ < end_) ? *next_++ : 0;
+		}
+
+	public:
+		static constexpr bool decoding = true;
+
+		RangeDecoder(const std::uint8_t* begin, const std::uint8_t* end) :
+			next_(begin),
+			end_(end),
+			code_(0),
+			range_(0xffffffffu)
+		{
+			for (int i = 0; i < 5; ++i)
+			{
+				code_ = (code_ << 8) | NextByte();
+			}
+		}
+
+		int Code(std::uint16_t& probability, int)
+		{
+			const std::uint32_t bound = (range_ >> probability_bits) * probability;
+			int bit;
+
+			if (code_ < bound)
+			{
+				range_ = bound;
+				probability += ((1 << probability_bits) - probability) >> adaptation_shift;
+				bit = 0;
+			}
+			else
+			{
+				code_ -= bound;
+				range_ -= bound;
+				probability -= probability >> adaptation_shift;
+				bit = 1;
+			}
+
+			while (range_ < range_top)
+			{
+				range_ <<= 8;
+				code_ = (code_ << 8) | NextByte();
+			}
+
+			return bit;
+		}
+	};
+
+	/*
+	 * Codes the right and bottom passage of every cell in row-major order; the passages on the border are always
+	 * closed and not coded. Each bit is predicted from what is already known around it: the cell's left and top
+	 * passages, the left neighbor's bottom one and the right neighbor's top one, which tell corridors from turns,
+	 * and two facts about the parts of the maze coded so far. Opening the right passage closes a loop when the
+	 * right neighbor is already connected to the cell from above; and a part of the maze that cannot go right
+	 * any more, has not gone down in this row yet and enters no cell further right has to go down here or be cut
+	 * off. Perfect mazes never do the former and always do the latter, so these bits cost next to nothing.
+	 * Decoding fills walls, which must start out zeroed.
+	 */
+	template <typename Coder>
+	void CodeWalls(Coder& coder, WallModel& model, int width, int height, std::uint8_t* walls)
+	{
+		model.ResetComponents(static_cast<std::size_t>(width) * height);
+
+		for (int y = 0; y < height; ++y)
+		{
+			const std::size_t row = static_cast<std::size_t>(y) * width;
+
+			for (int x = 0; y > 0 && x < width; ++x)
+			{
+				if ((packed_walls::GetPassages(walls, row - width + x) >> 1) != 0)
+				{
+					++model.pending_entries_[model.Find(row - width + x)];
+				}
+			}
+
+			for (int x = 0; x < width; ++x)
+			{
+				const std::size_t cell = row + x;
+				const int passages = Coder::decoding ? 0 : packed_walls::GetPassages(walls, cell);
+				const int left_open = (x > 0) ? (packed_walls::GetPassages(walls, cell - 1) & 1) : 0;
+				const int left_bottom_open = (x > 0) ? (packed_walls::GetPassages(walls, cell - 1) >> 1) : 0;
+				const int top_open = (y > 0) ? (packed_walls::GetPassages(walls, cell - width) >> 1) : 0;
+				const int right_top_open = (y > 0 && x + 1 < width) ? (packed_walls::GetPassages(walls, cell - width + 1) >> 1) : 0;
+				const int shared_context = left_open | (top_open << 1) | (left_bottom_open << 2) | (right_top_open << 3);
+				int right_open = 0;
+				int bottom_open = 0;
+
+				if (top_open != 0)
+				{
+					--model.pending_entries_[model.Find(cell - width)];
+					model.Unite(cell - width, cell);
+				}
+
+				if (x + 1 < width)
+				{
+					const int closes_loop = (right_top_open != 0 && model.Find(cell) == model.Find(cell - width + 1));
+					right_open = coder.Code(model.right_[shared_context | (closes_loop << 4)], passages & 1);
+
+					if (right_open != 0)
+					{
+						model.Unite(cell, cell + 1);
+					}
+				}
+
+				if (y + 1 < height)
+				{
+					const std::uint32_t root = model.Find(cell);
+					const int last_chance = (right_open == 0 && model.down_rows_[root] != y && model.pending_entries_[root] == 0);
+					bottom_open = coder.Code(model.bottom_[shared_context | (right_open << 4) | (last_chance << 5)], passages >> 1);
+
+					if (bottom_open != 0)
+					{
+						model.down_rows_[root] = y;
+					}
+				}
+
+				if constexpr (Coder::decoding)
+				{
+					packed_walls::AddPassages(walls, cell, (right_open != 0 ? packed_walls::right_open : 0) | (bottom_open != 0 ? packed_walls::bottom_open : 0));
+				}
+			}
+		}
+	}
+
+	void AppendVarint(std::vector<std::uint8_t>& bytes, std::uint64_t value)
+	{
+		while (value >= 0x80)
+		{
+			bytes.push_back(static_cast<std::uint8_t>(value | 0x80));
+			value >>= 7;
+		}
+
+		bytes.push_back(static_cast<std::uint8_t>(value));
+	}
+
+	bool ReadVarint(const std::uint8_t*& next, const std::uint8_t* end, std::uint64_t& value)
+	{
+		value = 0;
+
+		for (int shift = 0; shift < 64 && next < end; shift += 7)
+		{
+			const std::uint8_t byte = *next++;
+			value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+
+			if ((byte & 0x80) == 0)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	/* Reads the ids at the start of a block and leaves next at its coded walls. */
+	bool ReadBlockIds(const std::uint8_t*& next, const std::uint8_t* end, std::uint64_t first_id, std::size_t maze_count, std::vector<std::uint64_t>& ids)
+	{
+		ids.resize(maze_count);
+		ids[0] = first_id;
+
+		for (std::size_t i = 1; i < maze_count; ++i)
+		{
+			std::uint64_t difference;
+
+			if (!ReadVarint(next, end, difference) || difference == 0)
+			{
+				return false;
+			}
+
+			ids[i] = ids[i - 1] + difference;
+		}
+
+		return true;
+	}
+} // namespace
+
+/* One block being filled: its ids, and the walls coded so far with the model they have trained. */
+struct MazeArchiveWriter::BlockEncoder
+{
+	WallModel model_;
+	RangeEncoder encoder_;
+	std::vector<std::uint8_t> ids_;
+	std::uint64_t first_id_;
+	std::uint64_t last_id_;
+	std::size_t maze_count_;
+	bool valid_;
+
+	void Reset()
+	{
+		model_.Reset();
+		encoder_.Reset();
+		ids_.clear();
+		first_id_ = 0;
+		last_id_ = 0;
+		maze_count_ = 0;
+		valid_ = true;
+	}
+
+	void Add(std::uint64_t id, std::vector<std::uint8_t>& walls, int width, int height)
+	{
+		if (walls.size() < GetWallsSize(width, height) || (maze_count_ != 0 && id <= last_id_))
+		{
+			valid_ = false;
+			return;
+		}
+
+		if (maze_count_ == 0)
+		{
+			first_id_ = id;
+		}
+		else
+		{
+			AppendVarint(ids_, id - last_id_);
+		}
+
+		last_id_ = id;
+		++maze_count_;
+
+		CodeWalls(encoder_, model_, width, height, walls.data());
+	}
+};
+
+MazeArchiveWriter::MazeArchiveWriter(WorkerPool& pool) :
+	pool_(pool),
+	file_(nullptr),
+	width_(0),
+	height_(0),
+	algorithm_(0),
+	block_size_(0),
+	maze_count_(0),
+	offset_(0),
+	failed_(false),
+	last_id_(0),
+	open_block_mazes_(0)
+{
+
+}
+
+MazeArchiveWriter::~MazeArchiveWriter()
+{
+	if (file_ != nullptr)
+	{
+		std::fclose(file_);
+	}
+}
+
+bool MazeArchiveWriter::Open(const std::string& path, int width, int height, std::uint32_t algorithm, std::uint32_t block_size)
+{
+	if (file_ != nullptr || width <= 0 || height <= 0 || block_size == 0)
+	{
+		return false;
+	}
+
+	file_ = std::fopen(path.c_str(), "wb");
+
+	if (file_ == nullptr)
+	{
+		printf("Could not open %s for writing!\n", path.c_str());
+		return false;
+	}
+
+	path_ = path;
+	width_ = width;
+	height_ = height;
+	algorithm_ = algorithm;
+	block_size_ = block_size;
+	maze_count_ = 0;
+	failed_ = false;
+	block_offsets_.clear();
+	block_first_ids_.clear();
+	last_id_ = 0;
+	open_block_mazes_ = 0;
+
+	encoders_.resize(pool_.GetThreadCount() * window_blocks_per_thread);
+	thread_walls_.resize(pool_.GetThreadCount());
+
+	for (BlockEncoder& encoder : encoders_)
+	{
+		encoder.Reset();
+	}
+
+	/* The header is written by Close, once the counts and the index offset are known. */
+	const std::uint8_t header[header_size] = {};
+	offset_ = header_size;
+
+	if (std::fwrite(header, 1, header_size, file_) != header_size)
+	{
+		printf("Could not write to %s!\n", path_.c_str());
+		failed_ = true;
+	}
+
+	return !failed_;
+}
+
+bool MazeArchiveWriter::WriteBlock(BlockEncoder& encoder)
+{
+	if (!encoder.valid_ || (!block_offsets_.empty() && encoder.first_id_ <= last_id_))
+	{
+		printf("%s\n", "Maze ids of an archive must increase and every maze must have all its walls!");
+		failed_ = true;
+		return false;
+	}
+
+	encoder.encoder_.Finish();
+
+	const std::vector<std::uint8_t>& coded = encoder.encoder_.bytes_;
+
+	if (std::fwrite(encoder.ids_.data(), 1, encoder.ids_.size(), file_) != encoder.ids_.size() ||
+		std::fwrite(coded.data(), 1, coded.size(), file_) != coded.size())
+	{
+		printf("Could not write to %s!\n", path_.c_str());
+		failed_ = true;
+		return false;
+	}
+
+	block_offsets_.push_back(offset_);
+	block_first_ids_.push_back(encoder.first_id_);
+	offset_ += encoder.ids_.size() + coded.size();
+	last_id_ = encoder.last_id_;
+	maze_count_ += encoder.maze_count_;
+
+	encoder.Reset();
+
+	return true;
+}
+
+bool MazeArchiveWriter::Append(std::size_t maze_count, const MazeSource& source)
+{
+	if (file_ == nullptr || failed_)
+	{
+		return false;
+	}
+
+	/* The first block of every window continues the open one, if any; the blocks after it start empty. */
+	for (std::size_t next = 0; next < maze_count;)
+	{
+		const std::size_t first_block_mazes = block_size_ - open_block_mazes_;
+
+		const auto block_begin = [&](std::size_t block)
+		{
+			return (block == 0) ? next : next + first_block_mazes + (block - 1) * block_size_;
+		};
+
+		std::size_t block_count = 0;
+
+		while (block_count < encoders_.size() && block_begin(block_count) < maze_count)
+		{
+			++block_count;
+		}
+
+		pool_.ParallelFor(block_count, [&](std::size_t block, int thread_index)
+			{
+				const std::size_t end = std::min(block_begin(block) + ((block == 0) ? first_block_mazes : block_size_), maze_count);
+				std::vector<std::uint8_t>& walls = thread_walls_[thread_index];
+
+				for (std::size_t i = block_begin(block); i < end; ++i)
+				{
+					const std::uint64_t id = source(i, walls, thread_index);
+					encoders_[block].Add(id, walls, width_, height_);
+				}
+			});
+
+		next = std::min(block_begin(block_count), maze_count);
+		open_block_mazes_ = 0;
+
+		for (std::size_t block = 0; block < block_count; ++block)
+		{
+			if (encoders_[block].maze_count_ < block_size_)
+			{
+				/* Only the last block can fall short; it stays open in the first slot. */
+				std::swap(encoders_[0], encoders_[block]);
+				open_block_mazes_ = encoders_[0].maze_count_;
+			}
+			else if (!WriteBlock(encoders_[block]))
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+bool MazeArchiveWriter::Close()
+{
+	if (file_ == nullptr)
+	{
+		return false;
+	}
+
+	if (open_block_mazes_ != 0 && !failed_)
+	{
+		WriteBlock(encoders_[0]);
+		open_block_mazes_ = 0;
+	}
+
+	std::vector<std::uint8_t> index(block_offsets_.size() * index_entry_size);
+
+	for (std::size_t block = 0; block < block_offsets_.size(); ++block)
+	{
+		StoreLittleEndian(&index[block * index_entry_size], block_offsets_[block], 8);
+		StoreLittleEndian(&index[block * index_entry_size + 8], block_first_ids_[block], 8);
+	}
+
+	std::uint8_t header[header_size];
+	std::memcpy(header, magic, sizeof(magic));
+	StoreLittleEndian(header + 4, version, 4);
+	StoreLittleEndian(header + 8, static_cast<std::uint32_t>(width_), 4);
+	StoreLittleEndian(header + 12, static_cast<std::uint32_t>(height_), 4);
+	StoreLittleEndian(header + 16, block_size_, 4);
+	StoreLittleEndian(header + 20, algorithm_, 4);
+	StoreLittleEndian(header + 24, maze_count_, 8);
+	StoreLittleEndian(header + 32, offset_, 8);
+
+	if (!failed_ && (std::fwrite(index.data(), 1, index.size(), file_) != index.size() || std::fseek(file_, 0, SEEK_SET) != 0 ||
+		std::fwrite(header, 1, header_size, file_) != header_size))
+	{
+		printf("Could not write to %s!\n", path_.c_str());
+		failed_ = true;
+	}
+
+	offset_ += index.size();
+
+	const bool closed = (std::fclose(file_) == 0);
+	file_ = nullptr;
+
+	return closed && !failed_;
+}
+
+std::uint64_t MazeArchiveWriter::GetMazeCount() const
+{
+	return maze_count_ + open_block_mazes_;
+}
+
+std::uint64_t MazeArchiveWriter::GetSize() const
+{
+	return offset_;
+}
+
+MazeArchiveReader::MazeArchiveReader(WorkerPool& pool) :
+	pool_(pool),
+	file_(nullptr),
+	width_(0),
+	height_(0),
+	algorithm_(0),
+	block_size_(0),
+	maze_count_(0),
+	index_offset_(0),
+	thread_walls_(pool_.GetThreadCount()),
+	thread_ids_(pool_.GetThreadCount())
+{
+
+}
+
+MazeArchiveReader::~MazeArchiveReader()
+{
+	if (file_ != nullptr)
+	{
+		std::fclose(file_);
+	}
+}
+
+bool MazeArchiveReader::Open(const std::string& path)
+{
+	if (file_ != nullptr)
+	{
+		return false;
+	}
+
+	file_ = std::fopen(path.c_str(), "rb");
+
+	if (file_ == nullptr)
+	{
+		printf("Could not open %s!\n", path.c_str());
+		return false;
+	}
+
+	const auto reject = [this, &path](const char* problem)
+	{
+		printf("%s %s!\n", path.c_str(), problem);
+		std::fclose(file_);
+		file_ = nullptr;
+		return false;
+	};
+
+	std::uint8_t header[header_size];
+
+	if (std::fread(header, 1, header_size, file_) != header_size || std::memcmp(header, magic, sizeof(magic)) != 0 || LoadLittleEndian(header + 4, 4) != version)
+	{
+		return reject("is not a maze archive");
+	}
+
+	width_ = static_cast<int>(LoadLittleEndian(header + 8, 4));
+	height_ = static_cast<int>(LoadLittleEndian(header + 12, 4));
+	block_size_ = static_cast<std::uint32_t>(LoadLittleEndian(header + 16, 4));
+	algorithm_ = static_cast<std::uint32_t>(LoadLittleEndian(header + 20, 4));
+	maze_count_ = LoadLittleEndian(header + 24, 8);
+	index_offset_ = LoadLittleEndian(header + 32, 8);
+
+	const std::size_t block_count = (block_size_ == 0) ? 0 : static_cast<std::size_t>((maze_count_ + block_size_ - 1) / block_size_);
+	std::vector<std::uint8_t> index(block_count * index_entry_size);
+
+	if (width_ <= 0 || height_ <= 0 || block_size_ == 0 || std::fseek(file_, static_cast<long>(index_offset_), SEEK_SET) != 0 ||
+		std::fread(index.data(), 1, index.size(), file_) != index.size())
+	{
+		return reject("is damaged");
+	}
+
+	block_offsets_.resize(block_count);
+	block_first_ids_.resize(block_count);
+
+	for (std::size_t block = 0; block < block_count; ++block)
+	{
+		block_offsets_[block] = LoadLittleEndian(&index[block * index_entry_size], 8);
+		block_first_ids_[block] = LoadLittleEndian(&index[block * index_entry_size + 8], 8);
+
+		const std::uint64_t previous_offset = (block == 0) ? header_size : block_offsets_[block - 1];
+
+		if (block_offsets_[block] < previous_offset || block_offsets_[block] > index_offset_ || (block != 0 && block_first_ids_[block] <= block_first_ids_[block - 1]))
+		{
+			return reject("is damaged");
+		}
+	}
+
+	return true;
+}
+
+int MazeArchiveReader::GetWidth() const
+{
+	return width_;
+}
+
+int MazeArchiveReader::GetHeight() const
+{
+	return height_;
+}
+
+std::uint32_t MazeArchiveReader::GetAlgorithm() const
+{
+	return algorithm_;
+}
+
+std::uint64_t MazeArchiveReader::GetMazeCount() const
+{
+	return maze_count_;
+}
+
+std::size_t MazeArchiveReader::GetBlockCount() const
+{
+	return block_offsets_.size();
+}
+
+std::size_t MazeArchiveReader::GetBlockMazeCount(std::size_t block) const
+{
+	return static_cast<std::size_t>(std::min<std::uint64_t>(block_size_, maze_count_ - static_cast<std::uint64_t>(block) * block_size_));
+}
+
+bool MazeArchiveReader::ReadBlocks(std::size_t first_block, std::size_t block_count)
+{
+	const std::uint64_t begin = block_offsets_[first_block];
+	const std::uint64_t end = (first_block + block_count < block_offsets_.size()) ? block_offsets_[first_block + block_count] : index_offset_;
+
+	read_buffer_.resize(static_cast<std::size_t>(end - begin));
+
+	return std::fseek(file_, static_cast<long>(begin), SEEK_SET) == 0 && std::fread(read_buffer_.data(), 1, read_buffer_.size(), file_) == read_buffer_.size();
+}
+
+bool MazeArchiveReader::ReadMaze(std::uint64_t id, std::vector<std::uint8_t>& walls)
+{
+	if (file_ == nullptr || block_first_ids_.empty() || id < block_first_ids_[0])
+	{
+		return false;
+	}
+
+	const std::size_t block = (std::upper_bound(block_first_ids_.begin(), block_first_ids_.end(), id) - block_first_ids_.begin()) - 1;
+
+	if (!ReadBlocks(block, 1))
+	{
+		return false;
+	}
+
+	const std::uint8_t* next = read_buffer_.data();
+	const std::uint8_t* const end = next + read_buffer_.size();
+	std::vector<std::uint64_t>& ids = thread_ids_[0];
+
+	if (!ReadBlockIds(next, end, block_first_ids_[block], GetBlockMazeCount(block), ids))
+	{
+		return false;
+	}
+
+	const auto found = std::lower_bound(ids.begin(), ids.end(), id);
+
+	if (found == ids.end() || *found != id)
+	{
+		return false;
+	}
+
+	/* The model adapts from maze to maze, so the ones before it in the block are decoded as well. */
+	RangeDecoder decoder(next, end);
+	WallModel model;
+	model.Reset();
+
+	for (auto maze = ids.begin(); maze <= found; ++maze)
+	{
+		walls.assign(GetWallsSize(width_, height_), 0);
+		CodeWalls(decoder, model, width_, height_, walls.data());
+	}
+
+	return true;
+}
+
+bool MazeArchiveReader::ReadAll(const MazeVisitor& visit)
+{
+	if (file_ == nullptr)
+	{
+		return false;
+	}
+
+	const std::size_t window = static_cast<std::size_t>(pool_.GetThreadCount()) * window_blocks_per_thread;
+	std::atomic<bool> damaged(false);
+
+	for (std::size_t first_block = 0; first_block < block_offsets_.size(); first_block += window)
+	{
+		const std::size_t block_count = std::min(window, block_offsets_.size() - first_block);
+
+		if (!ReadBlocks(first_block, block_count))
+		{
+			return false;
+		}
+
+		pool_.ParallelFor(block_count, [&](std::size_t window_block, int thread_index)
+			{
+				const std::size_t block = first_block + window_block;
+				const std::uint64_t block_end = (block + 1 < block_offsets_.size()) ? block_offsets_[block + 1] : index_offset_;
+				const std::uint8_t* next = read_buffer_.data() + (block_offsets_[block] - block_offsets_[first_block]);
+				const std::uint8_t* const end = read_buffer_.data() + (block_end - block_offsets_[first_block]);
+				std::vector<std::uint64_t>& ids = thread_ids_[thread_index];
+				std::vector<std::uint8_t>& walls = thread_walls_[thread_index];
+
+				if (!ReadBlockIds(next, end, block_first_ids_[block], GetBlockMazeCount(block), ids))
+				{
+					damaged.store(true, std::memory_order_relaxed);
+					return;
+				}
+
+				RangeDecoder decoder(next, end);
+				WallModel model;
+				model.Reset();
+
+				for (const std::uint64_t id : ids)
+				{
+					walls.assign(GetWallsSize(width_, height_), 0);
+					CodeWalls(decoder, model, width_, height_, walls.data());
+					visit(id, walls, thread_index);
+				}
+			});
+	}
+
+	return !damaged.load();
+}
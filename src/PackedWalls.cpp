@@ -0,0 +1,31 @@
+#include "PackedWalls.hpp"
+#include "Fingerprint.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace packed_walls
+{
+	std::uint64_t Hash(int cells_width, int cells_height, const std::uint8_t* walls)
+	{
+		const auto passages = [&](int x, int y)
+		{
+			return GetPassages(walls, static_cast<std::size_t>(y) * cells_width + x);
+		};
+
+		return fingerprint::HashWalls(cells_width, cells_height, 0, [&](int x, int y, int direction)
+			{
+				switch (direction)
+				{
+				case 0:
+					return x > 0 && (passages(x - 1, y) & right_open) != 0;
+				case 1:
+					return (passages(x, y) & right_open) != 0;
+				case 2:
+					return y > 0 && (passages(x, y - 1) & bottom_open) != 0;
+				default:
+					return (passages(x, y) & bottom_open) != 0;
+				}
+			});
+	}
+} // namespace packed_walls
@@ -0,0 +1,194 @@
+#include "PngWriter.hpp"
+
+#include <zlib.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+	constexpr std::size_t output_buffer_size = 1 << 16;
+	constexpr std::uint8_t filter_up = 2;
+
+	void StoreBigEndian(std::uint8_t* destination, std::uint32_t value)
+	{
+		destination[0] = static_cast<std::uint8_t>(value >> 24);
+		destination[1] = static_cast<std::uint8_t>(value >> 16);
+		destination[2] = static_cast<std::uint8_t>(value >> 8);
+		destination[3] = static_cast<std::uint8_t>(value);
+	}
+} // namespace
+
+PngWriter::PngWriter() : 
+	file_(nullptr), 
+	stream_(), 
+	stream_initialized_(false), 
+	width_(0), 
+	height_(0), 
+	rows_written_(0)
+{
+}
+
+PngWriter::~PngWriter()
+{
+	if (stream_initialized_)
+	{
+		deflateEnd(&stream_);
+	}
+
+	if (file_ != nullptr)
+	{
+		std::fclose(file_);
+	}
+}
+
+bool PngWriter::Open(const std::string& path, int width, int height)
+{
+	if (file_ != nullptr || width <= 0 || height <= 0)
+	{
+		return false;
+	}
+
+	file_ = std::fopen(path.c_str(), "wb");
+
+	if (file_ == nullptr)
+	{
+		printf("Could not open %s for writing!\n", path.c_str());
+		return false;
+	}
+
+	width_ = width;
+	height_ = height;
+	rows_written_ = 0;
+
+	const std::size_t row_size = static_cast<std::size_t>(width_) * 3;
+	previous_row_.assign(row_size, 0);
+	filtered_row_.assign(row_size + 1, 0);
+	output_buffer_.resize(output_buffer_size);
+
+	stream_ = z_stream();
+
+	if (deflateInit(&stream_, Z_DEFAULT_COMPRESSION) != Z_OK)
+	{
+		return false;
+	}
+
+	stream_initialized_ = true;
+
+	constexpr std::uint8_t signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+
+	if (std::fwrite(signature, 1, sizeof(signature), file_) != sizeof(signature))
+	{
+		return false;
+	}
+
+	/* 8-bit truecolour, no interlacing. */
+	std::uint8_t header[13] = {};
+	StoreBigEndian(header, static_cast<std::uint32_t>(width_));
+	StoreBigEndian(header + 4, static_cast<std::uint32_t>(height_));
+	header[8] = 8;
+	header[9] = 2;
+
+	return WriteChunk("IHDR", header, sizeof(header));
+}
+
+bool PngWriter::WriteRow(const std::uint8_t* rgb_row)
+{
+	if (!stream_initialized_ || rows_written_ == height_)
+	{
+		return false;
+	}
+
+	/* The "up" filter turns repeated rows, which maze images are mostly made of, into runs of zeros. */
+	filtered_row_[0] = filter_up;
+
+	for (std::size_t i = 0; i < previous_row_.size(); ++i)
+	{
+		filtered_row_[i + 1] = static_cast<std::uint8_t>(rgb_row[i] - previous_row_[i]);
+	}
+
+	std::memcpy(previous_row_.data(), rgb_row, previous_row_.size());
+	++rows_written_;
+
+	stream_.next_in = filtered_row_.data();
+	stream_.avail_in = static_cast<uInt>(filtered_row_.size());
+
+	return Deflate(Z_NO_FLUSH);
+}
+
+bool PngWriter::Close()
+{
+	if (!stream_initialized_)
+	{
+		return false;
+	}
+
+	bool success = rows_written_ == height_;
+
+	stream_.next_in = nullptr;
+	stream_.avail_in = 0;
+	success = Deflate(Z_FINISH) && success;
+	success = WriteChunk("IEND", nullptr, 0) && success;
+
+	deflateEnd(&stream_);
+	stream_initialized_ = false;
+
+	success = std::fclose(file_) == 0 && success;
+	file_ = nullptr;
+
+	return success;
+}
+
+bool PngWriter::WriteChunk(const char* type, const std::uint8_t* data, std::size_t size)
+{
+	std::uint8_t length[4];
+	StoreBigEndian(length, static_cast<std::uint32_t>(size));
+
+	uLong crc = crc32(0L, Z_NULL, 0);
+	crc = crc32(crc, reinterpret_cast<const Bytef*>(type), 4);
+
+	if (size != 0)
+	{
+		crc = crc32(crc, data, static_cast<uInt>(size));
+	}
+
+	std::uint8_t crc_bytes[4];
+	StoreBigEndian(crc_bytes, static_cast<std::uint32_t>(crc));
+
+	return std::fwrite(length, 1, 4, file_) == 4 
+		&& std::fwrite(type, 1, 4, file_) == 4 
+		&& (size == 0 || std::fwrite(data, 1, size, file_) == size) 
+		&& std::fwrite(crc_bytes, 1, 4, file_) == 4;
+}
+
+bool PngWriter::Deflate(int flush)
+{
+	/* Every time the output buffer fills up it is emitted as its own IDAT chunk. */
+	while (true)
+	{
+		stream_.next_out = output_buffer_.data();
+		stream_.avail_out = static_cast<uInt>(output_buffer_.size());
+
+		const int result = deflate(&stream_, flush);
+
+		if (result == Z_STREAM_ERROR)
+		{
+			return false;
+		}
+
+		const std::size_t produced = output_buffer_.size() - stream_.avail_out;
+
+		if (produced != 0 && !WriteChunk("IDAT", output_buffer_.data(), produced))
+		{
+			return false;
+		}
+
+		if (flush == Z_FINISH ? result == Z_STREAM_END : (stream_.avail_out != 0 && stream_.avail_in == 0))
+		{
+			return true;
+		}
+	}
+}
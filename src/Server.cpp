@@ -0,0 +1,912 @@
+#include "Server.hpp"
+#include "Maze.hpp"
+#include "GridMaze.hpp"
+#include "MazeAnalyzer.hpp"
+#include "PackedWalls.hpp"
+#include "Timer.hpp"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	volatile std::sig_atomic_t stop_requested = 0;
+
+	void RequestStop(int)
+	{
+		stop_requested = 1;
+	}
+
+	std::uint64_t MicrosecondsSince(Clock::time_point start)
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+	}
+
+	bool ReadFully(int fd, void* data, std::size_t size)
+	{
+		std::uint8_t* destination = static_cast<std::uint8_t*>(data);
+
+		while (size > 0)
+		{
+			const ssize_t received = read(fd, destination, size);
+
+			if (received < 0 && errno == EINTR)
+			{
+				continue;
+			}
+
+			if (received <= 0)
+			{
+				return false;
+			}
+
+			destination += received;
+			size -= received;
+		}
+
+		return true;
+	}
+
+	/* Moves the pieces past the first sent bytes. */
+	void AdvancePieces(iovec*& pieces, int& piece_count, std::size_t sent)
+	{
+		while (piece_count > 0 && sent >= pieces->iov_len)
+		{
+			sent -= pieces->iov_len;
+			++pieces;
+			--piece_count;
+		}
+
+		if (piece_count > 0)
+		{
+			pieces->iov_base = static_cast<std::uint8_t*>(pieces->iov_base) + sent;
+			pieces->iov_len -= sent;
+		}
+	}
+
+	/* Gathers all pieces straight from where they live, without copying them into one buffer first. */
+	bool SendFully(int fd, iovec* pieces, int piece_count)
+	{
+		while (piece_count > 0)
+		{
+			msghdr message = {};
+			message.msg_iov = pieces;
+			message.msg_iovlen = piece_count;
+
+			const ssize_t sent = sendmsg(fd, &message, MSG_NOSIGNAL);
+
+			if (sent < 0 && errno == EINTR)
+			{
+				continue;
+			}
+
+			if (sent < 0)
+			{
+				return false;
+			}
+
+			AdvancePieces(pieces, piece_count, static_cast<std::size_t>(sent));
+		}
+
+		return true;
+	}
+
+	/* Sends as much as the socket takes without blocking and leaves the pieces at what is left; false when the connection failed. */
+	bool SendAvailable(int fd, iovec*& pieces, int& piece_count)
+	{
+		while (piece_count > 0)
+		{
+			msghdr message = {};
+			message.msg_iov = pieces;
+			message.msg_iovlen = piece_count;
+
+			const ssize_t sent = sendmsg(fd, &message, MSG_NOSIGNAL | MSG_DONTWAIT);
+
+			if (sent < 0 && errno == EINTR)
+			{
+				continue;
+			}
+
+			if (sent < 0)
+			{
+				return errno == EAGAIN || errno == EWOULDBLOCK;
+			}
+
+			AdvancePieces(pieces, piece_count, static_cast<std::size_t>(sent));
+		}
+
+		return true;
+	}
+
+	/* Makes the polling thread return from poll; a full pipe already has a wake-up pending. */
+	void WakePoller(int wake_fd)
+	{
+		const std::uint8_t wake = 1;
+		(void) !write(wake_fd, &wake, 1);
+	}
+
+	struct Connection
+	{
+		/* Requests may arrive split across reads; incomplete ones wait here. */
+		static constexpr std::size_t buffer_requests = 64;
+
+		/* The server stops reading a client's requests while this many bytes of its responses wait to be sent. */
+		static constexpr std::size_t max_pending_output = 1 << 20;
+
+		int fd_;
+		std::array<std::uint8_t, buffer_requests * sizeof(server::Request)> read_buffer_;
+		std::size_t read_size_;
+
+		/* Set by the polling thread once the client sent end-of-file; its queued requests are still answered. */
+		bool read_closed_;
+
+		/*
+		 * Workers send responses without blocking; whatever the socket does not take is appended here, behind earlier
+		 * responses, and sent by the polling thread once the socket is writable. failed_ drops all further output.
+		 */
+		std::mutex write_mutex_;
+		std::vector<std::uint8_t> pending_output_;
+		bool failed_;
+
+		explicit Connection(int fd) : fd_(fd), read_size_(0), read_closed_(false), failed_(false)
+		{
+
+		}
+
+		~Connection()
+		{
+			close(fd_);
+		}
+
+		/* Sends as much of the pending output as the socket takes without blocking. */
+		void SendPendingOutput()
+		{
+			const std::lock_guard<std::mutex> lock(write_mutex_);
+			iovec piece = { pending_output_.data(), pending_output_.size() };
+			iovec* remaining = &piece;
+			int remaining_count = 1;
+
+			if (!failed_ && !SendAvailable(fd_, remaining, remaining_count))
+			{
+				failed_ = true;
+			}
+
+			pending_output_.erase(pending_output_.begin(), pending_output_.end() - (remaining_count > 0 ? piece.iov_len : 0));
+		}
+	};
+
+	struct Job
+	{
+		std::shared_ptr<Connection> connection_;
+		server::Request request_;
+		Clock::time_point received_;
+	};
+
+	class JobQueue
+	{
+	private:
+		std::mutex mutex_;
+		std::condition_variable job_available_;
+		std::deque<Job> jobs_;
+		bool closed_;
+
+	public:
+		/* The server stops reading from its clients while this many requests are waiting. */
+		static constexpr std::size_t capacity = 4096;
+
+		JobQueue() : closed_(false)
+		{
+
+		}
+
+		void Push(Job job)
+		{
+			{
+				const std::lock_guard<std::mutex> lock(mutex_);
+				jobs_.push_back(std::move(job));
+			}
+
+			job_available_.notify_one();
+		}
+
+		/* Blocks until a job is available; returns false once the queue is closed and drained. was_full tells whether this freed the queue. */
+		bool Pop(Job& job, bool& was_full)
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			job_available_.wait(lock, [this]() { return closed_ || !jobs_.empty(); });
+
+			if (jobs_.empty())
+			{
+				return false;
+			}
+
+			was_full = jobs_.size() >= capacity;
+			job = std::move(jobs_.front());
+			jobs_.pop_front();
+
+			return true;
+		}
+
+		bool IsFull()
+		{
+			const std::lock_guard<std::mutex> lock(mutex_);
+			return jobs_.size() >= capacity;
+		}
+
+		void Close()
+		{
+			{
+				const std::lock_guard<std::mutex> lock(mutex_);
+				closed_ = true;
+			}
+
+			job_available_.notify_all();
+		}
+	};
+
+	/* A generator that stays warm between requests: the board is only rebuilt when the requested size changes. */
+	class Worker
+	{
+	private:
+		std::unique_ptr<Maze> maze_;
+		std::unique_ptr<GridMaze<SquareTopology>> grid_;
+		MazeAnalyzer<SquareTopology> analyzer_;
+		std::uint32_t width_;
+		std::uint32_t height_;
+
+		std::vector<std::uint8_t> walls_;
+		std::vector<std::uint32_t> path_;
+		server::ResponseStatistics statistics_;
+
+		bool Generate(const server::Request& request)
+		{
+			if (request.algorithm_ < static_cast<std::uint8_t>(GenerationAlgorithm::RecursiveBacktracker) ||
+				request.algorithm_ > static_cast<std::uint8_t>(GenerationAlgorithm::PrimWeighted) ||
+				static_cast<std::uint64_t>(request.width_) * request.height_ > server::max_request_cells)
+			{
+				return false;
+			}
+
+			if (request.width_ != width_ || request.height_ != height_)
+			{
+				if (!maze_->SetBoardSize(static_cast<int>(request.width_), static_cast<int>(request.height_)))
+				{
+					return false;
+				}
+
+				width_ = request.width_;
+				height_ = request.height_;
+			}
+
+			maze_->GenerateMaze(static_cast<GenerationAlgorithm>(request.algorithm_), request.seed_);
+			maze_->PackWalls(walls_);
+			path_.clear();
+
+			if (request.flags_ & server::flag_solve)
+			{
+				maze_->SetStartEndCells(0, maze_->GetCellCount() - 1);
+				maze_->GetSolutionPath(path_);
+			}
+
+			if (request.flags_ & server::flag_statistics)
+			{
+				Analyze();
+			}
+
+			return true;
+		}
+
+		void Analyze()
+		{
+			const GridDimensions dimensions = { static_cast<int>(width_), static_cast<int>(height_), 1 };
+
+			if (grid_ == nullptr || grid_->GetDimensions().width_ != dimensions.width_ || grid_->GetDimensions().height_ != dimensions.height_)
+			{
+				grid_ = std::make_unique<GridMaze<SquareTopology>>(dimensions);
+			}
+
+			packed_walls::Unpack(walls_.data(), *grid_);
+
+			MazeStatistics statistics;
+			analyzer_.Analyze(*grid_, statistics);
+
+			statistics_.dead_ends_ = static_cast<std::uint32_t>(statistics.dead_ends_);
+			statistics_.junctions_ = static_cast<std::uint32_t>(statistics.junctions_);
+			statistics_.corridor_cells_ = static_cast<std::uint32_t>(statistics.corridor_cells_);
+			statistics_.turns_ = static_cast<std::uint32_t>(statistics.turns_);
+			statistics_.dead_end_branches_ = static_cast<std::uint32_t>(statistics.dead_end_branches_);
+			statistics_.dead_end_branch_cells_ = static_cast<std::uint32_t>(statistics.dead_end_branch_cells_);
+			statistics_.diameter_ = static_cast<std::uint32_t>(statistics.diameter_sum_);
+			statistics_.solution_length_ = static_cast<std::uint32_t>(statistics.solution_length_sum_);
+		}
+
+	public:
+		Worker() :
+			maze_(std::make_unique<Maze>()),
+			width_(0),
+			height_(0),
+			statistics_()
+		{
+
+		}
+
+		/* Wakes the polling thread through wake_fd when part of the response has to wait for the socket. */
+		void Process(const Job& job, server::LatencyHistogram& latencies, int wake_fd)
+		{
+			const server::Request& request = job.request_;
+			const bool generated = Generate(request);
+
+			server::ResponseHeader header = {};
+			header.request_id_ = request.request_id_;
+			header.status_ = generated ? server::Status::Ok : server::Status::InvalidRequest;
+
+			iovec pieces[4];
+			int piece_count = 0;
+			pieces[piece_count++] = { &header, sizeof(header) };
+
+			if (generated)
+			{
+				header.walls_size_ = static_cast<std::uint32_t>(walls_.size());
+				header.path_size_ = static_cast<std::uint32_t>(path_.size() * sizeof(std::uint32_t));
+				header.statistics_size_ = (request.flags_ & server::flag_statistics) ? sizeof(statistics_) : 0;
+
+				pieces[piece_count++] = { walls_.data(), header.walls_size_ };
+				pieces[piece_count++] = { path_.data(), header.path_size_ };
+				pieces[piece_count++] = { &statistics_, header.statistics_size_ };
+			}
+
+			Connection& connection = *job.connection_;
+			bool queued = false;
+
+			{
+				/* Responses of concurrently processed requests must not interleave on the socket, and none may overtake queued output. */
+				const std::lock_guard<std::mutex> lock(connection.write_mutex_);
+				iovec* remaining = pieces;
+				int remaining_count = piece_count;
+
+				if (!connection.failed_ && connection.pending_output_.empty() && !SendAvailable(connection.fd_, remaining, remaining_count))
+				{
+					connection.failed_ = true;
+				}
+
+				for (int i = 0; i < remaining_count && !connection.failed_; ++i)
+				{
+					const std::uint8_t* const bytes = static_cast<const std::uint8_t*>(remaining[i].iov_base);
+					connection.pending_output_.insert(connection.pending_output_.end(), bytes, bytes + remaining[i].iov_len);
+					queued = true;
+				}
+			}
+
+			if (queued)
+			{
+				WakePoller(wake_fd);
+			}
+
+			latencies.Record(MicrosecondsSince(job.received_));
+		}
+	};
+
+	void PrintLatencies(const char* label, const server::LatencyHistogram& latencies)
+	{
+		printf("%s %llu requests, latency p50 %llu us, p99 %llu us, max %llu us\n", label,
+			static_cast<unsigned long long>(latencies.GetCount()), static_cast<unsigned long long>(latencies.GetPercentile(50.0)),
+			static_cast<unsigned long long>(latencies.GetPercentile(99.0)), static_cast<unsigned long long>(latencies.GetMax()));
+		fflush(stdout);
+	}
+
+	int OpenSocket(const std::string& socket_path, sockaddr_un& address)
+	{
+		if (socket_path.size() >= sizeof(address.sun_path))
+		{
+			printf("Socket path %s is too long!\n", socket_path.c_str());
+			return -1;
+		}
+
+		address = {};
+		address.sun_family = AF_UNIX;
+		std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+
+		const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+		if (fd < 0)
+		{
+			printf("Could not create socket! Error: %s\n", std::strerror(errno));
+		}
+
+		return fd;
+	}
+} // namespace
+
+namespace server
+{
+	LatencyHistogram::LatencyHistogram() :
+		buckets_(),
+		count_(0),
+		max_(0)
+	{
+
+	}
+
+	int LatencyHistogram::GetBucket(std::uint64_t microseconds)
+	{
+		constexpr std::uint64_t sub_buckets = 1 << sub_bucket_bits;
+
+		if (microseconds < sub_buckets)
+		{
+			return static_cast<int>(microseconds);
+		}
+
+		int exponent = sub_bucket_bits;
+
+		while ((microseconds >> exponent) > 1)
+		{
+			++exponent;
+		}
+
+		const std::uint64_t sub_bucket = (microseconds >> (exponent - sub_bucket_bits)) & (sub_buckets - 1);
+
+		return static_cast<int>(((exponent - sub_bucket_bits + 1) << sub_bucket_bits) + sub_bucket);
+	}
+
+	std::uint64_t LatencyHistogram::GetBucketLimit(int bucket)
+	{
+		constexpr int sub_buckets = 1 << sub_bucket_bits;
+
+		if (bucket < sub_buckets)
+		{
+			return static_cast<std::uint64_t>(bucket);
+		}
+
+		const int shift = (bucket >> sub_bucket_bits) - 1;
+		const std::uint64_t lower = static_cast<std::uint64_t>(sub_buckets + (bucket & (sub_buckets - 1))) << shift;
+
+		return lower + (std::uint64_t(1) << shift) - 1;
+	}
+
+	void LatencyHistogram::Record(std::uint64_t microseconds)
+	{
+		buckets_[GetBucket(microseconds)].fetch_add(1, std::memory_order_relaxed);
+		count_.fetch_add(1, std::memory_order_relaxed);
+
+		std::uint64_t max = max_.load(std::memory_order_relaxed);
+
+		while (microseconds > max && !max_.compare_exchange_weak(max, microseconds, std::memory_order_relaxed))
+		{
+
+		}
+	}
+
+	std::uint64_t LatencyHistogram::GetCount() const
+	{
+		return count_.load(std::memory_order_relaxed);
+	}
+
+	std::uint64_t LatencyHistogram::GetMax() const
+	{
+		return max_.load(std::memory_order_relaxed);
+	}
+
+	std::uint64_t LatencyHistogram::GetPercentile(double percentile) const
+	{
+		const double target = percentile / 100.0 * GetCount();
+		std::uint64_t seen = 0;
+
+		for (int bucket = 0; bucket < bucket_count; ++bucket)
+		{
+			seen += buckets_[bucket].load(std::memory_order_relaxed);
+
+			if (seen > 0 && seen >= target)
+			{
+				return std::min(GetBucketLimit(bucket), GetMax());
+			}
+		}
+
+		return GetMax();
+	}
+
+	int Serve(const std::string& socket_path, int worker_count)
+	{
+		sockaddr_un address;
+		const int listen_fd = OpenSocket(socket_path, address);
+
+		if (listen_fd < 0)
+		{
+			return 1;
+		}
+
+		/* A socket file left behind by a previous run would make bind fail. */
+		unlink(socket_path.c_str());
+
+		if (bind(listen_fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || listen(listen_fd, SOMAXCONN) != 0)
+		{
+			printf("Could not listen on %s! Error: %s\n", socket_path.c_str(), std::strerror(errno));
+			close(listen_fd);
+			return 1;
+		}
+
+		std::signal(SIGINT, RequestStop);
+		std::signal(SIGTERM, RequestStop);
+
+		/* Workers write a byte here to make the polling thread watch a socket whose output they had to queue, or read again once the queue has room. */
+		int wake_fds[2];
+
+		if (pipe(wake_fds) != 0 || fcntl(wake_fds[0], F_SETFL, O_NONBLOCK) != 0 || fcntl(wake_fds[1], F_SETFL, O_NONBLOCK) != 0)
+		{
+			printf("Could not create the wake-up pipe! Error: %s\n", std::strerror(errno));
+			close(listen_fd);
+			return 1;
+		}
+
+		JobQueue queue;
+		LatencyHistogram latencies;
+		std::vector<std::thread> workers;
+
+		for (int i = 0; i < worker_count; ++i)
+		{
+			workers.emplace_back([&queue, &latencies, &wake_fds]()
+				{
+					Worker worker;
+					Job job;
+					bool was_full = false;
+
+					while (queue.Pop(job, was_full))
+					{
+						if (was_full)
+						{
+							WakePoller(wake_fds[1]);
+						}
+
+						worker.Process(job, latencies, wake_fds[1]);
+						job = Job();
+					}
+				});
+		}
+
+		printf("Serving on %s with %d workers\n", socket_path.c_str(), worker_count);
+		fflush(stdout);
+
+		/* One thread polls the listening socket and all clients and parses requests; workers send the responses themselves. */
+		std::vector<std::shared_ptr<Connection>> connections;
+		std::vector<pollfd> poll_fds;
+		Timer report_timer;
+		std::uint64_t reported_count = 0;
+
+		while (!stop_requested)
+		{
+			const bool accept_requests = !queue.IsFull();
+
+			poll_fds.assign(1, { listen_fd, POLLIN, 0 });
+			poll_fds.push_back({ wake_fds[0], POLLIN, 0 });
+
+			for (const std::shared_ptr<Connection>& connection : connections)
+			{
+				std::size_t pending_output = 0;
+
+				{
+					const std::lock_guard<std::mutex> lock(connection->write_mutex_);
+					pending_output = connection->pending_output_.size();
+				}
+
+				/*
+				 * While requests are not accepted the client is not polled at all, not even for a hangup, since the requests
+				 * it sent before hanging up still have to be read; end-of-file from read is what closes a connection.
+				 */
+				const short events = static_cast<short>(((accept_requests && !connection->read_closed_ && pending_output < Connection::max_pending_output) ? POLLIN : 0) |
+					((pending_output > 0) ? POLLOUT : 0));
+
+				poll_fds.push_back({ (events != 0) ? connection->fd_ : -1, events, 0 });
+			}
+
+			/* Workers wake the poll once they take a job off a full queue, so waiting for room does not spin. */
+			if (poll(poll_fds.data(), poll_fds.size(), 100) < 0 && errno != EINTR)
+			{
+				printf("Poll failed! Error: %s\n", std::strerror(errno));
+				break;
+			}
+
+			if (poll_fds[1].revents & POLLIN)
+			{
+				std::uint8_t wakes[64];
+
+				while (read(wake_fds[0], wakes, sizeof(wakes)) > 0)
+				{
+
+				}
+			}
+
+			for (std::size_t i = connections.size(); i-- > 0; )
+			{
+				Connection& connection = *connections[i];
+				const pollfd& poll_fd = poll_fds[i + 2];
+
+				if (poll_fd.revents & (POLLOUT | POLLERR))
+				{
+					connection.SendPendingOutput();
+				}
+
+				/* A hangup comes with POLLIN while requests are left unread, so reading until end-of-file loses none of them. */
+				if ((poll_fd.events & POLLIN) && (poll_fd.revents & (POLLIN | POLLHUP | POLLERR)))
+				{
+					const ssize_t received = read(connection.fd_, connection.read_buffer_.data() + connection.read_size_, connection.read_buffer_.size() - connection.read_size_);
+
+					if (received < 0 && errno != EINTR && errno != EAGAIN)
+					{
+						const std::lock_guard<std::mutex> lock(connection.write_mutex_);
+						connection.failed_ = true;
+					}
+					else if (received == 0)
+					{
+						connection.read_closed_ = true;
+					}
+					else if (received > 0)
+					{
+						connection.read_size_ += received;
+
+						const Clock::time_point now = Clock::now();
+						const std::size_t request_count = connection.read_size_ / sizeof(Request);
+
+						for (std::size_t request = 0; request < request_count; ++request)
+						{
+							Job job = { connections[i], {}, now };
+							std::memcpy(&job.request_, connection.read_buffer_.data() + request * sizeof(Request), sizeof(Request));
+							queue.Push(std::move(job));
+						}
+
+						const std::size_t parsed_size = request_count * sizeof(Request);
+						std::memmove(connection.read_buffer_.data(), connection.read_buffer_.data() + parsed_size, connection.read_size_ - parsed_size);
+						connection.read_size_ -= parsed_size;
+					}
+				}
+
+				/* A closed client is dropped once no queued request can produce output for it any more. */
+				bool finished = false;
+
+				{
+					const std::lock_guard<std::mutex> lock(connection.write_mutex_);
+					finished = connection.failed_ || (connection.read_closed_ && connection.pending_output_.empty() && connections[i].use_count() == 1);
+				}
+
+				if (finished)
+				{
+					connections.erase(connections.begin() + i);
+				}
+			}
+
+			if (poll_fds[0].revents & POLLIN)
+			{
+				const int client_fd = accept(listen_fd, nullptr, nullptr);
+
+				if (client_fd >= 0)
+				{
+					connections.push_back(std::make_shared<Connection>(client_fd));
+				}
+			}
+
+			constexpr double report_interval = 10.0;
+
+			if (report_timer.elapsed() >= report_interval)
+			{
+				if (latencies.GetCount() != reported_count)
+				{
+					reported_count = latencies.GetCount();
+					PrintLatencies("Served", latencies);
+				}
+
+				report_timer.reset();
+			}
+		}
+
+		close(listen_fd);
+		unlink(socket_path.c_str());
+		queue.Close();
+
+		for (std::thread& worker : workers)
+		{
+			worker.join();
+		}
+
+		/*
+		 * The queued requests are answered by now; whatever output could not be sent without blocking goes out last, as long
+		 * as the clients take it within the deadline. Output of clients that stopped reading is dropped.
+		 */
+		constexpr double flush_seconds = 1.0;
+		const Timer flush_timer;
+
+		while (flush_timer.elapsed() < flush_seconds)
+		{
+			poll_fds.clear();
+
+			for (const std::shared_ptr<Connection>& connection : connections)
+			{
+				if (!connection->failed_ && !connection->pending_output_.empty())
+				{
+					poll_fds.push_back({ connection->fd_, POLLOUT, 0 });
+				}
+			}
+
+			if (poll_fds.empty())
+			{
+				break;
+			}
+
+			const int timeout_ms = static_cast<int>((flush_seconds - flush_timer.elapsed()) * 1000.0) + 1;
+
+			if (poll(poll_fds.data(), poll_fds.size(), timeout_ms) < 0 && errno != EINTR)
+			{
+				break;
+			}
+
+			for (const std::shared_ptr<Connection>& connection : connections)
+			{
+				if (!connection->failed_ && !connection->pending_output_.empty())
+				{
+					connection->SendPendingOutput();
+				}
+			}
+		}
+
+		connections.clear();
+		close(wake_fds[0]);
+		close(wake_fds[1]);
+
+		PrintLatencies("Shut down after", latencies);
+
+		return 0;
+	}
+
+	int Benchmark(const std::string& socket_path, const Request& request, std::size_t request_count, std::size_t pipeline_depth)
+	{
+		if (request.width_ == 0 || request.height_ == 0 || static_cast<std::uint64_t>(request.width_) * request.height_ > max_request_cells)
+		{
+			printf("Invalid maze size %ux%u, requests need between 1 and %llu cells!\n", request.width_, request.height_, static_cast<unsigned long long>(max_request_cells));
+			return 1;
+		}
+
+		sockaddr_un address;
+		const int fd = OpenSocket(socket_path, address);
+
+		if (fd < 0)
+		{
+			return 1;
+		}
+
+		if (connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+		{
+			printf("Could not connect to %s! Error: %s\n", socket_path.c_str(), std::strerror(errno));
+			close(fd);
+			return 1;
+		}
+
+		std::mutex mutex;
+		std::condition_variable slot_available;
+		std::vector<Clock::time_point> sent_times(request_count);
+		std::size_t in_flight = 0;
+		bool receiving = true;
+
+		/* Sends requests as long as fewer than pipeline_depth are waiting for their response. */
+		std::thread sender([&]()
+			{
+				for (std::size_t i = 0; i < request_count; ++i)
+				{
+					{
+						std::unique_lock<std::mutex> lock(mutex);
+						slot_available.wait(lock, [&]() { return in_flight < pipeline_depth || !receiving; });
+
+						if (!receiving)
+						{
+							return;
+						}
+
+						++in_flight;
+						sent_times[i] = Clock::now();
+					}
+
+					Request next = request;
+					next.request_id_ = static_cast<std::uint32_t>(i);
+					next.seed_ = static_cast<std::uint32_t>(request.seed_ + i);
+					iovec piece = { &next, sizeof(next) };
+
+					if (!SendFully(fd, &piece, 1))
+					{
+						return;
+					}
+				}
+			});
+
+		LatencyHistogram latencies;
+		std::vector<std::uint8_t> payload;
+		std::size_t failed = 0;
+		const std::uint64_t last_cell = static_cast<std::uint64_t>(request.width_) * request.height_ - 1;
+
+		Timer timer;
+
+		for (std::size_t received = 0; received < request_count; ++received)
+		{
+			ResponseHeader header;
+
+			if (!ReadFully(fd, &header, sizeof(header)))
+			{
+				printf("Connection closed after %zu responses!\n", received);
+				break;
+			}
+
+			payload.resize(static_cast<std::size_t>(header.walls_size_) + header.path_size_ + header.statistics_size_);
+
+			if (!ReadFully(fd, payload.data(), payload.size()))
+			{
+				printf("Connection closed after %zu responses!\n", received);
+				break;
+			}
+
+			/* A solved maze's path has to run from the first to the last cell. */
+			bool valid = header.status_ == Status::Ok && header.request_id_ < request_count;
+
+			if (valid && (request.flags_ & flag_solve))
+			{
+				std::uint32_t first = 0;
+				std::uint32_t last = 0;
+				valid = header.path_size_ >= 2 * sizeof(std::uint32_t);
+
+				if (valid)
+				{
+					std::memcpy(&first, payload.data() + header.walls_size_, sizeof(first));
+					std::memcpy(&last, payload.data() + header.walls_size_ + header.path_size_ - sizeof(last), sizeof(last));
+					valid = first == 0 && last == last_cell;
+				}
+			}
+
+			failed += !valid;
+
+			const std::lock_guard<std::mutex> lock(mutex);
+
+			if (header.request_id_ < request_count)
+			{
+				latencies.Record(MicrosecondsSince(sent_times[header.request_id_]));
+			}
+
+			--in_flight;
+			slot_available.notify_one();
+		}
+
+		const double seconds = timer.elapsed();
+
+		{
+			const std::lock_guard<std::mutex> lock(mutex);
+			receiving = false;
+		}
+
+		slot_available.notify_one();
+		shutdown(fd, SHUT_RDWR);
+		sender.join();
+		close(fd);
+
+		printf("%llu responses in %f seconds (%.0f requests/s), %zu failed, pipeline depth %zu\n",
+			static_cast<unsigned long long>(latencies.GetCount()), seconds, latencies.GetCount() / seconds, failed, pipeline_depth);
+		PrintLatencies("Client side:", latencies);
+
+		return (failed == 0 && latencies.GetCount() == request_count) ? 0 : 1;
+	}
+} // namespace server
@@ -0,0 +1,339 @@
+#include "ShardedGeneration.hpp"
+#include "GridMaze.hpp"
+#include "PackedWalls.hpp"
+#include "RandomEngine.hpp"
+#include "Timer.hpp"
+#include "Tracing.hpp"
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+namespace
+{
+	struct Tile
+	{
+		int x_;
+		int y_;
+		int width_;
+		int height_;
+
+		/* Offset of the tile's packed walls in the shared mapping. */
+		std::size_t offset_;
+	};
+
+	/* A pair of neighboring tiles; the seam between them runs along the right or the bottom edge of first_. */
+	struct TileEdge
+	{
+		std::uint64_t weight_;
+		std::size_t first_;
+		std::size_t second_;
+		bool vertical_;
+	};
+
+	/* Every tile is seeded from the maze seed and its index, so the maze does not depend on the number of processes. */
+	void GenerateTiles(const std::vector<Tile>& tiles, const sharding::Options& options, int process_index, int process_count, std::uint8_t* shared_walls)
+	{
+		for (std::size_t index = process_index; index < tiles.size(); index += process_count)
+		{
+			const Tile& tile = tiles[index];
+			GridMaze<SquareTopology, SplitMix64Engine> maze({ tile.width_, tile.height_, 1 });
+
+			maze.Generate(options.algorithm_, static_cast<std::uint32_t>(MixBits(options.seed_ ^ (static_cast<std::uint64_t>(index) << 32))));
+
+			packed_walls::Pack(maze, shared_walls + tile.offset_);
+		}
+	}
+
+	std::uint32_t FindRoot(std::vector<std::uint32_t>& parents, std::uint32_t node)
+	{
+		while (parents[node] != node)
+		{
+			parents[node] = parents[parents[node]];
+			node = parents[node];
+		}
+
+		return node;
+	}
+
+	/* False when both nodes already were in one set. */
+	bool Join(std::vector<std::uint32_t>& parents, std::uint32_t first, std::uint32_t second)
+	{
+		first = FindRoot(parents, first);
+		second = FindRoot(parents, second);
+
+		if (first == second)
+		{
+			return false;
+		}
+
+		parents[std::max(first, second)] = std::min(first, second);
+		return true;
+	}
+} // namespace
+
+namespace sharding
+{
+	bool Generate(const Options& options, std::vector<std::uint8_t>& walls, Report& report)
+	{
+		MAZE_TRACE_ZONE("sharded generation");
+
+		const int tile_columns = (options.width_ + options.tile_width_ - 1) / options.tile_width_;
+		const int tile_rows = (options.height_ + options.tile_height_ - 1) / options.tile_height_;
+
+		std::vector<Tile> tiles;
+		tiles.reserve(static_cast<std::size_t>(tile_columns) * tile_rows);
+		std::size_t shared_size = 0;
+
+		for (int row = 0; row < tile_rows; ++row)
+		{
+			for (int column = 0; column < tile_columns; ++column)
+			{
+				const int x = column * options.tile_width_;
+				const int y = row * options.tile_height_;
+				const Tile tile = { x, y, std::min(options.tile_width_, options.width_ - x), std::min(options.tile_height_, options.height_ - y), shared_size };
+
+				tiles.push_back(tile);
+				shared_size += packed_walls::GetSize(static_cast<std::size_t>(tile.width_) * tile.height_);
+			}
+		}
+
+		report.tile_count_ = tiles.size();
+		report.seam_count_ = 0;
+
+		/* Anonymous shared pages are zeroed, which is the all-walls-closed state the tiles are ORed into. */
+		void* const mapping = mmap(nullptr, shared_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+		if (mapping == MAP_FAILED)
+		{
+			printf("Could not map %zu bytes of shared memory for the tiles: %s\n", shared_size, std::strerror(errno));
+			return false;
+		}
+
+		std::uint8_t* const shared_walls = static_cast<std::uint8_t*>(mapping);
+
+		/* Workers only generate and write their tiles; the coordinator is still single-threaded when it forks. */
+		Timer timer;
+		std::vector<pid_t> workers;
+		bool failed = false;
+
+		const int process_count = static_cast<int>(std::min<std::size_t>(options.process_count_, tiles.size()));
+		report.process_count_ = process_count;
+
+		for (int process_index = 0; process_index < process_count; ++process_index)
+		{
+			const pid_t pid = fork();
+
+			if (pid == 0)
+			{
+				GenerateTiles(tiles, options, process_index, process_count, shared_walls);
+				_exit(0);
+			}
+
+			if (pid < 0)
+			{
+				printf("Could not start worker process %d: %s\n", process_index, std::strerror(errno));
+				failed = true;
+				break;
+			}
+
+			workers.push_back(pid);
+		}
+
+		for (pid_t pid : workers)
+		{
+			int status = 0;
+
+			if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+			{
+				printf("Worker process %d did not finish its tiles!\n", static_cast<int>(pid));
+				failed = true;
+			}
+		}
+
+		report.generation_seconds_ = timer.elapsed();
+
+		if (failed)
+		{
+			munmap(mapping, shared_size);
+			return false;
+		}
+
+		/* Copy every tile into the rows of the whole maze; tile passages never cross the tile's own edges. */
+		timer.reset();
+		walls.assign(packed_walls::GetSize(static_cast<std::size_t>(options.width_) * options.height_), 0);
+
+		for (const Tile& tile : tiles)
+		{
+			const std::uint8_t* const tile_walls = shared_walls + tile.offset_;
+
+			for (int y = 0; y < tile.height_; ++y)
+			{
+				const std::size_t tile_row = static_cast<std::size_t>(y) * tile.width_;
+				const std::size_t maze_row = static_cast<std::size_t>(tile.y_ + y) * options.width_ + tile.x_;
+
+				for (int x = 0; x < tile.width_; ++x)
+				{
+					packed_walls::AddPassages(walls.data(), maze_row + x, packed_walls::GetPassages(tile_walls, tile_row + x));
+				}
+			}
+		}
+
+		munmap(mapping, shared_size);
+		report.assembly_seconds_ = timer.elapsed();
+
+		/* Kruskal's algorithm over the tiles: random weights make the spanning tree, and so the seams opened, random too. */
+		timer.reset();
+		SplitMix64Engine engine(MixBits(~static_cast<std::uint64_t>(options.seed_)));
+		std::vector<TileEdge> edges;
+
+		for (int row = 0; row < tile_rows; ++row)
+		{
+			for (int column = 0; column < tile_columns; ++column)
+			{
+				const std::size_t index = static_cast<std::size_t>(row) * tile_columns + column;
+
+				if (column + 1 < tile_columns)
+				{
+					edges.push_back({ engine(), index, index + 1, false });
+				}
+
+				if (row + 1 < tile_rows)
+				{
+					edges.push_back({ engine(), index, index + tile_columns, true });
+				}
+			}
+		}
+
+		std::sort(edges.begin(), edges.end(), [](const TileEdge& first, const TileEdge& second)
+			{
+				return first.weight_ < second.weight_;
+			});
+
+		std::vector<std::uint32_t> parents(tiles.size());
+		std::iota(parents.begin(), parents.end(), 0);
+
+		for (const TileEdge& edge : edges)
+		{
+			if (!Join(parents, static_cast<std::uint32_t>(edge.first_), static_cast<std::uint32_t>(edge.second_)))
+			{
+				continue;
+			}
+
+			/* Open one wall at a random position along the seam: a bottom passage out of first_ or a right one. */
+			const Tile& tile = tiles[edge.first_];
+			const int x = edge.vertical_ ? tile.x_ + static_cast<int>(engine() % tile.width_) : tile.x_ + tile.width_ - 1;
+			const int y = edge.vertical_ ? tile.y_ + tile.height_ - 1 : tile.y_ + static_cast<int>(engine() % tile.height_);
+
+			packed_walls::AddPassages(walls.data(), static_cast<std::size_t>(y) * options.width_ + x, edge.vertical_ ? packed_walls::bottom_open : packed_walls::right_open);
+			++report.seam_count_;
+		}
+
+		report.stitching_seconds_ = timer.elapsed();
+
+		return true;
+	}
+
+	bool IsPerfect(int width, int height, const std::vector<std::uint8_t>& walls)
+	{
+		MAZE_TRACE_ZONE("streaming perfect check");
+
+		if (width < 1 || height < 1 || walls.size() < packed_walls::GetSize(static_cast<std::size_t>(width) * height))
+		{
+			return false;
+		}
+
+		/* Nodes 0 to width - 1 are the previous row, each set rooted at its first cell; nodes width to 2 * width - 1 the current row. */
+		const std::uint32_t row_nodes = static_cast<std::uint32_t>(width);
+		std::vector<std::uint32_t> parents(2 * static_cast<std::size_t>(width));
+		std::vector<std::uint32_t> labels(2 * static_cast<std::size_t>(width));
+		std::vector<std::uint8_t> reached(2 * static_cast<std::size_t>(width));
+
+		for (int y = 0; y < height; ++y)
+		{
+			const std::size_t row = static_cast<std::size_t>(y) * width;
+
+			if ((packed_walls::GetPassages(walls.data(), row + width - 1) & packed_walls::right_open) != 0)
+			{
+				return false;
+			}
+
+			std::iota(parents.begin() + row_nodes, parents.end(), row_nodes);
+
+			for (std::uint32_t x = 0; x < row_nodes; ++x)
+			{
+				const int passages = packed_walls::GetPassages(walls.data(), row + x);
+
+				if ((passages & packed_walls::bottom_open) != 0 && y == height - 1)
+				{
+					return false;
+				}
+
+				/* Joining two cells that are already connected closes a loop. */
+				if (y > 0 && (packed_walls::GetPassages(walls.data(), row - width + x) & packed_walls::bottom_open) != 0 && !Join(parents, x, row_nodes + x))
+				{
+					return false;
+				}
+
+				if ((passages & packed_walls::right_open) != 0 && !Join(parents, row_nodes + x, row_nodes + x + 1))
+				{
+					return false;
+				}
+			}
+
+			/* A set of the previous row that no cell of this row joined is cut off from everything below and after it. */
+			std::fill(reached.begin(), reached.end(), 0);
+
+			for (std::uint32_t x = 0; x < row_nodes; ++x)
+			{
+				reached[FindRoot(parents, row_nodes + x)] = 1;
+			}
+
+			for (std::uint32_t x = 0; x < row_nodes && y > 0; ++x)
+			{
+				if (!reached[FindRoot(parents, x)])
+				{
+					return false;
+				}
+			}
+
+			/* Moves the current row into the previous row's nodes, every set rooted at its first cell. */
+			std::fill(labels.begin(), labels.end(), std::numeric_limits<std::uint32_t>::max());
+
+			for (std::uint32_t x = 0; x < row_nodes; ++x)
+			{
+				parents[row_nodes + x] = FindRoot(parents, row_nodes + x);
+			}
+
+			for (std::uint32_t x = 0; x < row_nodes; ++x)
+			{
+				std::uint32_t& label = labels[parents[row_nodes + x]];
+
+				if (label == std::numeric_limits<std::uint32_t>::max())
+				{
+					label = x;
+				}
+
+				parents[x] = label;
+			}
+		}
+
+		/* Everything has to end up in one set, the one of the first cell of the last row. */
+		for (std::uint32_t x = 0; x < row_nodes; ++x)
+		{
+			if (parents[x] != 0)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+} // namespace sharding
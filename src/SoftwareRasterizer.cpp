@@ -0,0 +1,351 @@
+#include "SoftwareRasterizer.hpp"
+#include "Tracing.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	/* ARGB8888. Everything outside of the maze takes the wall colour, which is also the colour the window is cleared to. */
+	constexpr std::uint32_t wall_colour = 0xff000000;
+	constexpr std::uint32_t floor_colour = 0xffffffff;
+
+	/* Writes set_colour for every set bit of cells first_cell to first_cell + count - 1 of a row, clear_colour for the others. */
+	void ExpandBits(const std::uint64_t* bits, int first_cell, int count, std::uint32_t set_colour, std::uint32_t clear_colour, std::uint32_t* colours)
+	{
+		int i = 0;
+
+#if defined(__SSE2__)
+		/* Four cells at a time: the nibble of their bits is broadcast and compared against one bit per lane. */
+		const __m128i lane_bits = _mm_setr_epi32(1, 2, 4, 8);
+		const __m128i set = _mm_set1_epi32(static_cast<int>(set_colour));
+		const __m128i clear = _mm_set1_epi32(static_cast<int>(clear_colour));
+
+		for (; i + 4 <= count; i += 4)
+		{
+			const int cell = first_cell + i;
+			const int shift = cell & 63;
+			std::uint64_t word = bits[cell >> 6] >> shift;
+
+			if (shift > 60)
+			{
+				word |= bits[(cell >> 6) + 1] << (64 - shift);
+			}
+
+			const __m128i nibble = _mm_set1_epi32(static_cast<int>(word & 0xf));
+			const __m128i mask = _mm_cmpeq_epi32(_mm_and_si128(nibble, lane_bits), lane_bits);
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(colours + i), _mm_or_si128(_mm_and_si128(mask, set), _mm_andnot_si128(mask, clear)));
+		}
+#endif
+
+		for (; i < count; ++i)
+		{
+			const int cell = first_cell + i;
+			colours[i] = ((bits[cell >> 6] >> (cell & 63)) & 1) ? set_colour : clear_colour;
+		}
+	}
+
+	/* Cell holding the centre of a screen pixel, -1 before the first cell and cell_count after the last. */
+	int GetCellAtPixel(double origin, double zoom, int cell_size, int cell_count, int pixel)
+	{
+		const double cell = std::floor((origin + (pixel + 0.5) / zoom) / cell_size);
+
+		return static_cast<int>(std::clamp(cell, -1.0, static_cast<double>(cell_count)));
+	}
+} // namespace
+
+SoftwareRasterizer::SoftwareRasterizer(WorkerPool& pool) :
+	pool_(pool),
+	texture_(nullptr),
+	view_width_(0),
+	view_height_(0),
+	cells_width_(0),
+	cells_height_(0),
+	words_per_row_(0),
+	view_{ 0.0, 0.0, 1.0, 1 },
+	view_valid_(false),
+	first_column_cell_(0),
+	thread_edge_colours_(pool.GetThreadCount()),
+	thread_run_colours_(pool.GetThreadCount())
+{
+
+}
+
+SoftwareRasterizer::~SoftwareRasterizer()
+{
+	Finalize();
+}
+
+bool SoftwareRasterizer::Initialize(SDL_Renderer* renderer, int view_width, int view_height)
+{
+	texture_ = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, view_width, view_height);
+
+	if (texture_ == nullptr)
+	{
+		printf("Rasterizer texture could not be created! SDL Error: %s\n", SDL_GetError());
+		return false;
+	}
+
+	view_width_ = view_width;
+	view_height_ = view_height;
+	view_valid_ = false;
+	dirty_bands_.assign((view_height + band_height - 1) / band_height, 1);
+
+	return true;
+}
+
+void SoftwareRasterizer::Finalize()
+{
+	SDL_DestroyTexture(texture_);
+	texture_ = nullptr;
+}
+
+bool SoftwareRasterizer::Resize(int cells_width, int cells_height)
+{
+	if (cells_width == cells_width_ && cells_height == cells_height_)
+	{
+		return false;
+	}
+
+	cells_width_ = cells_width;
+	cells_height_ = cells_height;
+	words_per_row_ = (static_cast<std::size_t>(cells_width) + 63) / 64;
+
+	const std::size_t word_count = words_per_row_ * cells_height;
+
+	left_bits_.assign(word_count, 0);
+	top_bits_.assign(word_count, 0);
+	outside_bits_.assign(word_count, 0);
+	view_valid_ = false;
+
+	return true;
+}
+
+void SoftwareRasterizer::UpdateRows(int first_row, int last_row, const RowSource& source)
+{
+	MAZE_TRACE_ZONE("rasterizer update rows");
+
+	first_row = std::max(first_row, 0);
+	last_row = std::min(last_row, cells_height_ - 1);
+
+	if (first_row > last_row)
+	{
+		return;
+	}
+
+	pool_.ParallelFor(static_cast<std::size_t>(last_row - first_row + 1), [this, first_row, &source](std::size_t task, int)
+		{
+			const int row = first_row + static_cast<int>(task);
+			const std::size_t offset = static_cast<std::size_t>(row) * words_per_row_;
+			const RowWalls walls = { left_bits_.data() + offset, top_bits_.data() + offset, outside_bits_.data() + offset };
+
+			std::fill_n(walls.left_, words_per_row_, 0);
+			std::fill_n(walls.top_, words_per_row_, 0);
+			std::fill_n(walls.outside_, words_per_row_, 0);
+
+			source(row, walls);
+
+			for (std::size_t word = 0; word < words_per_row_; ++word)
+			{
+				walls.left_[word] |= walls.outside_[word];
+				walls.top_[word] |= walls.outside_[word];
+			}
+		});
+
+	/* Without a valid view every band is redrawn anyway. */
+	if (!view_valid_)
+	{
+		return;
+	}
+
+	for (int screen_row = 0; screen_row < view_height_; ++screen_row)
+	{
+		if (row_cells_[screen_row] >= first_row && row_cells_[screen_row] <= last_row)
+		{
+			dirty_bands_[screen_row / band_height] = 1;
+		}
+	}
+}
+
+void SoftwareRasterizer::BuildViewMapping()
+{
+	column_runs_.clear();
+
+	int previous_cell = GetCellAtPixel(view_.x_, view_.zoom_, view_.cell_size_, cells_width_, -1);
+
+	for (int column = 0; column < view_width_; ++column)
+	{
+		const int cell = GetCellAtPixel(view_.x_, view_.zoom_, view_.cell_size_, cells_width_, column);
+
+		if (cell >= 0 && cell < cells_width_)
+		{
+			/* Only the first visible cell can start left of the view, without its wall column. */
+			if (column_runs_.empty() || cell != previous_cell)
+			{
+				column_runs_.push_back({ column, column, cell != previous_cell });
+			}
+
+			column_runs_.back().end_ = column + 1;
+		}
+
+		previous_cell = cell;
+	}
+
+	if (!column_runs_.empty())
+	{
+		first_column_cell_ = GetCellAtPixel(view_.x_, view_.zoom_, view_.cell_size_, cells_width_, column_runs_.front().start_);
+	}
+
+	row_cells_.resize(view_height_);
+	row_edges_.resize(view_height_);
+	previous_cell = GetCellAtPixel(view_.y_, view_.zoom_, view_.cell_size_, cells_height_, -1);
+
+	for (int row = 0; row < view_height_; ++row)
+	{
+		const int cell = GetCellAtPixel(view_.y_, view_.zoom_, view_.cell_size_, cells_height_, row);
+
+		row_cells_[row] = (cell >= 0 && cell < cells_height_) ? cell : -1;
+		row_edges_[row] = (cell != previous_cell);
+		previous_cell = cell;
+	}
+
+	for (std::size_t thread = 0; thread < thread_edge_colours_.size(); ++thread)
+	{
+		thread_edge_colours_[thread].resize(column_runs_.size());
+		thread_run_colours_[thread].resize(column_runs_.size());
+	}
+}
+
+void SoftwareRasterizer::RasterizeRow(int screen_row, std::uint32_t* pixels, int thread_index)
+{
+	const int cell_row = row_cells_[screen_row];
+
+	if (cell_row < 0 || column_runs_.empty())
+	{
+		std::fill_n(pixels, view_width_, wall_colour);
+		return;
+	}
+
+	const std::size_t offset = static_cast<std::size_t>(cell_row) * words_per_row_;
+	const int count = static_cast<int>(column_runs_.size());
+	std::uint32_t* const edge_colours = thread_edge_colours_[thread_index].data();
+	std::uint32_t* const run_colours = thread_run_colours_[thread_index].data();
+
+	/* The first screen row of a cell row is its top wall line, crossed by a wall pixel at every corner. */
+	if (row_edges_[screen_row])
+	{
+		std::fill_n(edge_colours, count, wall_colour);
+		ExpandBits(top_bits_.data() + offset, first_column_cell_, count, wall_colour, floor_colour, run_colours);
+	}
+	else
+	{
+		ExpandBits(left_bits_.data() + offset, first_column_cell_, count, wall_colour, floor_colour, edge_colours);
+		ExpandBits(outside_bits_.data() + offset, first_column_cell_, count, wall_colour, floor_colour, run_colours);
+	}
+
+	std::fill(pixels, pixels + column_runs_.front().start_, wall_colour);
+
+	for (int i = 0; i < count; ++i)
+	{
+		const ColumnRun& run = column_runs_[i];
+		int column = run.start_;
+
+		if (run.edge_)
+		{
+			pixels[column++] = edge_colours[i];
+		}
+
+		std::fill(pixels + column, pixels + run.end_, run_colours[i]);
+	}
+
+	std::fill(pixels + column_runs_.back().end_, pixels + view_width_, wall_colour);
+}
+
+void SoftwareRasterizer::RasterizeBands(int first_band, int last_band)
+{
+	MAZE_TRACE_ZONE("rasterize bands");
+
+	const SDL_Rect rect = { 0, first_band * band_height, view_width_, std::min((last_band + 1) * band_height, view_height_) - first_band * band_height };
+	void* locked_pixels = nullptr;
+	int pitch = 0;
+
+	/* Locked pixels do not keep the old contents, so every row of the locked bands is written. */
+	if (SDL_LockTexture(texture_, &rect, &locked_pixels, &pitch) != 0)
+	{
+		return;
+	}
+
+	std::uint8_t* const bytes = static_cast<std::uint8_t*>(locked_pixels);
+
+	pool_.ParallelFor(static_cast<std::size_t>(last_band - first_band + 1), [this, &rect, bytes, pitch, first_band](std::size_t task, int thread_index)
+		{
+			const int band_first_row = (first_band + static_cast<int>(task)) * band_height;
+			const int band_last_row = std::min(band_first_row + band_height, view_height_) - 1;
+
+			for (int row = band_first_row; row <= band_last_row; ++row)
+			{
+				std::uint32_t* const pixels = reinterpret_cast<std::uint32_t*>(bytes + static_cast<std::size_t>(row - rect.y) * pitch);
+
+				/* Rows showing the same line of the same cell row repeat the one above them. */
+				if (row > band_first_row && row_cells_[row] == row_cells_[row - 1] && !row_edges_[row] && !row_edges_[row - 1])
+				{
+					std::memcpy(pixels, bytes + static_cast<std::size_t>(row - 1 - rect.y) * pitch, static_cast<std::size_t>(view_width_) * sizeof(std::uint32_t));
+				}
+				else
+				{
+					RasterizeRow(row, pixels, thread_index);
+				}
+			}
+		});
+
+	SDL_UnlockTexture(texture_);
+}
+
+void SoftwareRasterizer::Render(SDL_Renderer* renderer, const View& view)
+{
+	if (texture_ == nullptr)
+	{
+		return;
+	}
+
+	MAZE_TRACE_ZONE("software rasterizer");
+
+	if (!view_valid_ || view.x_ != view_.x_ || view.y_ != view_.y_ || view.zoom_ != view_.zoom_ || view.cell_size_ != view_.cell_size_)
+	{
+		view_ = view;
+		BuildViewMapping();
+		view_valid_ = true;
+		std::fill(dirty_bands_.begin(), dirty_bands_.end(), 1);
+	}
+
+	/* Each run of consecutive dirty bands is locked and uploaded once. */
+	const int band_count = static_cast<int>(dirty_bands_.size());
+
+	for (int band = 0; band < band_count; ++band)
+	{
+		if (!dirty_bands_[band])
+		{
+			continue;
+		}
+
+		int last_band = band;
+
+		while (last_band + 1 < band_count && dirty_bands_[last_band + 1])
+		{
+			++last_band;
+		}
+
+		RasterizeBands(band, last_band);
+		std::fill(dirty_bands_.begin() + band, dirty_bands_.begin() + last_band + 1, 0);
+		band = last_band;
+	}
+
+	SDL_RenderCopy(renderer, texture_, nullptr, nullptr);
+}
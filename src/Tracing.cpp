@@ -0,0 +1,252 @@
+#include "Tracing.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace
+{
+	using clock = std::chrono::steady_clock;
+
+	constexpr std::size_t buffer_capacity = std::size_t(1) << 14;
+
+	const clock::time_point trace_epoch = clock::now();
+
+	struct Event
+	{
+		const char* name_;
+		std::uint64_t start_;
+		std::uint64_t duration_;
+		double value_;
+		bool counter_;
+	};
+
+	/* Single producer ring: only the owning thread advances head_, only a drain (under the trace mutex) advances tail_. */
+	struct ThreadBuffer
+	{
+		std::array<Event, buffer_capacity> events_;
+		std::atomic<std::uint64_t> head_{ 0 };
+		std::atomic<std::uint64_t> tail_{ 0 };
+		std::atomic<std::uint64_t> dropped_{ 0 };
+		int thread_id_ = 0;
+		std::string name_;
+		bool name_written_ = true;
+	};
+
+	class Trace
+	{
+	private:
+		std::mutex mutex_;
+		std::vector<ThreadBuffer*> buffers_;
+		int next_thread_id_ = 1;
+		std::FILE* file_ = nullptr;
+		bool file_failed_ = false;
+		bool first_event_ = true;
+		std::uint64_t dropped_ = 0;
+
+		bool OpenFile()
+		{
+			if (file_ == nullptr && !file_failed_)
+			{
+				const char* path = std::getenv("MAZE_TRACE_FILE");
+				file_ = std::fopen(path != nullptr ? path : "maze_trace.json", "w");
+				file_failed_ = (file_ == nullptr);
+
+				if (file_ != nullptr)
+				{
+					std::fputs("[\n", file_);
+				}
+			}
+
+			return file_ != nullptr;
+		}
+
+		void Drain(ThreadBuffer& buffer)
+		{
+			const std::uint64_t head = buffer.head_.load(std::memory_order_acquire);
+			const std::uint64_t tail = buffer.tail_.load(std::memory_order_relaxed);
+
+			if (OpenFile())
+			{
+				if (!buffer.name_written_)
+				{
+					std::fprintf(file_, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+						first_event_ ? "" : ",\n", buffer.thread_id_, buffer.name_.c_str());
+					first_event_ = false;
+					buffer.name_written_ = true;
+				}
+
+				for (std::uint64_t position = tail; position != head; ++position)
+				{
+					const Event& event = buffer.events_[position % buffer_capacity];
+
+					if (event.counter_)
+					{
+						std::fprintf(file_, "%s{\"name\":\"%s\",\"ph\":\"C\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"args\":{\"value\":%g}}",
+							first_event_ ? "" : ",\n", event.name_, buffer.thread_id_, event.start_ / 1000.0, event.value_);
+					}
+					else
+					{
+						std::fprintf(file_, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+							first_event_ ? "" : ",\n", event.name_, buffer.thread_id_, event.start_ / 1000.0, event.duration_ / 1000.0);
+					}
+
+					first_event_ = false;
+				}
+			}
+
+			buffer.tail_.store(head, std::memory_order_release);
+		}
+
+	public:
+		~Trace()
+		{
+			const std::lock_guard<std::mutex> lock(mutex_);
+
+			for (ThreadBuffer* buffer : buffers_)
+			{
+				Drain(*buffer);
+				dropped_ += buffer->dropped_.load(std::memory_order_relaxed);
+			}
+
+			if (file_ != nullptr)
+			{
+				std::fputs("\n]\n", file_);
+				std::fclose(file_);
+			}
+
+			if (dropped_ != 0)
+			{
+				printf("Tracing dropped %llu events, flush more often!\n", static_cast<unsigned long long>(dropped_));
+			}
+		}
+
+		void Register(ThreadBuffer& buffer)
+		{
+			const std::lock_guard<std::mutex> lock(mutex_);
+			buffer.thread_id_ = next_thread_id_++;
+			buffers_.push_back(&buffer);
+		}
+
+		/* Called when the owning thread exits; the buffer is freed afterwards. */
+		void Retire(ThreadBuffer& buffer)
+		{
+			const std::lock_guard<std::mutex> lock(mutex_);
+			Drain(buffer);
+			dropped_ += buffer.dropped_.load(std::memory_order_relaxed);
+			buffers_.erase(std::find(buffers_.begin(), buffers_.end(), &buffer));
+		}
+
+		void SetThreadName(ThreadBuffer& buffer, const char* name)
+		{
+			const std::lock_guard<std::mutex> lock(mutex_);
+			buffer.name_ = name;
+			buffer.name_written_ = false;
+		}
+
+		void Flush()
+		{
+			const std::lock_guard<std::mutex> lock(mutex_);
+
+			for (ThreadBuffer* buffer : buffers_)
+			{
+				Drain(*buffer);
+			}
+
+			if (file_ != nullptr)
+			{
+				std::fflush(file_);
+			}
+		}
+	};
+
+	Trace& GetTrace()
+	{
+		static Trace trace;
+		return trace;
+	}
+
+	/* Every thread's buffer is created on its first event; destroying the owner at thread exit drains it. */
+	struct ThreadBufferOwner
+	{
+		std::unique_ptr<ThreadBuffer> buffer_;
+
+		~ThreadBufferOwner()
+		{
+			if (buffer_ != nullptr)
+			{
+				GetTrace().Retire(*buffer_);
+			}
+		}
+	};
+
+	thread_local ThreadBufferOwner thread_buffer_owner;
+
+	ThreadBuffer& GetThreadBuffer()
+	{
+		if (thread_buffer_owner.buffer_ == nullptr)
+		{
+			thread_buffer_owner.buffer_ = std::make_unique<ThreadBuffer>();
+			GetTrace().Register(*thread_buffer_owner.buffer_);
+		}
+
+		return *thread_buffer_owner.buffer_;
+	}
+
+	std::uint64_t Now()
+	{
+		return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - trace_epoch).count());
+	}
+
+	void Record(const Event& event)
+	{
+		ThreadBuffer& buffer = GetThreadBuffer();
+		const std::uint64_t head = buffer.head_.load(std::memory_order_relaxed);
+
+		if (head - buffer.tail_.load(std::memory_order_acquire) == buffer_capacity)
+		{
+			buffer.dropped_.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		buffer.events_[head % buffer_capacity] = event;
+		buffer.head_.store(head + 1, std::memory_order_release);
+	}
+} // namespace
+
+namespace tracing
+{
+	Zone::Zone(const char* name) :
+		name_(name),
+		start_(Now())
+	{
+	}
+
+	Zone::~Zone()
+	{
+		Record({ name_, start_, Now() - start_, 0.0, false });
+	}
+
+	void SetThreadName(const char* name)
+	{
+		GetTrace().SetThreadName(GetThreadBuffer(), name);
+	}
+
+	void Counter(const char* name, double value)
+	{
+		Record({ name, Now(), 0, value, true });
+	}
+
+	void Flush()
+	{
+		GetTrace().Flush();
+	}
+} // namespace tracing
@@ -0,0 +1,199 @@
+#include "Uniformity.hpp"
+#include "PackedWalls.hpp"
+#include "RandomEngine.hpp"
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace uniformity
+{
+	ConcurrentCountTable::ConcurrentCountTable(std::size_t min_capacity)
+	{
+		std::size_t capacity = 1;
+
+		while (capacity < min_capacity)
+		{
+			capacity *= 2;
+		}
+
+		keys_ = std::vector<std::atomic<std::uint64_t>>(capacity);
+		counts_ = std::vector<std::atomic<std::uint32_t>>(capacity);
+		mask_ = capacity - 1;
+	}
+
+	bool ConcurrentCountTable::Increment(std::uint64_t key)
+	{
+		/* Wall keys of similar trees differ in few bits, so they are mixed before probing. */
+		std::size_t slot = MixBits(key) & mask_;
+
+		for (std::size_t probe = 0; probe <= mask_; ++probe, slot = (slot + 1) & mask_)
+		{
+			std::uint64_t slot_key = keys_[slot].load(std::memory_order_relaxed);
+
+			/* Claim an empty slot; if another thread got there first, slot_key now holds its key. */
+			if (slot_key == 0 && keys_[slot].compare_exchange_strong(slot_key, key, std::memory_order_relaxed))
+			{
+				slot_key = key;
+			}
+
+			if (slot_key == key)
+			{
+				counts_[slot].fetch_add(1, std::memory_order_relaxed);
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	std::size_t ConcurrentCountTable::GetCapacity() const
+	{
+		return keys_.size();
+	}
+
+	std::uint64_t GetEdgeBits(int cells_width, int cells_height)
+	{
+		const std::uint64_t width = static_cast<std::uint64_t>(cells_width);
+		const std::uint64_t height = static_cast<std::uint64_t>(cells_height);
+
+		return (width - 1) * height + width * (height - 1);
+	}
+
+	std::uint64_t EncodeWalls(const GridMaze<SquareTopology>& maze)
+	{
+		constexpr int right = 1;
+		constexpr int bottom = 3;
+
+		const GridDimensions& dimensions = maze.GetDimensions();
+		std::uint64_t key = 0;
+		int bit = 0;
+
+		for (int y = 0; y < dimensions.height_; ++y)
+		{
+			for (int x = 0; x + 1 < dimensions.width_; ++x, ++bit)
+			{
+				key |= static_cast<std::uint64_t>(maze.IsOpen(maze.GetCellIndex(x, y, 0), right)) << bit;
+			}
+		}
+
+		for (int y = 0; y + 1 < dimensions.height_; ++y)
+		{
+			for (int x = 0; x < dimensions.width_; ++x, ++bit)
+			{
+				key |= static_cast<std::uint64_t>(maze.IsOpen(maze.GetCellIndex(x, y, 0), bottom)) << bit;
+			}
+		}
+
+		return key;
+	}
+
+	std::uint64_t EncodePackedWalls(int cells_width, int cells_height, const std::vector<std::uint8_t>& walls)
+	{
+		const auto passages = [&](int x, int y)
+		{
+			return packed_walls::GetPassages(walls.data(), static_cast<std::size_t>(y) * cells_width + x);
+		};
+
+		std::uint64_t key = 0;
+		int bit = 0;
+
+		for (int y = 0; y < cells_height; ++y)
+		{
+			for (int x = 0; x + 1 < cells_width; ++x, ++bit)
+			{
+				key |= static_cast<std::uint64_t>((passages(x, y) & packed_walls::right_open) != 0) << bit;
+			}
+		}
+
+		for (int y = 0; y + 1 < cells_height; ++y)
+		{
+			for (int x = 0; x < cells_width; ++x, ++bit)
+			{
+				key |= static_cast<std::uint64_t>((passages(x, y) & packed_walls::bottom_open) != 0) << bit;
+			}
+		}
+
+		return key;
+	}
+
+	double CountSpanningTrees(int cells_width, int cells_height)
+	{
+		/* Determinant of the grid Laplacian with the last cell's row and column removed. */
+		const int size = cells_width * cells_height - 1;
+		std::vector<long double> laplacian(static_cast<std::size_t>(size) * size, 0.0L);
+
+		const auto at = [&](int row, int column) -> long double&
+		{
+			return laplacian[static_cast<std::size_t>(row) * size + column];
+		};
+
+		for (int y = 0; y < cells_height; ++y)
+		{
+			for (int x = 0; x < cells_width; ++x)
+			{
+				const int cell = y * cells_width + x;
+				const std::pair<int, int> neighbors[] = { { x + 1, y }, { x, y + 1 } };
+
+				for (const auto& [neighbor_x, neighbor_y] : neighbors)
+				{
+					if (neighbor_x >= cells_width || neighbor_y >= cells_height)
+					{
+						continue;
+					}
+
+					const int neighbor = neighbor_y * cells_width + neighbor_x;
+
+					for (const int end : { cell, neighbor })
+					{
+						if (end < size)
+						{
+							at(end, end) += 1.0L;
+						}
+					}
+
+					if (cell < size && neighbor < size)
+					{
+						at(cell, neighbor) -= 1.0L;
+						at(neighbor, cell) -= 1.0L;
+					}
+				}
+			}
+		}
+
+		/* The reduced Laplacian is symmetric positive definite, so elimination without pivoting is stable. */
+		long double determinant = 1.0L;
+
+		for (int pivot = 0; pivot < size; ++pivot)
+		{
+			determinant *= at(pivot, pivot);
+
+			for (int row = pivot + 1; row < size; ++row)
+			{
+				const long double factor = at(row, pivot) / at(pivot, pivot);
+
+				if (factor == 0.0L)
+				{
+					continue;
+				}
+
+				for (int column = pivot; column < size; ++column)
+				{
+					at(row, column) -= factor * at(pivot, column);
+				}
+			}
+		}
+
+		return std::round(static_cast<double>(determinant));
+	}
+
+	double ChiSquaredPValue(double chi_squared, double degrees_of_freedom)
+	{
+		const double variance = 2.0 / (9.0 * degrees_of_freedom);
+		const double z = (std::cbrt(chi_squared / degrees_of_freedom) - (1.0 - variance)) / std::sqrt(variance);
+
+		return 0.5 * std::erfc(z / std::sqrt(2.0));
+	}
+} // namespace uniformity
@@ -0,0 +1,114 @@
+#include "WorkerPool.hpp"
+#include "Tracing.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+
+WorkerPool::WorkerPool(int thread_count) :
+	task_(nullptr),
+	task_count_(0),
+	next_task_(0),
+	generation_(0),
+	busy_threads_(0),
+	stopping_(false)
+{
+	for (int thread_index = 1; thread_index < std::max(thread_count, 1); ++thread_index)
+	{
+		threads_.emplace_back(&WorkerPool::Run, this, thread_index);
+	}
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		const std::lock_guard<std::mutex> lock(mutex_);
+		stopping_ = true;
+	}
+
+	work_ready_.notify_all();
+
+	for (std::thread& thread : threads_)
+	{
+		thread.join();
+	}
+}
+
+int WorkerPool::GetThreadCount() const
+{
+	return static_cast<int>(threads_.size()) + 1;
+}
+
+void WorkerPool::Run(int thread_index)
+{
+	MAZE_TRACE_THREAD_NAME("worker pool");
+
+	std::uint64_t seen_generation = 0;
+	std::unique_lock<std::mutex> lock(mutex_);
+
+	while (true)
+	{
+		work_ready_.wait(lock, [this, seen_generation]() { return stopping_ || generation_ != seen_generation; });
+
+		if (stopping_)
+		{
+			return;
+		}
+
+		seen_generation = generation_;
+		lock.unlock();
+
+		RunTasks(thread_index);
+
+		lock.lock();
+
+		if (--busy_threads_ == 0)
+		{
+			work_done_.notify_one();
+		}
+	}
+}
+
+void WorkerPool::RunTasks(int thread_index)
+{
+	MAZE_TRACE_ZONE("worker pool tasks");
+
+	for (std::size_t task = next_task_.fetch_add(1, std::memory_order_relaxed); task < task_count_; task = next_task_.fetch_add(1, std::memory_order_relaxed))
+	{
+		(*task_)(task, thread_index);
+	}
+}
+
+void WorkerPool::ParallelFor(std::size_t task_count, const Task& task)
+{
+	if (threads_.empty() || task_count < 2)
+	{
+		for (std::size_t i = 0; i < task_count; ++i)
+		{
+			task(i, 0);
+		}
+
+		return;
+	}
+
+	/* The pool has a single task slot, so a second caller waits for the first to finish. */
+	const std::lock_guard<std::mutex> call_lock(call_mutex_);
+
+	{
+		const std::lock_guard<std::mutex> lock(mutex_);
+		task_ = &task;
+		task_count_ = task_count;
+		next_task_.store(0, std::memory_order_relaxed);
+		busy_threads_ = static_cast<int>(threads_.size());
+		++generation_;
+	}
+
+	work_ready_.notify_all();
+	RunTasks(0);
+
+	/* Every worker has to check in, even one that found no task left, before task_ may go out of scope. */
+	std::unique_lock<std::mutex> lock(mutex_);
+	work_done_.wait(lock, [this]() { return busy_threads_ == 0; });
+	task_ = nullptr;
+}
@@ -1,11 +1,60 @@
 #include "Game.hpp"
+#include "Headless.hpp"
 
 #include <memory>
+#include <string>
 
 int main(int argc, char* argv[])
 {
-	(void) argc;
-	(void) argv;
+	if (argc > 1 && std::string(argv[1]) == "--export")
+	{
+		return headless::RunExport(argc, argv);
+	}
+
+	if (argc > 1 && std::string(argv[1]) == "--topology")
+	{
+		return headless::RunTopology(argc, argv);
+	}
+
+	if (argc > 1 && std::string(argv[1]) == "--analyze")
+	{
+		return headless::RunAnalyze(argc, argv);
+	}
+
+	if (argc > 1 && std::string(argv[1]) == "--uniformity")
+	{
+		return headless::RunUniformity(argc, argv);
+	}
+
+	if (argc > 1 && std::string(argv[1]) == "--batch")
+	{
+		return headless::RunBatch(argc, argv);
+	}
+
+	if (argc > 1 && std::string(argv[1]) == "--archive-read")
+	{
+		return headless::RunArchiveRead(argc, argv);
+	}
+
+	if (argc > 1 && std::string(argv[1]) == "--paths")
+	{
+		return headless::RunPaths(argc, argv);
+	}
+
+	if (argc > 1 && std::string(argv[1]) == "--serve")
+	{
+		return headless::RunServe(argc, argv);
+	}
+
+	if (argc > 1 && std::string(argv[1]) == "--serve-bench")
+	{
+		return headless::RunServeBenchmark(argc, argv);
+	}
+
+	if (argc > 1 && std::string(argv[1]) == "--sharded")
+	{
+		return headless::RunSharded(argc, argv);
+	}
 
 	const std::unique_ptr<Game> game = std::make_unique<Game>();
 	game->Run();